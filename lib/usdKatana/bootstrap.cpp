@@ -45,7 +45,7 @@
 #include <FnConfig/FnConfig.h>
 #include <FnAttribute/FnAttribute.h>
 
-
+#include "usdKatana/valueConverterRegistry.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
 
@@ -143,7 +143,13 @@ void BootstrapImpl(const std::string& katanaPath)
 void UsdKatanaBootstrap(const std::string& katanaPath)
 {
     static std::once_flag once;
-    std::call_once(once, BootstrapImpl, katanaPath);
+    std::call_once(once, [&katanaPath]() {
+        BootstrapImpl(katanaPath);
+
+        // The registry is published before its converters are registered, so
+        // it is populated here, before any cook can look it up concurrently.
+        UsdKatanaValueConverterRegistry::GetInstance();
+    });
 }
 
 PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,331 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/boundsCache.h"
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <utility>
+
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/base/tf/instantiateSingleton.h>
+#include <pxr/base/tf/notice.h>
+#include <pxr/base/tf/weakBase.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/base/work/loops.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/notice.h>
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usdGeom/bboxCache.h>
+#include <pxr/usd/usdGeom/tokens.h>
+
+#include <tbb/concurrent_hash_map.h>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+TF_INSTANTIATE_SINGLETON(UsdKatanaBoundsCache);
+
+TF_DEFINE_ENV_SETTING(USD_KATANA_BOUNDS_CACHE_MAX_TIMES,
+                      16,
+                      "Number of times, per stage, whose bounds are kept by UsdKatanaBoundsCache.");
+
+/// The bounds of one stage, per time.
+class UsdKatanaBoundsCache::_StageBounds : public TfWeakBase
+{
+public:
+    explicit _StageBounds(const UsdStageWeakPtr& stage) : _stage(stage)
+    {
+        _objectsChangedKey = TfNotice::Register(
+            TfCreateWeakPtr(this), &_StageBounds::_OnObjectsChanged, stage);
+    }
+
+    ~_StageBounds() { TfNotice::Revoke(_objectsChangedKey); }
+
+    bool IsExpired() const { return _stage.IsExpired(); }
+
+    GfBBox3d ComputeBound(const UsdPrim& prim,
+                          double time,
+                          bool applyLocalTransform,
+                          std::atomic<size_t>& hits,
+                          std::atomic<size_t>& misses)
+    {
+        const std::shared_ptr<_TimeBounds> timeBounds = _GetTimeBounds(time);
+        const _BoundKey key(prim.GetPath(), applyLocalTransform);
+        {
+            _BoundMap::const_accessor accessor;
+            if (timeBounds->bounds.find(accessor, key))
+            {
+                ++hits;
+                return accessor->second;
+            }
+        }
+        ++misses;
+
+        // Misses are computed with a scratch cache of their own, so that
+        // threads missing at the same time don't wait on each other.
+        std::unique_ptr<UsdGeomBBoxCache> bboxCache = timeBounds->AcquireBBoxCache();
+        const GfBBox3d bound = applyLocalTransform ? bboxCache->ComputeLocalBound(prim)
+                                                   : bboxCache->ComputeUntransformedBound(prim);
+        timeBounds->ReleaseBBoxCache(std::move(bboxCache));
+
+        timeBounds->bounds.insert(std::make_pair(key, bound));
+        return bound;
+    }
+
+    UsdStagePtr GetStage() const { return _stage; }
+
+private:
+    typedef std::pair<SdfPath, bool> _BoundKey;
+    struct _BoundKeyHashCompare
+    {
+        static size_t hash(const _BoundKey& key) { return key.first.GetHash() + key.second; }
+        static bool equal(const _BoundKey& a, const _BoundKey& b) { return a == b; }
+    };
+    typedef tbb::concurrent_hash_map<_BoundKey, GfBBox3d, _BoundKeyHashCompare> _BoundMap;
+
+    struct _TimeBounds
+    {
+        explicit _TimeBounds(double time) : time(time) {}
+
+        // UsdGeomBBoxCache is not safe to query concurrently, so each
+        // computation takes a cache of its own from the pool, creating one
+        // if none is free. A cache is never shared by two computations, even
+        // when one is nested in the other by work stealing. The pool grows to
+        // the number of concurrent computations and keeps the subtrees each
+        // cache has seen.
+        std::unique_ptr<UsdGeomBBoxCache> AcquireBBoxCache()
+        {
+            {
+                std::lock_guard<std::mutex> lock(poolMutex);
+                if (!pool.empty())
+                {
+                    std::unique_ptr<UsdGeomBBoxCache> bboxCache = std::move(pool.back());
+                    pool.pop_back();
+                    return bboxCache;
+                }
+            }
+            return std::unique_ptr<UsdGeomBBoxCache>(new UsdGeomBBoxCache(
+                time,
+                // XXX: selected purposes should be driven by the UI.
+                // See usdGeom/imageable.h GetPurposeAttr() for allowed
+                // values.
+                {UsdGeomTokens->default_, UsdGeomTokens->render},
+                /* useExtentsHint */ true));
+        }
+
+        void ReleaseBBoxCache(std::unique_ptr<UsdGeomBBoxCache> bboxCache)
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            pool.push_back(std::move(bboxCache));
+        }
+
+        const double time;
+        std::mutex poolMutex;
+        std::vector<std::unique_ptr<UsdGeomBBoxCache>> pool;
+        _BoundMap bounds;
+    };
+
+    struct _TimeEntry
+    {
+        std::shared_ptr<_TimeBounds> bounds;
+        std::list<double>::iterator recentTime;
+    };
+
+    std::shared_ptr<_TimeBounds> _GetTimeBounds(double time)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto found = _timeBounds.find(time);
+        if (found != _timeBounds.end())
+        {
+            _recentTimes.splice(_recentTimes.end(), _recentTimes, found->second.recentTime);
+            return found->second.bounds;
+        }
+
+        // Evict the least recently used times. Bounds still being queried
+        // are kept alive by their callers.
+        const size_t maxTimes =
+            static_cast<size_t>(std::max(1, TfGetEnvSetting(USD_KATANA_BOUNDS_CACHE_MAX_TIMES)));
+        while (_timeBounds.size() >= maxTimes)
+        {
+            _timeBounds.erase(_recentTimes.front());
+            _recentTimes.pop_front();
+        }
+
+        const std::shared_ptr<_TimeBounds> timeBounds = std::make_shared<_TimeBounds>(time);
+        _timeBounds.emplace(time, _TimeEntry{timeBounds,
+                                             _recentTimes.insert(_recentTimes.end(), time)});
+        return timeBounds;
+    }
+
+    void _OnObjectsChanged(const UsdNotice::ObjectsChanged& notice,
+                           const UsdStageWeakPtr& sender)
+    {
+        // Extents, transforms, visibility and purpose are all authored
+        // values, so info-only changes invalidate the bounds as well as
+        // resyncs.
+        if (notice.GetResyncedPaths().empty() && notice.GetChangedInfoOnlyPaths().empty())
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        _timeBounds.clear();
+        _recentTimes.clear();
+    }
+
+    UsdStageWeakPtr _stage;
+    TfNotice::Key _objectsChangedKey;
+
+    std::mutex _mutex;
+    std::map<double, _TimeEntry> _timeBounds;
+    // Times of _timeBounds, least recently used first.
+    std::list<double> _recentTimes;
+};
+
+UsdKatanaBoundsCache::UsdKatanaBoundsCache() : _hits(0), _misses(0)
+{
+}
+
+std::vector<GfBBox3d> UsdKatanaBoundsCache::ComputeBounds(const UsdPrim& prim,
+                                                          const std::vector<double>& times,
+                                                          bool applyLocalTransform)
+{
+    std::vector<GfBBox3d> ret;
+    const std::shared_ptr<_StageBounds> stageBounds = _GetStageBounds(prim.GetStage());
+    if (!stageBounds)
+    {
+        return ret;
+    }
+
+    ret.reserve(times.size());
+    for (double time : times)
+    {
+        ret.push_back(
+            stageBounds->ComputeBound(prim, time, applyLocalTransform, _hits, _misses));
+    }
+    return ret;
+}
+
+void UsdKatanaBoundsCache::WarmUp(const UsdPrim& root, const std::vector<double>& times)
+{
+    TRACE_FUNCTION();
+
+    const std::shared_ptr<_StageBounds> stageBounds = _GetStageBounds(root.GetStage());
+    if (!stageBounds || times.empty())
+    {
+        return;
+    }
+
+    // Models below instances are read at their instance proxy paths, as
+    // UsdIn does.
+    std::vector<UsdPrim> models;
+    for (const UsdPrim& prim : UsdPrimRange(
+             root, UsdTraverseInstanceProxies(UsdPrimDefaultPredicate && UsdPrimIsModel)))
+    {
+        if (!prim.IsPseudoRoot())
+        {
+            models.push_back(prim);
+        }
+    }
+
+    WorkParallelForN(models.size() * times.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            stageBounds->ComputeBound(models[i / times.size()], times[i % times.size()],
+                                      /* applyLocalTransform */ false, _hits, _misses);
+        }
+    });
+}
+
+UsdKatanaBoundsCache::Stats UsdKatanaBoundsCache::GetStats() const
+{
+    Stats stats;
+    stats.hits = _hits;
+    stats.misses = _misses;
+    return stats;
+}
+
+void UsdKatanaBoundsCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stageBounds.clear();
+}
+
+void UsdKatanaBoundsCache::ClearStage(const UsdStagePtr& stage)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stageBounds.erase(get_pointer(stage));
+}
+
+void UsdKatanaBoundsCache::ClearRootLayer(const SdfLayerHandle& rootLayer)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto it = _stageBounds.begin(); it != _stageBounds.end();)
+    {
+        const UsdStagePtr stage = it->second->GetStage();
+        if (!stage || stage->GetRootLayer() == rootLayer)
+        {
+            it = _stageBounds.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+std::shared_ptr<UsdKatanaBoundsCache::_StageBounds> UsdKatanaBoundsCache::_GetStageBounds(
+    const UsdStageWeakPtr& stage)
+{
+    if (!stage)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto found = _stageBounds.find(get_pointer(stage));
+    if (found != _stageBounds.end() && !found->second->IsExpired())
+    {
+        return found->second;
+    }
+
+    // Forget the bounds of stages which no longer exist, including any
+    // previous stage at the same address.
+    for (auto it = _stageBounds.begin(); it != _stageBounds.end();)
+    {
+        if (it->second->IsExpired())
+        {
+            it = _stageBounds.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    std::shared_ptr<_StageBounds> stageBounds = std::make_shared<_StageBounds>(stage);
+    _stageBounds.emplace(get_pointer(stage), stageBounds);
+    return stageBounds;
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
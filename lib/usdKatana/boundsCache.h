@@ -0,0 +1,117 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_BOUNDSCACHE_H
+#define USDKATANA_BOUNDSCACHE_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <pxr/base/gf/bbox3d.h>
+#include <pxr/base/tf/singleton.h>
+#include <pxr/pxr.h>
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/stage.h>
+
+#include "usdKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/// \brief Process-wide cache of prim bounds, keyed by stage and time.
+///
+/// Bounds are shared by every thread and every UsdKatanaUsdInArgs cooking the
+/// same stage, so a prim's bound is only computed once per time. Bounds
+/// already computed are looked up without locking. Misses are computed
+/// concurrently, each with a UsdGeomBBoxCache taken from a pool kept per
+/// (stage, time) pair, so the subtrees a pooled cache has seen are reused by
+/// later misses. WarmUp() fills the cache for the whole model hierarchy in
+/// parallel.
+///
+/// Only the most recently used times of each stage are kept, up to
+/// USD_KATANA_BOUNDS_CACHE_MAX_TIMES. The bounds of a stage are dropped
+/// whenever the stage changes, e.g. when a payload is loaded or an extent is
+/// edited, and forgotten once the stage is destroyed or flushed from
+/// UsdKatanaCache.
+class UsdKatanaBoundsCache : public TfSingleton<UsdKatanaBoundsCache>
+{
+    friend class TfSingleton<UsdKatanaBoundsCache>;
+
+    UsdKatanaBoundsCache();
+
+public:
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    USDKATANA_API static UsdKatanaBoundsCache& GetInstance()
+    {
+        return TfSingleton<UsdKatanaBoundsCache>::GetInstance();
+    }
+
+    /// \brief Return the bound of \p prim at each of the absolute \p times,
+    ///        in the prim's own space or, if \p applyLocalTransform is true,
+    ///        in its parent's space.
+    USDKATANA_API std::vector<GfBBox3d> ComputeBounds(const UsdPrim& prim,
+                                                      const std::vector<double>& times,
+                                                      bool applyLocalTransform = false);
+
+    /// \brief Compute the untransformed bounds of \p root and of every model
+    ///        below it, including those below instances, at each of the
+    ///        absolute \p times, in parallel, so that later queries in the
+    ///        model hierarchy are lookups.
+    USDKATANA_API void WarmUp(const UsdPrim& root, const std::vector<double>& times);
+
+    /// \brief Return a snapshot of the hit and miss counters.
+    USDKATANA_API Stats GetStats() const;
+
+    /// \brief Drop the bounds of every stage.
+    USDKATANA_API void Clear();
+
+    /// \brief Drop the bounds of \p stage.
+    USDKATANA_API void ClearStage(const UsdStagePtr& stage);
+
+    /// \brief Drop the bounds of every stage whose root layer is
+    ///        \p rootLayer.
+    USDKATANA_API void ClearRootLayer(const SdfLayerHandle& rootLayer);
+
+private:
+    class _StageBounds;
+    std::shared_ptr<_StageBounds> _GetStageBounds(const UsdStageWeakPtr& stage);
+
+    std::mutex _mutex;
+    std::unordered_map<const UsdStage*, std::shared_ptr<_StageBounds>> _stageBounds;
+
+    std::atomic<size_t> _hits;
+    std::atomic<size_t> _misses;
+};
+
+USDKATANA_API_TEMPLATE_CLASS(TfSingleton<UsdKatanaBoundsCache>);
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_BOUNDSCACHE_H
@@ -29,13 +29,19 @@
 //
 #include "usdKatana/cache.h"
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <pxr/pxr.h>
 
 #include <pxr/base/arch/systemInfo.h>
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/base/tf/hash.h>
 #include <pxr/base/tf/instantiateSingleton.h>
 #include <pxr/base/trace/trace.h>
 #include <pxr/usd/ar/resolver.h>
@@ -44,20 +50,38 @@
 #include <pxr/usd/sdf/path.h>
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usd/stageCacheContext.h>
+#include <pxr/usd/usdShade/material.h>
 #include <pxr/usd/usdUtils/stageCache.h>
 
 #include <boost/regex.hpp>
 
 #include <pystring/pystring.h>
 
+#include "usdKatana/boundsCache.h"
+#include "usdKatana/coordSysIndex.h"
 #include "usdKatana/debugCodes.h"
+#include "usdKatana/globalListsIndex.h"
 #include "usdKatana/locks.h"
+#include "usdKatana/prototypeMappingCache.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
 
 
 TF_INSTANTIATE_SINGLETON(UsdKatanaCache);
 
+TF_DEFINE_ENV_SETTING(USD_KATANA_SESSION_LAYER_CACHE_MAX_COUNT,
+                      1000,
+                      "Maximum number of session layers kept by UsdKatanaCache. "
+                      "Set to 0 for no limit.");
+
+TF_DEFINE_ENV_SETTING(USD_KATANA_SESSION_LAYER_CACHE_MAX_MB,
+                      256,
+                      "Approximate memory budget, in megabytes, of the session layers "
+                      "kept by UsdKatanaCache. Set to 0 for no limit.");
+
+// Rough memory held by each spec of a session layer, used to estimate the
+// size of the cached layers.
+static const size_t _sessionLayerSpecBytes = 256;
 
 namespace
 {
@@ -114,352 +138,529 @@ namespace
     }
 }  // namespace
 
-SdfLayerRefPtr& UsdKatanaCache::_FindOrCreateSessionLayer(FnAttribute::GroupAttribute sessionAttr,
-                                                          const std::string& rootLocation,
-                                                          const std::string& isolatePath)
+SdfLayerRefPtr UsdKatanaCache::_FindOrCreateSessionLayer(FnAttribute::GroupAttribute sessionAttr,
+                                                         const std::string& rootLocation,
+                                                         const std::string& isolatePath)
 {
-    // Grab a reader lock for reading the _sessionKeyCache
-    boost::upgrade_lock<boost::upgrade_mutex>
-                readerLock(UsdKatanaGetSessionCacheLock());
-    
-    
     std::string cacheKey = _ComputeCacheKey(sessionAttr, rootLocation);
-    
-    // Open the usd stage
-    
-    if (_sessionKeyCache.find(cacheKey) == _sessionKeyCache.end())
+    SdfLayerRefPtr sessionLayer;
+
     {
-        boost::upgrade_to_unique_lock<boost::upgrade_mutex>
-                    writerLock(readerLock);
-        SdfLayerRefPtr sessionLayer = SdfLayer::CreateAnonymous(".usda");
-        _sessionKeyCache[cacheKey] = sessionLayer;
-        
-        
-        std::string rootLocationPlusSlash = rootLocation + "/";
-        
-        
-        FnAttribute::GroupAttribute variantsAttr =
-                sessionAttr.getChildByName("variants");
-        for (int64_t i = 0, e = variantsAttr.getNumberOfChildren(); i != e;
-                ++i)
+        // Only Flush and eviction need exclusive access to the map as a
+        // whole; lookups and insertions only lock the entry they touch.
+        boost::shared_lock<boost::upgrade_mutex> readerLock(UsdKatanaGetSessionCacheLock());
+
+        // Hits share the entry with other readers.
         {
-            std::string entryName = FnAttribute::DelimiterDecode(
-                    variantsAttr.getChildName(i));
-            
-            FnAttribute::GroupAttribute entryVariantSets =
-                    variantsAttr.getChildByIndex(i);
-            
-            if (entryVariantSets.getNumberOfChildren() == 0)
+            _SessionLayerMap::const_accessor entryAccessor;
+            if (_sessionKeyCache.find(entryAccessor, cacheKey))
             {
-                continue;
+                ++_sessionLayerHits;
+                entryAccessor->second.lastUse = ++_useCounter;
+                return entryAccessor->second.layer;
             }
-            
-            if (!pystring::startswith(entryName, rootLocationPlusSlash))
+        }
+
+        _SessionLayerMap::accessor entryAccessor;
+        if (!_sessionKeyCache.insert(entryAccessor, cacheKey))
+        {
+            // Another thread created it in the meantime.
+            ++_sessionLayerHits;
+            entryAccessor->second.lastUse = ++_useCounter;
+            return entryAccessor->second.layer;
+        }
+
+        // Other threads asking for the same key wait on the entry accessor
+        // until the layer has been filled in.
+        ++_sessionLayerMisses;
+        sessionLayer = SdfLayer::CreateAnonymous(".usda");
+        _FillSessionLayer(sessionLayer, sessionAttr, rootLocation, isolatePath);
+
+        // Estimate the memory held by the layer from the number of specs
+        // authored in it, rather than serializing it.
+        size_t specCount = 0;
+        sessionLayer->Traverse(SdfPath::AbsoluteRootPath(),
+                               [&specCount](const SdfPath&) { ++specCount; });
+
+        _SessionLayerEntry& entry = entryAccessor->second;
+        entry.layer = sessionLayer;
+        entry.bytes = cacheKey.size() + specCount * _sessionLayerSpecBytes;
+        entry.lastUse = ++_useCounter;
+        _sessionLayerBytes += entry.bytes;
+    }
+
+    const size_t maxCount = _maxSessionLayers;
+    const size_t maxBytes = _maxSessionLayerBytes;
+    if ((maxCount > 0 && _sessionKeyCache.size() > maxCount) ||
+        (maxBytes > 0 && _sessionLayerBytes > maxBytes))
+    {
+        _EvictSessionLayers();
+    }
+
+    return sessionLayer;
+}
+
+void UsdKatanaCache::_EvictSessionLayers()
+{
+    UsdStageCache& stageCache = UsdUtilsStageCache::Get();
+
+    std::vector<SdfLayerRefPtr> evictedLayers;
+    {
+        boost::unique_lock<boost::upgrade_mutex> writerLock(UsdKatanaGetSessionCacheLock());
+
+        // A session layer is in use while anything other than this cache and
+        // the stage cache holds it, or a stage opened with it: a cook may be
+        // reading such a stage, or be about to open one with the layer it
+        // was just handed. Those are never evicted.
+        const std::vector<UsdStageRefPtr> cachedStages = stageCache.GetAllStages();
+        std::unordered_map<const SdfLayer*, size_t> idleStageCounts;
+        std::set<const SdfLayer*> busyLayers;
+        for (const UsdStageRefPtr& stage : cachedStages)
+        {
+            const SdfLayer* sessionLayer = get_pointer(stage->GetSessionLayer());
+            // Held by the stage cache and cachedStages only.
+            if (stage->GetCurrentCount() > 2)
             {
-                continue;
+                busyLayers.insert(sessionLayer);
             }
+            else
+            {
+                ++idleStageCounts[sessionLayer];
+            }
+        }
+        auto isInUse = [&](const SdfLayerRefPtr& layer) {
+            const SdfLayer* sessionLayer = get_pointer(layer);
+            if (busyLayers.count(sessionLayer))
+            {
+                return true;
+            }
+            const auto idleStageCount = idleStageCounts.find(sessionLayer);
+            return static_cast<size_t>(layer->GetCurrentCount()) >
+                   1 + (idleStageCount != idleStageCounts.end() ? idleStageCount->second : 0);
+        };
+
+        const size_t maxCount = _maxSessionLayers;
+        const size_t maxBytes = _maxSessionLayerBytes;
+
+        std::vector<std::pair<size_t, std::string>> entriesByUse;
+        entriesByUse.reserve(_sessionKeyCache.size());
+        for (const auto& entry : _sessionKeyCache)
+        {
+            entriesByUse.emplace_back(entry.second.lastUse.load(), entry.first);
+        }
+        std::sort(entriesByUse.begin(), entriesByUse.end());
 
-            const SdfPath varSelPath(isolatePath + pystring::slice(entryName, rootLocation.size()));
-            for (int64_t i = 0, e = entryVariantSets.getNumberOfChildren();
-                    i != e; ++i)
+        // Always keep the most recently used entry.
+        size_t count = entriesByUse.size();
+        for (size_t i = 0; i + 1 < entriesByUse.size(); ++i)
+        {
+            if ((maxCount == 0 || count <= maxCount) &&
+                (maxBytes == 0 || _sessionLayerBytes <= maxBytes))
             {
-                std::string variantSetName = entryVariantSets.getChildName(i);
-                
-                FnAttribute::StringAttribute variantValueAttr =
-                        entryVariantSets.getChildByIndex(i);
-                if (!variantValueAttr.isValid())
-                {
-                    continue;
-                }
+                break;
+            }
 
-                const std::string variantSetSelection = variantValueAttr.getValue("", false);
-                SdfPrimSpecHandle spec = SdfCreatePrimInLayer(
-                        sessionLayer, varSelPath.GetPrimPath());
-                if (spec)
-                {
-                    std::pair<std::string, std::string> sel = 
-                            varSelPath.GetVariantSelection();
-                    spec->SetVariantSelection(variantSetName,
-                            variantSetSelection);
-                }
+            _SessionLayerMap::accessor entryAccessor;
+            if (_sessionKeyCache.find(entryAccessor, entriesByUse[i].second) &&
+                !isInUse(entryAccessor->second.layer))
+            {
+                TF_DEBUG(USDKATANA_CACHE_STAGE).Msg(
+                    "{USD STAGE CACHE} Evicting session layer '%s'\n",
+                    entriesByUse[i].second.c_str());
+                _sessionLayerBytes -= entryAccessor->second.bytes;
+                evictedLayers.push_back(entryAccessor->second.layer);
+                _sessionKeyCache.erase(entryAccessor);
+                ++_sessionLayerEvictions;
+                --count;
             }
         }
+    }
+
+    if (evictedLayers.empty())
+    {
+        return;
+    }
+
+    // Stages opened with an evicted session layer can no longer be requested
+    // again, drop them rather than letting them linger in the stage cache.
+    for (const UsdStageRefPtr& stage : stageCache.GetAllStages())
+    {
+        if (std::find(evictedLayers.begin(), evictedLayers.end(), stage->GetSessionLayer()) !=
+            evictedLayers.end())
+        {
+            stageCache.Erase(stage);
+        }
+    }
+    _PruneMutedLayersStates();
+}
+
+/* static */
+void UsdKatanaCache::_FillSessionLayer(const SdfLayerRefPtr& sessionLayer,
+                                       FnAttribute::GroupAttribute sessionAttr,
+                                       const std::string& rootLocation,
+                                       const std::string& isolatePath)
+{
+    std::string rootLocationPlusSlash = rootLocation + "/";
+    
+    
+    FnAttribute::GroupAttribute variantsAttr =
+            sessionAttr.getChildByName("variants");
+    for (int64_t i = 0, e = variantsAttr.getNumberOfChildren(); i != e;
+            ++i)
+    {
+        std::string entryName = FnAttribute::DelimiterDecode(
+                variantsAttr.getChildName(i));
         
+        FnAttribute::GroupAttribute entryVariantSets =
+                variantsAttr.getChildByIndex(i);
         
-        FnAttribute::GroupAttribute activationsAttr =
-                sessionAttr.getChildByName("activations");
-        for (int64_t i = 0, e = activationsAttr.getNumberOfChildren(); i != e;
-                ++i)
+        if (entryVariantSets.getNumberOfChildren() == 0)
         {
-            std::string entryName = FnAttribute::DelimiterDecode(
-                    activationsAttr.getChildName(i));
-            
-            FnAttribute::IntAttribute stateAttr =
-                    activationsAttr.getChildByIndex(i);
+            continue;
+        }
+        
+        if (!pystring::startswith(entryName, rootLocationPlusSlash))
+        {
+            continue;
+        }
+
+        const SdfPath varSelPath(isolatePath + pystring::slice(entryName, rootLocation.size()));
+        for (int64_t i = 0, e = entryVariantSets.getNumberOfChildren();
+                i != e; ++i)
+        {
+            std::string variantSetName = entryVariantSets.getChildName(i);
             
-            if (stateAttr.getNumberOfValues() != 1)
+            FnAttribute::StringAttribute variantValueAttr =
+                    entryVariantSets.getChildByIndex(i);
+            if (!variantValueAttr.isValid())
             {
                 continue;
             }
-            
-            if (!pystring::startswith(entryName, rootLocationPlusSlash))
+
+            const std::string variantSetSelection = variantValueAttr.getValue("", false);
+            SdfPrimSpecHandle spec = SdfCreatePrimInLayer(
+                    sessionLayer, varSelPath.GetPrimPath());
+            if (spec)
             {
-                continue;
+                std::pair<std::string, std::string> sel = 
+                        varSelPath.GetVariantSelection();
+                spec->SetVariantSelection(variantSetName,
+                        variantSetSelection);
             }
-
-            const SdfPath activationsPath(isolatePath +
-                                          pystring::slice(entryName, rootLocation.size()));
-            SdfPrimSpecHandle spec =
-                SdfCreatePrimInLayer(sessionLayer, activationsPath.GetPrimPath());
-            spec->SetActive(stateAttr.getValue());
         }
+    }
+    
+    
+    FnAttribute::GroupAttribute activationsAttr =
+            sessionAttr.getChildByName("activations");
+    for (int64_t i = 0, e = activationsAttr.getNumberOfChildren(); i != e;
+            ++i)
+    {
+        std::string entryName = FnAttribute::DelimiterDecode(
+                activationsAttr.getChildName(i));
+        
+        FnAttribute::IntAttribute stateAttr =
+                activationsAttr.getChildByIndex(i);
+        
+        if (stateAttr.getNumberOfValues() != 1)
+        {
+            continue;
+        }
+        
+        if (!pystring::startswith(entryName, rootLocationPlusSlash))
+        {
+            continue;
+        }
+
+        const SdfPath activationsPath(isolatePath +
+                                      pystring::slice(entryName, rootLocation.size()));
+        SdfPrimSpecHandle spec =
+            SdfCreatePrimInLayer(sessionLayer, activationsPath.GetPrimPath());
+        spec->SetActive(stateAttr.getValue());
+    }
+    
+    FnAttribute::GroupAttribute attrsAttr =
+            sessionAttr.getChildByName("attrs");
+    
+    for (int64_t i = 0, e = attrsAttr.getNumberOfChildren(); i != e;
+            ++i)
+    {
+        std::string entryName = FnAttribute::DelimiterDecode(
+                attrsAttr.getChildName(i));
+        
+        FnAttribute::GroupAttribute entryAttr =
+                attrsAttr.getChildByIndex(i);            
         
-        FnAttribute::GroupAttribute attrsAttr =
-                sessionAttr.getChildByName("attrs");
+        if (!pystring::startswith(entryName, rootLocationPlusSlash))
+        {
+            continue;
+        }
+
+        const SdfPath attrsPath(isolatePath + pystring::slice(entryName, rootLocation.size()));
+        SdfPrimSpecHandle spec = SdfCreatePrimInLayer(sessionLayer, attrsPath.GetPrimPath());
+        if (!spec)
+        {
+            continue;
+        }
         
-        for (int64_t i = 0, e = attrsAttr.getNumberOfChildren(); i != e;
-                ++i)
+        for (int64_t i = 0, e = entryAttr.getNumberOfChildren(); i != e;
+            ++i)
         {
-            std::string entryName = FnAttribute::DelimiterDecode(
-                    attrsAttr.getChildName(i));
+            std::string attrName = entryAttr.getChildName(i);
+            FnAttribute::GroupAttribute attrDef =
+                    entryAttr.getChildByIndex(i);
+
+            FnAttribute::IntAttribute forceArrayAttr = 
+                attrDef.getChildByName("forceArray");
             
-            FnAttribute::GroupAttribute entryAttr =
-                    attrsAttr.getChildByIndex(i);            
             
-            if (!pystring::startswith(entryName, rootLocationPlusSlash))
+            FnAttribute::DataAttribute valueAttr =
+                    attrDef.getChildByName("value");
+            if (!valueAttr.isValid())
             {
                 continue;
             }
-
-            const SdfPath attrsPath(isolatePath + pystring::slice(entryName, rootLocation.size()));
-            SdfPrimSpecHandle spec = SdfCreatePrimInLayer(sessionLayer, attrsPath.GetPrimPath());
-            if (!spec)
+            
+            // TODO, additional SdfValueTypes, blocking, metadata
+            
+            switch (valueAttr.getType())
             {
-                continue;
+            case kFnKatAttributeTypeInt:
+            {
+                AddSimpleTypedSdfAttribute<
+                        FnAttribute::IntAttribute, int>(
+                        spec, attrName, valueAttr, forceArrayAttr,
+                        SdfValueTypeNames->Int);
+                
+                break;
             }
-            
-            for (int64_t i = 0, e = entryAttr.getNumberOfChildren(); i != e;
-                ++i)
+            case kFnKatAttributeTypeFloat:
+            {
+                AddSimpleTypedSdfAttribute<
+                        FnAttribute::FloatAttribute, float>(
+                        spec, attrName, valueAttr, forceArrayAttr,
+                        SdfValueTypeNames->Float);
+                
+                break;
+            }
+            case kFnKatAttributeTypeDouble:
+            {
+                AddSimpleTypedSdfAttribute<
+                        FnAttribute::DoubleAttribute, double>(
+                        spec, attrName, valueAttr, forceArrayAttr,
+                        SdfValueTypeNames->Double);
+                break;
+            }
+            case kFnKatAttributeTypeString:
             {
-                std::string attrName = entryAttr.getChildName(i);
-                FnAttribute::GroupAttribute attrDef =
-                        entryAttr.getChildByIndex(i);
+                AddSimpleTypedSdfAttribute<
+                        FnAttribute::StringAttribute, std::string>(
+                        spec, attrName, valueAttr, forceArrayAttr,
+                        SdfValueTypeNames->String);
+                
+                break;
+            }
+            default:
+                break;
+            };
+        }
+    }
+    
+
 
-                FnAttribute::IntAttribute forceArrayAttr = 
-                    attrDef.getChildByName("forceArray");
+    FnAttribute::GroupAttribute metadataAttr =
+            sessionAttr.getChildByName("metadata");
+    for (int64_t i = 0, e = metadataAttr.getNumberOfChildren(); i != e;
+            ++i)
+    {            
+        std::string entryName = FnAttribute::DelimiterDecode(
+                metadataAttr.getChildName(i));
+        
+        FnAttribute::GroupAttribute entryAttr =
+                metadataAttr.getChildByIndex(i);            
+        
+        if (!pystring::startswith(entryName, rootLocationPlusSlash))
+        {
+            continue;
+        }
+
+        const SdfPath metadataPath(isolatePath +
+                                   pystring::slice(entryName, rootLocation.size()));
+        SdfPrimSpecHandle spec = SdfCreatePrimInLayer(sessionLayer, metadataPath.GetPrimPath());
+        if (!spec)
+        {
+            continue;
+        }
+        
+        
+        // Currently support only metadata at the prim level
+        FnAttribute::GroupAttribute primEntries =
+                entryAttr.getChildByName("prim");
+        for (int64_t i = 0, e = primEntries.getNumberOfChildren(); i < e; ++i)
+        {
+            FnAttribute::GroupAttribute attrDefGrp =
+                    primEntries.getChildByIndex(i);
+            std::string attrName = primEntries.getChildName(i);
+            
+            std::string typeName  = FnAttribute::StringAttribute(
+                    attrDefGrp.getChildByName("type")).getValue("", false);
+            if (typeName == "SdfInt64ListOp")
+            {
+                FnAttribute::IntAttribute valueAttr;
                 
+                SdfInt64ListOp listOp;
+                std::vector<int64_t> itemList;
                 
-                FnAttribute::DataAttribute valueAttr =
-                        attrDef.getChildByName("value");
-                if (!valueAttr.isValid())
+                auto convertFnc = [](
+                        FnAttribute::IntAttribute intAttr,
+                        std::vector<int64_t> & outputItemList)
                 {
-                    continue;
-                }
-                
-                // TODO, additional SdfValueTypes, blocking, metadata
+                    outputItemList.clear();
+                    if (intAttr.getNumberOfValues() == 0)
+                    {
+                        return;
+                    }
+                    
+                    auto sample = intAttr.getNearestSample(0);
+                    outputItemList.reserve(sample.size());
+                    outputItemList.insert(outputItemList.end(),
+                            sample.begin(), sample.end());
+                };
                 
-                switch (valueAttr.getType())
+                valueAttr = attrDefGrp.getChildByName("listOp.explicit");
+                if (valueAttr.isValid())
                 {
-                case kFnKatAttributeTypeInt:
+                    convertFnc(valueAttr, itemList);
+                    listOp.SetExplicitItems(itemList);
+                }
+                
+                valueAttr = attrDefGrp.getChildByName("listOp.added");
+                if (valueAttr.isValid())
                 {
-                    AddSimpleTypedSdfAttribute<
-                            FnAttribute::IntAttribute, int>(
-                            spec, attrName, valueAttr, forceArrayAttr,
-                            SdfValueTypeNames->Int);
-                    
-                    break;
+                    convertFnc(valueAttr, itemList);
+                    listOp.SetAddedItems(itemList);
                 }
-                case kFnKatAttributeTypeFloat:
+                
+                valueAttr = attrDefGrp.getChildByName("listOp.deleted");
+                if (valueAttr.isValid())
                 {
-                    AddSimpleTypedSdfAttribute<
-                            FnAttribute::FloatAttribute, float>(
-                            spec, attrName, valueAttr, forceArrayAttr,
-                            SdfValueTypeNames->Float);
-                    
-                    break;
+                    convertFnc(valueAttr, itemList);
+                    listOp.SetDeletedItems(itemList);
                 }
-                case kFnKatAttributeTypeDouble:
+                
+                valueAttr = attrDefGrp.getChildByName("listOp.ordered");
+                if (valueAttr.isValid())
                 {
-                    AddSimpleTypedSdfAttribute<
-                            FnAttribute::DoubleAttribute, double>(
-                            spec, attrName, valueAttr, forceArrayAttr,
-                            SdfValueTypeNames->Double);
-                    break;
+                    convertFnc(valueAttr, itemList);
+                    listOp.SetOrderedItems(itemList);
                 }
-                case kFnKatAttributeTypeString:
+                
+                valueAttr = attrDefGrp.getChildByName("listOp.prepended");
+                if (valueAttr.isValid())
                 {
-                    AddSimpleTypedSdfAttribute<
-                            FnAttribute::StringAttribute, std::string>(
-                            spec, attrName, valueAttr, forceArrayAttr,
-                            SdfValueTypeNames->String);
-                    
-                    break;
+                    convertFnc(valueAttr, itemList);
+                    listOp.SetPrependedItems(itemList);
                 }
-                default:
-                    break;
-                };
-            }
-        }
-        
-
-
-        FnAttribute::GroupAttribute metadataAttr =
-                sessionAttr.getChildByName("metadata");
-        for (int64_t i = 0, e = metadataAttr.getNumberOfChildren(); i != e;
-                ++i)
-        {            
-            std::string entryName = FnAttribute::DelimiterDecode(
-                    metadataAttr.getChildName(i));
-            
-            FnAttribute::GroupAttribute entryAttr =
-                    metadataAttr.getChildByIndex(i);            
-            
-            if (!pystring::startswith(entryName, rootLocationPlusSlash))
-            {
-                continue;
-            }
-
-            const SdfPath metadataPath(isolatePath +
-                                       pystring::slice(entryName, rootLocation.size()));
-            SdfPrimSpecHandle spec = SdfCreatePrimInLayer(sessionLayer, metadataPath.GetPrimPath());
-            if (!spec)
-            {
-                continue;
-            }
-            
-            
-            // Currently support only metadata at the prim level
-            FnAttribute::GroupAttribute primEntries =
-                    entryAttr.getChildByName("prim");
-            for (int64_t i = 0, e = primEntries.getNumberOfChildren(); i < e; ++i)
-            {
-                FnAttribute::GroupAttribute attrDefGrp =
-                        primEntries.getChildByIndex(i);
-                std::string attrName = primEntries.getChildName(i);
                 
-                std::string typeName  = FnAttribute::StringAttribute(
-                        attrDefGrp.getChildByName("type")).getValue("", false);
-                if (typeName == "SdfInt64ListOp")
+                valueAttr = attrDefGrp.getChildByName("listOp.appended");
+                if (valueAttr.isValid())
                 {
-                    FnAttribute::IntAttribute valueAttr;
-                    
-                    SdfInt64ListOp listOp;
-                    std::vector<int64_t> itemList;
-                    
-                    auto convertFnc = [](
-                            FnAttribute::IntAttribute intAttr,
-                            std::vector<int64_t> & outputItemList)
-                    {
-                        outputItemList.clear();
-                        if (intAttr.getNumberOfValues() == 0)
-                        {
-                            return;
-                        }
-                        
-                        auto sample = intAttr.getNearestSample(0);
-                        outputItemList.reserve(sample.size());
-                        outputItemList.insert(outputItemList.end(),
-                                sample.begin(), sample.end());
-                    };
-                    
-                    valueAttr = attrDefGrp.getChildByName("listOp.explicit");
-                    if (valueAttr.isValid())
-                    {
-                        convertFnc(valueAttr, itemList);
-                        listOp.SetExplicitItems(itemList);
-                    }
-                    
-                    valueAttr = attrDefGrp.getChildByName("listOp.added");
-                    if (valueAttr.isValid())
-                    {
-                        convertFnc(valueAttr, itemList);
-                        listOp.SetAddedItems(itemList);
-                    }
-                    
-                    valueAttr = attrDefGrp.getChildByName("listOp.deleted");
-                    if (valueAttr.isValid())
-                    {
-                        convertFnc(valueAttr, itemList);
-                        listOp.SetDeletedItems(itemList);
-                    }
-                    
-                    valueAttr = attrDefGrp.getChildByName("listOp.ordered");
-                    if (valueAttr.isValid())
-                    {
-                        convertFnc(valueAttr, itemList);
-                        listOp.SetOrderedItems(itemList);
-                    }
-                    
-                    valueAttr = attrDefGrp.getChildByName("listOp.prepended");
-                    if (valueAttr.isValid())
-                    {
-                        convertFnc(valueAttr, itemList);
-                        listOp.SetPrependedItems(itemList);
-                    }
-                    
-                    valueAttr = attrDefGrp.getChildByName("listOp.appended");
-                    if (valueAttr.isValid())
-                    {
-                        convertFnc(valueAttr, itemList);
-                        listOp.SetAppendedItems(itemList);
-                    }
-                    
-                    spec->SetInfo(TfToken(attrName), VtValue(listOp));
+                    convertFnc(valueAttr, itemList);
+                    listOp.SetAppendedItems(itemList);
                 }
+                
+                spec->SetInfo(TfToken(attrName), VtValue(listOp));
             }
         }
+    }
 
-        FnAttribute::StringAttribute dynamicSublayersAttr =
-                sessionAttr.getChildByName("subLayers");
+    FnAttribute::StringAttribute dynamicSublayersAttr =
+            sessionAttr.getChildByName("subLayers");
 
-        if (dynamicSublayersAttr.getNumberOfValues() > 0)
+    if (dynamicSublayersAttr.getNumberOfValues() > 0)
+    {
+        FnAttribute::StringAttribute::array_type dynamicSublayers =
+            dynamicSublayersAttr.getNearestSample(0);
+        if (dynamicSublayersAttr.getTupleSize() != 2 || dynamicSublayers.size() % 2 != 0)
         {
-            FnAttribute::StringAttribute::array_type dynamicSublayers =
-                dynamicSublayersAttr.getNearestSample(0);
-            if (dynamicSublayersAttr.getTupleSize() != 2 || dynamicSublayers.size() % 2 != 0)
-            {
-                TF_CODING_ERROR("sublayers must contain a list of two-tuples [(rootLocation, sublayerIdentifier)]");
-            }
+            TF_CODING_ERROR("sublayers must contain a list of two-tuples [(rootLocation, sublayerIdentifier)]");
+        }
 
-            std::set<std::string> subLayersSet;
-            std::vector<std::string> subLayers;
-            for (size_t i = 0; i < dynamicSublayers.size(); i += 2)
+        std::set<std::string> subLayersSet;
+        std::vector<std::string> subLayers;
+        for (size_t i = 0; i < dynamicSublayers.size(); i += 2)
+        {
+            std::string sublayerRootLocation = dynamicSublayers[i];
+            if (sublayerRootLocation == rootLocation && strlen(dynamicSublayers[i + 1]) > 0)
             {
-                std::string sublayerRootLocation = dynamicSublayers[i];
-                if (sublayerRootLocation == rootLocation && strlen(dynamicSublayers[i + 1]) > 0)
+                if (subLayersSet.find(dynamicSublayers[i + 1]) == subLayersSet.end())
                 {
-                    if (subLayersSet.find(dynamicSublayers[i + 1]) == subLayersSet.end())
-                    {
-                        subLayers.push_back(dynamicSublayers[i+1]);
-                        subLayersSet.insert(dynamicSublayers[i+1]);
-                    }
-                    else
-                    {
-                        TF_CODING_ERROR("Cannot add same sublayer twice.");
-                    }
+                    subLayers.push_back(dynamicSublayers[i+1]);
+                    subLayersSet.insert(dynamicSublayers[i+1]);
+                }
+                else
+                {
+                    TF_CODING_ERROR("Cannot add same sublayer twice.");
                 }
             }
-            sessionLayer->SetSubLayerPaths(subLayers);
         }
+        sessionLayer->SetSubLayerPaths(subLayers);
     }
-    
-    return _sessionKeyCache[cacheKey];
 }
 
+namespace
+{
+// Compiling a regex is far more expensive than matching with it, and the
+// same few ignoreLayerRegex values are applied over and over.
+std::shared_ptr<const boost::regex> _GetCompiledRegex(const std::string& layerRegex)
+{
+    static const size_t kMaxCachedRegexes = 32;
+    static std::mutex s_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const boost::regex>> s_regexes;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto it = s_regexes.find(layerRegex);
+    if (it != s_regexes.end())
+    {
+        return it->second;
+    }
+    if (s_regexes.size() >= kMaxCachedRegexes)
+    {
+        s_regexes.clear();
+    }
+    std::shared_ptr<const boost::regex> regex = std::make_shared<const boost::regex>(layerRegex);
+    s_regexes.emplace(layerRegex, regex);
+    return regex;
+}
+
+size_t _HashUsedLayers(const SdfLayerHandleVector& layers)
+{
+    size_t hash = layers.size();
+    for (const SdfLayerHandle& layer : layers)
+    {
+        hash = TfHash::Combine(hash, layer.GetUniqueIdentifier());
+    }
+    return hash;
+}
+}  // namespace
+
 /* static */
 void
 UsdKatanaCache::_SetMutedLayers(
-    const UsdStageRefPtr &stage, const std::string &layerRegex) 
+    const UsdStageRefPtr &stage, const std::string &layerRegex,
+    const SdfLayerHandleVector &stageLayers) 
 {
     // Trace this function to track its performance
     TRACE_FUNCTION();
 
     // Unmute layers that are currently muted, but not requested to be muted
-    SdfLayerHandleVector stageLayers = stage->GetUsedLayers();
-
     bool regexIsEmpty = layerRegex == "" || layerRegex == "^$";
     
-    boost::regex regex(layerRegex);
+    std::shared_ptr<const boost::regex> regex;
+    if (!regexIsEmpty)
+    {
+        regex = _GetCompiledRegex(layerRegex);
+    }
 
     TF_FOR_ALL(stageLayer, stageLayers)
     {
@@ -467,14 +668,13 @@ UsdKatanaCache::_SetMutedLayers(
         if (!layer) {
             continue;
         }
-        std::string layerPath = layer->GetRepositoryPath();
         const std::string layerIdentifier = layer->GetIdentifier();
 
         bool match = false;
         
         if (!regexIsEmpty)
         {
-            if (boost::regex_match(layerIdentifier, regex))
+            if (boost::regex_match(layerIdentifier, *regex))
             {
                 match = true;
             }
@@ -496,7 +696,70 @@ UsdKatanaCache::_SetMutedLayers(
     }
 }
 
-UsdKatanaCache::UsdKatanaCache() 
+void UsdKatanaCache::_ReconcileMutedLayers(const UsdStageRefPtr& stage,
+                                           const std::string& layerRegex)
+{
+    const bool regexIsEmpty = layerRegex == "" || layerRegex == "^$";
+
+    // Nothing to mute and nothing to unmute.
+    if (regexIsEmpty && stage->GetMutedLayers().empty())
+    {
+        return;
+    }
+
+    SdfLayerHandleVector stageLayers = stage->GetUsedLayers();
+    size_t usedLayersHash = _HashUsedLayers(stageLayers);
+
+    {
+        std::lock_guard<std::mutex> lock(_mutedLayersMutex);
+        auto it = _mutedLayersStates.find(get_pointer(stage));
+        if (it != _mutedLayersStates.end() && !it->second.stage.IsExpired() &&
+            it->second.layerRegex == layerRegex && it->second.usedLayersHash == usedLayersHash)
+        {
+            return;
+        }
+    }
+
+    _SetMutedLayers(stage, layerRegex, stageLayers);
+
+    // Muting and unmuting change the used layers, record the resulting set
+    // so the next request for the same regex is a no-op.
+    usedLayersHash = _HashUsedLayers(stage->GetUsedLayers());
+
+    std::lock_guard<std::mutex> lock(_mutedLayersMutex);
+    _MutedLayersState& state = _mutedLayersStates[get_pointer(stage)];
+    state.stage = stage;
+    state.layerRegex = layerRegex;
+    state.usedLayersHash = usedLayersHash;
+}
+
+void UsdKatanaCache::_PruneMutedLayersStates()
+{
+    std::lock_guard<std::mutex> lock(_mutedLayersMutex);
+    for (auto it = _mutedLayersStates.begin(); it != _mutedLayersStates.end();)
+    {
+        if (it->second.stage.IsExpired())
+        {
+            it = _mutedLayersStates.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+UsdKatanaCache::UsdKatanaCache()
+    : _sessionLayerBytes(0),
+      _useCounter(0),
+      _sessionLayerHits(0),
+      _sessionLayerMisses(0),
+      _sessionLayerEvictions(0),
+      _maxSessionLayers(
+          static_cast<size_t>(std::max(0, TfGetEnvSetting(USD_KATANA_SESSION_LAYER_CACHE_MAX_COUNT)))),
+      _maxSessionLayerBytes(
+          static_cast<size_t>(std::max(0, TfGetEnvSetting(USD_KATANA_SESSION_LAYER_CACHE_MAX_MB))) *
+          1024 * 1024)
 {
 }
 
@@ -511,6 +774,63 @@ UsdKatanaCache::Flush()
 
     UsdUtilsStageCache::Get().Clear();
     _sessionKeyCache.clear();
+    _sessionLayerBytes = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutedLayersMutex);
+        _mutedLayersStates.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_materialLibraryStagesMutex);
+        _materialLibraryStages.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_prototypeMappingsMutex);
+        _prototypeMappings.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_coordSysIndicesMutex);
+        _coordSysIndices.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_globalListsIndicesMutex);
+        _globalListsIndices.clear();
+    }
+
+    UsdKatanaBoundsCache::GetInstance().Clear();
+}
+
+UsdKatanaCache::Stats UsdKatanaCache::GetStats() const
+{
+    Stats stats;
+    stats.stages = UsdUtilsStageCache::Get().Size();
+    stats.sessionLayers = _sessionKeyCache.size();
+    stats.sessionLayerBytes = _sessionLayerBytes;
+    stats.sessionLayerHits = _sessionLayerHits;
+    stats.sessionLayerMisses = _sessionLayerMisses;
+    stats.sessionLayerEvictions = _sessionLayerEvictions;
+    stats.maxSessionLayers = _maxSessionLayers;
+    stats.maxSessionLayerBytes = _maxSessionLayerBytes;
+    {
+        std::lock_guard<std::mutex> lock(_materialLibraryStagesMutex);
+        stats.materialLibraryStages = _materialLibraryStages.size();
+    }
+    return stats;
+}
+
+void UsdKatanaCache::SetSessionLayerLimits(size_t maxCount, size_t maxBytes)
+{
+    _maxSessionLayers = maxCount;
+    _maxSessionLayerBytes = maxBytes;
+    if ((maxCount > 0 && _sessionKeyCache.size() > maxCount) ||
+        (maxBytes > 0 && _sessionLayerBytes > maxBytes))
+    {
+        _EvictSessionLayers();
+    }
 }
 
 
@@ -660,7 +980,7 @@ UsdStageRefPtr UsdKatanaCache::GetStage(
             fileName.c_str(), _ResolvePath(fileName).c_str());
 
     if (SdfLayerRefPtr rootLayer = SdfLayer::FindOrOpen(fileName)) {
-        SdfLayerRefPtr& sessionLayer =
+        SdfLayerRefPtr sessionLayer =
             _FindOrCreateSessionLayer(sessionAttr, sessionRootLocation, isolatePath);
 
         UsdStageCache& stageCache = UsdUtilsStageCache::Get();
@@ -702,8 +1022,9 @@ UsdStageRefPtr UsdKatanaCache::GetStage(
                     sessionAttr.getHash().str().c_str());
         }
         
-        // Mute layers according to a regex.
-        _SetMutedLayers(stage, ignoreLayerRegex);
+        // Mute layers according to a regex, unless the stage is already
+        // muted that way.
+        _ReconcileMutedLayers(stage, ignoreLayerRegex);
 
         return stage;
     }
@@ -727,7 +1048,7 @@ UsdKatanaCache::GetUncachedStage(std::string const& fileName,
             fileName.c_str(), _ResolvePath(fileName).c_str());
 
     if (SdfLayerRefPtr rootLayer = SdfLayer::FindOrOpen(fileName)) {
-        SdfLayerRefPtr& sessionLayer =
+        SdfLayerRefPtr sessionLayer =
             _FindOrCreateSessionLayer(sessionAttr, sessionRootLocation, isolatePath);
         UsdStagePopulationMask mask;
         FillPopulationMaskFromSessionAttr(sessionAttr, sessionRootLocation, isolatePath, mask);
@@ -751,7 +1072,7 @@ UsdKatanaCache::GetUncachedStage(std::string const& fileName,
                     sessionAttr.getHash().str().c_str());
         
         // Mute layers according to a regex.
-        _SetMutedLayers(stage, ignoreLayerRegex);
+        _SetMutedLayers(stage, ignoreLayerRegex, stage->GetUsedLayers());
 
         return stage;
     }
@@ -760,11 +1081,360 @@ UsdKatanaCache::GetUncachedStage(std::string const& fileName,
 }
 
 
+// Whether \p mask populates \p materialPath or, if it is empty, the whole
+// stage.
+static bool _MaterialLibraryMaskIncludes(const UsdStagePopulationMask& mask,
+                                         const SdfPath& materialPath)
+{
+    return materialPath.IsEmpty() ? mask.IncludesSubtree(SdfPath::AbsoluteRootPath())
+                                  : mask.Includes(materialPath);
+}
+
+// Widen the mask of \p stage to the prims its masked prims depend on.
+static void _ExpandMaterialLibraryMask(const UsdStageRefPtr& stage)
+{
+    if (stage->GetPopulationMask().IncludesSubtree(SdfPath::AbsoluteRootPath()))
+    {
+        return;
+    }
+
+    // Connection sources and relationship targets are pulled in by
+    // ExpandPopulationMask(); base materials are added explicitly. Each new
+    // prim may bring further dependencies, so repeat until the mask settles.
+    while (true)
+    {
+        stage->ExpandPopulationMask();
+        UsdStagePopulationMask expandedMask = stage->GetPopulationMask();
+        bool maskChanged = false;
+        for (const SdfPath& path : expandedMask.GetPaths())
+        {
+            const UsdShadeMaterial material(stage->GetPrimAtPath(path));
+            if (!material)
+            {
+                continue;
+            }
+            const SdfPath baseMaterialPath = material.GetBaseMaterialPath();
+            if (!baseMaterialPath.IsEmpty() && !expandedMask.Includes(baseMaterialPath))
+            {
+                expandedMask.Add(baseMaterialPath);
+                maskChanged = true;
+            }
+        }
+        if (!maskChanged)
+        {
+            break;
+        }
+        stage->SetPopulationMask(expandedMask);
+    }
+}
+
+// Open \p rootLayer without payloads, populating only \p materialPath and the
+// prims it depends on, or the whole stage if \p materialPath is empty.
+static UsdStageRefPtr _OpenMaterialLibraryStage(const SdfLayerRefPtr& rootLayer,
+                                                const SdfPath& materialPath)
+{
+    const ArResolverContext context = ArGetResolver().GetCurrentContext();
+    if (materialPath.IsEmpty())
+    {
+        return UsdStage::Open(rootLayer, context, UsdStage::LoadNone);
+    }
+
+    UsdStageRefPtr stage = UsdStage::OpenMasked(
+        rootLayer, context, UsdStagePopulationMask({materialPath}), UsdStage::LoadNone);
+    if (stage)
+    {
+        _ExpandMaterialLibraryMask(stage);
+    }
+    return stage;
+}
+
+UsdStageRefPtr UsdKatanaCache::GetMaterialLibraryStage(const std::string& fileName,
+                                                       const SdfPath& materialPath)
+{
+    SdfLayerRefPtr rootLayer = SdfLayer::FindOrOpen(fileName);
+    if (!rootLayer)
+    {
+        return UsdStageRefPtr();
+    }
+
+    const std::string& key = rootLayer->GetIdentifier();
+    const ArResolverContext context = ArGetResolver().GetCurrentContext();
+    UsdStageRefPtr stage;
+    {
+        std::lock_guard<std::mutex> lock(_materialLibraryStagesMutex);
+        auto it = _materialLibraryStages.find(key);
+        if (it != _materialLibraryStages.end() &&
+            it->second->GetPathResolverContext() == context)
+        {
+            stage = it->second;
+        }
+    }
+
+    if (!stage)
+    {
+        // Open outside of the lock; should another thread have raced us, its
+        // stage is kept and widened below instead.
+        UsdStageRefPtr openedStage = _OpenMaterialLibraryStage(rootLayer, materialPath);
+        if (!openedStage)
+        {
+            return openedStage;
+        }
+
+        TF_DEBUG(USDKATANA_CACHE_STAGE).Msg(
+                "{USD STAGE CACHE} Loaded material library stage "
+                "(%s, materialPath=%s) "
+                "with UsdStage address '%lx'\n",
+                fileName.c_str(),
+                materialPath.GetText(),
+                (size_t)openedStage.operator->());
+
+        std::lock_guard<std::mutex> lock(_materialLibraryStagesMutex);
+        UsdStageRefPtr& cachedStage = _materialLibraryStages[key];
+        if (!cachedStage || cachedStage->GetPathResolverContext() != context)
+        {
+            cachedStage = openedStage;
+            return openedStage;
+        }
+        stage = cachedStage;
+    }
+
+    {
+        boost::shared_lock<boost::upgrade_mutex> readerLock(
+            UsdKatanaGetMaterialLibraryStageLock());
+        if (_MaterialLibraryMaskIncludes(stage->GetPopulationMask(), materialPath))
+        {
+            return stage;
+        }
+    }
+
+    // Every material of a library shares one stage, whose mask is widened in
+    // place to include each material asked for. Readers of the stage hold
+    // the material library stage lock, so wait for them to finish.
+    boost::unique_lock<boost::upgrade_mutex> writerLock(UsdKatanaGetMaterialLibraryStageLock());
+    const UsdStagePopulationMask stageMask = stage->GetPopulationMask();
+    if (!_MaterialLibraryMaskIncludes(stageMask, materialPath))
+    {
+        TF_DEBUG(USDKATANA_CACHE_STAGE).Msg(
+                "{USD STAGE CACHE} Widening material library stage "
+                "(%s, materialPath=%s) "
+                "with UsdStage address '%lx'\n",
+                fileName.c_str(),
+                materialPath.GetText(),
+                (size_t)stage.operator->());
+
+        if (materialPath.IsEmpty())
+        {
+            stage->SetPopulationMask(UsdStagePopulationMask::All());
+        }
+        else
+        {
+            stage->SetPopulationMask(stageMask.GetUnion(materialPath));
+            _ExpandMaterialLibraryMask(stage);
+        }
+    }
+    return stage;
+}
+
+FnAttribute::GroupAttribute UsdKatanaCache::GetInstancePrototypeMapping(
+    const UsdStageRefPtr& stage,
+    const SdfPath& rootPath)
+{
+    if (!stage)
+    {
+        return FnAttribute::GroupAttribute(true);
+    }
+
+    std::shared_ptr<UsdKatanaPrototypeMappingCache> cache;
+    {
+        std::lock_guard<std::mutex> lock(_prototypeMappingsMutex);
+
+        // Forget the mappings of stages which no longer exist.
+        for (auto it = _prototypeMappings.begin(); it != _prototypeMappings.end();)
+        {
+            if (it->second.stage.IsExpired())
+            {
+                it = _prototypeMappings.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        _PrototypeMappingEntry& entry = _prototypeMappings[get_pointer(stage)];
+        if (!entry.cache)
+        {
+            entry.stage = stage;
+            entry.cache = std::make_shared<UsdKatanaPrototypeMappingCache>(stage);
+        }
+        cache = entry.cache;
+    }
+    return cache->GetMapping(rootPath);
+}
+
+FnAttribute::GroupAttribute UsdKatanaCache::GetModelCoordinateSystems(
+    const UsdStageRefPtr& stage,
+    const SdfPath& modelPath,
+    const std::string& rootLocation)
+{
+    if (!stage)
+    {
+        return FnAttribute::GroupAttribute(true);
+    }
+
+    std::shared_ptr<UsdKatanaCoordSysIndex> index;
+    {
+        std::lock_guard<std::mutex> lock(_coordSysIndicesMutex);
+
+        // Forget the indices of stages which no longer exist.
+        for (auto it = _coordSysIndices.begin(); it != _coordSysIndices.end();)
+        {
+            if (it->second.stage.IsExpired())
+            {
+                it = _coordSysIndices.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        _CoordSysIndexEntry& entry = _coordSysIndices[get_pointer(stage)];
+        if (!entry.index)
+        {
+            entry.stage = stage;
+            entry.index = std::make_shared<UsdKatanaCoordSysIndex>(stage);
+        }
+        index = entry.index;
+    }
+    return index->GetCoordinateSystems(modelPath, rootLocation);
+}
+
+std::shared_ptr<UsdKatanaGlobalListsIndex> UsdKatanaCache::GetGlobalListsIndex(
+    const UsdStageRefPtr& stage)
+{
+    if (!stage)
+    {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(_globalListsIndicesMutex);
+
+    // Forget the indices of stages which no longer exist.
+    for (auto it = _globalListsIndices.begin(); it != _globalListsIndices.end();)
+    {
+        if (it->second.stage.IsExpired())
+        {
+            it = _globalListsIndices.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    _GlobalListsIndexEntry& entry = _globalListsIndices[get_pointer(stage)];
+    if (!entry.index)
+    {
+        entry.stage = stage;
+        entry.index = std::make_shared<UsdKatanaGlobalListsIndex>(stage);
+    }
+    return entry.index;
+}
+
 void UsdKatanaCache::FlushStage(const UsdStageRefPtr & stage)
 {
     UsdStageCache& stageCache = UsdUtilsStageCache::Get();
     
     stageCache.Erase(stage);
+
+    _PruneMutedLayersStates();
+
+    {
+        std::lock_guard<std::mutex> lock(_prototypeMappingsMutex);
+        _prototypeMappings.erase(get_pointer(stage));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_coordSysIndicesMutex);
+        _coordSysIndices.erase(get_pointer(stage));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_globalListsIndicesMutex);
+        _globalListsIndices.erase(get_pointer(stage));
+    }
+
+    UsdKatanaBoundsCache::GetInstance().ClearStage(stage);
+}
+
+// Erase the per-stage \p entries of stages which have expired or whose root
+// layer is \p rootLayer.
+template <typename Entries>
+static void _EraseRootLayerEntries(Entries& entries, const SdfLayerHandle& rootLayer)
+{
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        UsdStagePtr stage = it->second.stage;
+        if (!stage || stage->GetRootLayer() == rootLayer)
+        {
+            it = entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+size_t UsdKatanaCache::FlushStage(const std::string& rootLayerIdentifier)
+{
+    SdfLayerHandle rootLayer = SdfLayer::Find(rootLayerIdentifier);
+    if (!rootLayer)
+    {
+        return 0;
+    }
+
+    const size_t numErased = UsdUtilsStageCache::Get().EraseAll(rootLayer);
+    _PruneMutedLayersStates();
+
+    {
+        std::lock_guard<std::mutex> lock(_materialLibraryStagesMutex);
+        for (auto it = _materialLibraryStages.begin(); it != _materialLibraryStages.end();)
+        {
+            if (it->second->GetRootLayer() == rootLayer)
+            {
+                it = _materialLibraryStages.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_prototypeMappingsMutex);
+        _EraseRootLayerEntries(_prototypeMappings, rootLayer);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_coordSysIndicesMutex);
+        _EraseRootLayerEntries(_coordSysIndices, rootLayer);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_globalListsIndicesMutex);
+        _EraseRootLayerEntries(_globalListsIndices, rootLayer);
+    }
+
+    UsdKatanaBoundsCache::GetInstance().ClearRootLayer(rootLayer);
+
+    TF_DEBUG(USDKATANA_CACHE_STAGE).Msg(
+            "{USD STAGE CACHE} Flushed %zu stage(s) for root layer @%s@\n",
+            numErased, rootLayer->GetIdentifier().c_str());
+
+    return numErased;
 }
 
 
@@ -789,11 +1459,11 @@ SdfLayerRefPtr UsdKatanaCache::FindSessionLayer(
 
 SdfLayerRefPtr UsdKatanaCache::FindSessionLayer(
     const std::string& cacheKey) {
-    boost::upgrade_lock<boost::upgrade_mutex>
+    boost::shared_lock<boost::upgrade_mutex>
                 readerLock(UsdKatanaGetSessionCacheLock());
-    const auto& it = _sessionKeyCache.find(cacheKey);
-    if (it != _sessionKeyCache.end()) {
-        return it->second;
+    _SessionLayerMap::const_accessor entryAccessor;
+    if (_sessionKeyCache.find(entryAccessor, cacheKey)) {
+        return entryAccessor->second.layer;
     }
     return NULL;
 }
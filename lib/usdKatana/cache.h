@@ -30,8 +30,11 @@
 #ifndef USDKATANA_CACHE_H
 #define USDKATANA_CACHE_H
 
-#include <map>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include <pxr/base/tf/singleton.h>
 #include <pxr/pxr.h>
@@ -40,6 +43,8 @@
 
 #include <FnAttribute/FnAttribute.h>
 
+#include <tbb/concurrent_hash_map.h>
+
 #include "usdKatana/api.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
@@ -50,6 +55,9 @@ SDF_DECLARE_HANDLES(SdfLayer);
 typedef TfRefPtr<class UsdStage> UsdStageRefPtr;
 class SdfPath;
 class UsdPrim;
+class UsdKatanaCoordSysIndex;
+class UsdKatanaGlobalListsIndex;
+class UsdKatanaPrototypeMappingCache;
 
 /*
  * Custom cache singleton class for katana. Hold the usd stage and renderer.
@@ -64,18 +72,109 @@ class UsdKatanaCache : public TfSingleton<UsdKatanaCache>
 
     /// Construct a session layer from the groupAttr encoding of variants
     /// and deactivations -- or return a previously created one
-    SdfLayerRefPtr& _FindOrCreateSessionLayer(FnAttribute::GroupAttribute sessionAttr,
-                                              const std::string& rootLocation,
-                                              const std::string& isolatePath = "");
+    SdfLayerRefPtr _FindOrCreateSessionLayer(FnAttribute::GroupAttribute sessionAttr,
+                                             const std::string& rootLocation,
+                                             const std::string& isolatePath = "");
+
+    /// Populate an empty \p sessionLayer from \p sessionAttr.
+    static void _FillSessionLayer(const SdfLayerRefPtr& sessionLayer,
+                                  FnAttribute::GroupAttribute sessionAttr,
+                                  const std::string& rootLocation,
+                                  const std::string& isolatePath);
 
     /// Mute layers by name
     static void _SetMutedLayers(
-        const UsdStageRefPtr &stage, const std::string &layerRegex);
+        const UsdStageRefPtr &stage, const std::string &layerRegex,
+        const SdfLayerHandleVector &stageLayers);
+
+    /// Mute layers by name, skipping the work if \p stage was already muted
+    /// with \p layerRegex and its used layers have not changed since.
+    void _ReconcileMutedLayers(const UsdStageRefPtr& stage, const std::string& layerRegex);
+
+    /// Forget the muting state of stages which no longer exist.
+    void _PruneMutedLayersStates();
 
     std::string _ComputeCacheKey(FnAttribute::GroupAttribute sessionAttr,
         const std::string& rootLocation);
 
-    std::map<std::string, SdfLayerRefPtr> _sessionKeyCache;
+    /// Evict least recently used session layers, and the stages opened
+    /// with them, until the cache is back within its limits. Layers still
+    /// held outside the cache, directly or by a stage opened with them, are
+    /// kept.
+    void _EvictSessionLayers();
+
+    struct _SessionLayerEntry
+    {
+        _SessionLayerEntry() = default;
+        _SessionLayerEntry(const _SessionLayerEntry& other)
+            : layer(other.layer), bytes(other.bytes), lastUse(other.lastUse.load())
+        {
+        }
+
+        SdfLayerRefPtr layer;
+        size_t bytes = 0;
+        // Updated by hits, which only hold a const accessor on the entry.
+        mutable std::atomic<size_t> lastUse{0};
+    };
+
+    typedef tbb::concurrent_hash_map<std::string, _SessionLayerEntry> _SessionLayerMap;
+    _SessionLayerMap _sessionKeyCache;
+
+    std::atomic<size_t> _sessionLayerBytes;
+    std::atomic<size_t> _useCounter;
+    std::atomic<size_t> _sessionLayerHits;
+    std::atomic<size_t> _sessionLayerMisses;
+    std::atomic<size_t> _sessionLayerEvictions;
+
+    std::atomic<size_t> _maxSessionLayers;
+    std::atomic<size_t> _maxSessionLayerBytes;
+
+    struct _MutedLayersState
+    {
+        UsdStagePtr stage;
+        std::string layerRegex;
+        size_t usedLayersHash = 0;
+    };
+
+    std::mutex _mutedLayersMutex;
+    std::unordered_map<const UsdStage*, _MutedLayersState> _mutedLayersStates;
+
+    /// Payload-free stages opened for material library lookups, one per
+    /// root layer identifier, masked to the materials looked up so far. Kept
+    /// apart from the UsdIn stages in the UsdUtilsStageCache as their
+    /// population masks differ.
+    mutable std::mutex _materialLibraryStagesMutex;
+    std::unordered_map<std::string, UsdStageRefPtr> _materialLibraryStages;
+
+    struct _PrototypeMappingEntry
+    {
+        UsdStagePtr stage;
+        std::shared_ptr<UsdKatanaPrototypeMappingCache> cache;
+    };
+
+    /// Instance prototype mappings memoized per stage.
+    std::mutex _prototypeMappingsMutex;
+    std::unordered_map<const UsdStage*, _PrototypeMappingEntry> _prototypeMappings;
+
+    struct _CoordSysIndexEntry
+    {
+        UsdStagePtr stage;
+        std::shared_ptr<UsdKatanaCoordSysIndex> index;
+    };
+
+    /// Model coordinate system indices, built once per stage.
+    std::mutex _coordSysIndicesMutex;
+    std::unordered_map<const UsdStage*, _CoordSysIndexEntry> _coordSysIndices;
+
+    struct _GlobalListsIndexEntry
+    {
+        UsdStagePtr stage;
+        std::shared_ptr<UsdKatanaGlobalListsIndex> index;
+    };
+
+    /// Camera and light list indices, kept per stage across cooks.
+    std::mutex _globalListsIndicesMutex;
+    std::unordered_map<const UsdStage*, _GlobalListsIndexEntry> _globalListsIndices;
 
 public:
 
@@ -83,9 +182,31 @@ public:
         return TfSingleton<UsdKatanaCache>::GetInstance();
     }
 
+    struct Stats
+    {
+        size_t stages = 0;
+        size_t sessionLayers = 0;
+        size_t sessionLayerBytes = 0;
+        size_t sessionLayerHits = 0;
+        size_t sessionLayerMisses = 0;
+        size_t sessionLayerEvictions = 0;
+        size_t maxSessionLayers = 0;
+        size_t maxSessionLayerBytes = 0;
+        size_t materialLibraryStages = 0;
+    };
+
     /// Clear all caches
     USDKATANA_API void Flush();
 
+    /// Return a snapshot of the cache sizes and session layer counters.
+    USDKATANA_API Stats GetStats() const;
+
+    /// Bound the number of cached session layers and their approximate
+    /// memory footprint. Zero means unlimited. Least recently used session
+    /// layers, and the cached stages opened with them, are evicted first;
+    /// layers still in use are not evicted.
+    USDKATANA_API void SetSessionLayerLimits(size_t maxCount, size_t maxBytes);
+
     /// Get (or create) a cached usd stage with a sessionLayer containing
     /// variant selections and activations (so far)
     USDKATANA_API UsdStageRefPtr GetStage(std::string const& fileName,
@@ -103,9 +224,55 @@ public:
                             std::string const& ignoreLayerRegex,
                             bool forcePopulate);
 
+    /// Get (or create) a cached stage for reading the library material at
+    /// \p materialPath from \p fileName. The stage is masked to the material
+    /// and the prims it depends on (connection sources, relationship targets
+    /// and base materials), and no payloads are loaded. An empty
+    /// \p materialPath populates the whole stage, still without payloads.
+    ///
+    /// Every material of \p fileName shares one stage, whose mask is widened
+    /// in place to include each material asked for. Hold a shared lock on
+    /// UsdKatanaGetMaterialLibraryStageLock() while reading the stage.
+    ///
+    /// These stages are cached separately from those returned by GetStage().
+    USDKATANA_API UsdStageRefPtr GetMaterialLibraryStage(const std::string& fileName,
+                                                         const SdfPath& materialPath);
+
+    /// Return the "as sources and instances" mapping from prototypes to
+    /// instance sources for the prims at and below \p rootPath. The
+    /// traversal of \p stage is shared by every query, so that asking for
+    /// the mapping of each payload in turn does not traverse the stage again.
+    ///
+    /// \sa UsdKatanaUtils::BuildInstancePrototypeMapping
+    USDKATANA_API FnAttribute::GroupAttribute GetInstancePrototypeMapping(
+        const UsdStageRefPtr& stage,
+        const SdfPath& rootPath);
+
+    /// Return the coordinate systems declared by the first model, in depth
+    /// first order, at or below \p modelPath that declares any, mapped to
+    /// their scenegraph locations under \p rootLocation. The models of \p stage are indexed on first use, so
+    /// that nested models do not traverse their descendants again.
+    ///
+    /// \sa UsdKatanaCoordSysIndex
+    USDKATANA_API FnAttribute::GroupAttribute GetModelCoordinateSystems(
+        const UsdStageRefPtr& stage,
+        const SdfPath& modelPath,
+        const std::string& rootLocation);
+
+    /// Return the camera and light list index of \p stage, creating it on
+    /// first use. The index is shared by every UsdIn using the stage, and is
+    /// kept until the stage expires or is flushed.
+    USDKATANA_API std::shared_ptr<UsdKatanaGlobalListsIndex> GetGlobalListsIndex(
+        const UsdStageRefPtr& stage);
+
     /// Flushes an individual stage if present in the cache
     USDKATANA_API void FlushStage(const UsdStageRefPtr & stage);
 
+    /// Flushes every cached stage whose root layer is \p rootLayerIdentifier,
+    /// leaving stages of other files untouched. Returns the number of stages
+    /// flushed.
+    USDKATANA_API size_t FlushStage(const std::string& rootLayerIdentifier);
+
     /// \brief Find a cached session layer if it exists.  Does NOT create.
     SdfLayerRefPtr FindSessionLayer(
         FnAttribute::GroupAttribute sessionAttr,
@@ -0,0 +1,167 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/coordSysIndex.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/usd/usd/primFlags.h>
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usdRi/statementsAPI.h>
+
+#include <FnAttribute/FnGroupBuilder.h>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+UsdKatanaCoordSysIndex::UsdKatanaCoordSysIndex(const UsdStageWeakPtr& stage)
+    : _stage(stage)
+{
+    _objectsChangedKey = TfNotice::Register(
+        TfCreateWeakPtr(this), &UsdKatanaCoordSysIndex::_OnObjectsChanged, stage);
+}
+
+UsdKatanaCoordSysIndex::~UsdKatanaCoordSysIndex()
+{
+    TfNotice::Revoke(_objectsChangedKey);
+}
+
+FnAttribute::GroupAttribute UsdKatanaCoordSysIndex::GetCoordinateSystems(
+    const SdfPath& modelPath,
+    const std::string& rootLocation)
+{
+    TRACE_FUNCTION();
+
+    const _EntriesConstPtr entries = _GetEntries();
+
+    // The entries of the models at and below modelPath are contiguous, as
+    // paths sort before their descendants.
+    auto it = std::lower_bound(
+        entries->begin(), entries->end(), modelPath,
+        [](const _Entry& entry, const SdfPath& path) { return entry.modelPath < path; });
+
+    // Only the first model declaring coordinate systems in traversal order
+    // is used; the walk of the model hierarchy stopped recursing there.
+    std::vector<const _Entry*> found;
+    for (; it != entries->end() && it->modelPath.HasPrefix(modelPath); ++it)
+    {
+        if (!found.empty() && it->traversalIndex > found.front()->traversalIndex)
+        {
+            continue;
+        }
+        if (!found.empty() && it->traversalIndex < found.front()->traversalIndex)
+        {
+            found.clear();
+        }
+        found.push_back(&*it);
+    }
+
+    FnAttribute::GroupBuilder gb;
+    for (const _Entry* entry : found)
+    {
+        gb.set(entry->coordSysName,
+               FnAttribute::StringAttribute(rootLocation + entry->coordSysPath.GetString()));
+    }
+    return gb.build();
+}
+
+UsdKatanaCoordSysIndex::_EntriesConstPtr UsdKatanaCoordSysIndex::_GetEntries()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_entries)
+    {
+        return _entries;
+    }
+
+    auto entries = std::make_shared<_Entries>();
+    UsdStageRefPtr stage = _stage;
+    if (stage)
+    {
+        TRACE_SCOPE("UsdKatanaCoordSysIndex build");
+
+        size_t traversalIndex = 0;
+        auto indexPrim = [&stage, &entries, &traversalIndex](const UsdPrim& prim) {
+            SdfPathVector coordSysPaths;
+            if (UsdRiStatementsAPI(prim).GetModelCoordinateSystems(&coordSysPaths))
+            {
+                for (const SdfPath& coordSysPath : coordSysPaths)
+                {
+                    if (UsdRiStatementsAPI coordSysStmt =
+                            UsdRiStatementsAPI(stage->GetPrimAtPath(coordSysPath)))
+                    {
+                        entries->push_back({prim.GetPath(), traversalIndex,
+                                            coordSysStmt.GetCoordinateSystem(), coordSysPath});
+                    }
+                }
+            }
+            ++traversalIndex;
+        };
+        // Coordinate systems are only looked up on models, and models only
+        // have model ancestors, so the model hierarchy is all there is to
+        // traverse.
+        auto indexModelsBelow = [&indexPrim](const UsdPrim& root) {
+            for (const UsdPrim& child : root.GetFilteredChildren(UsdPrimIsModel))
+            {
+                for (const UsdPrim& prim : UsdPrimRange(child, UsdPrimIsModel))
+                {
+                    indexPrim(prim);
+                }
+            }
+        };
+
+        indexModelsBelow(stage->GetPseudoRoot());
+
+        // UsdIn reads instanced models through the prims of their
+        // prototypes, so those are indexed as well.
+        for (const UsdPrim& prototype : stage->GetPrototypes())
+        {
+            indexPrim(prototype);
+            indexModelsBelow(prototype);
+        }
+
+        std::stable_sort(entries->begin(), entries->end(),
+                         [](const _Entry& lhs, const _Entry& rhs) {
+                             return lhs.modelPath < rhs.modelPath;
+                         });
+    }
+
+    _entries = entries;
+    return _entries;
+}
+
+void UsdKatanaCoordSysIndex::_OnObjectsChanged(const UsdNotice::ObjectsChanged& notice,
+                                               const UsdStageWeakPtr& sender)
+{
+    // Coordinate systems are declared by relationships and attributes, so
+    // info-only changes invalidate the index as well as resyncs.
+    if (notice.GetResyncedPaths().empty() && notice.GetChangedInfoOnlyPaths().empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entries.reset();
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,100 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_COORDSYSINDEX_H
+#define USDKATANA_COORDSYSINDEX_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pxr/pxr.h>
+#include <pxr/base/tf/notice.h>
+#include <pxr/base/tf/weakBase.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/notice.h>
+#include <pxr/usd/usd/stage.h>
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/// \brief Index of the coordinate systems declared by the models of a stage,
+/// via UsdRiStatementsAPI::GetModelCoordinateSystems().
+///
+/// The model hierarchy of the stage, and of its instance prototypes, is
+/// traversed once, and the models declaring coordinate systems are kept
+/// sorted by path, so that the coordinate systems of the first model at or
+/// below any model are found with a range query. The index is rebuilt on
+/// the next query after the stage changes.
+class UsdKatanaCoordSysIndex : public TfWeakBase
+{
+public:
+    USDKATANA_API explicit UsdKatanaCoordSysIndex(const UsdStageWeakPtr& stage);
+    USDKATANA_API ~UsdKatanaCoordSysIndex();
+
+    UsdKatanaCoordSysIndex(const UsdKatanaCoordSysIndex&) = delete;
+    UsdKatanaCoordSysIndex& operator=(const UsdKatanaCoordSysIndex&) = delete;
+
+    /// \brief Return, as a group attribute, a map from the names of the
+    ///        coordinate systems declared at or below \p modelPath to their
+    ///        scenegraph locations under \p rootLocation.
+    ///
+    /// Only the coordinate systems of the first model declaring any, in
+    /// depth first traversal order of the models at and below
+    /// \p modelPath, are returned.
+    USDKATANA_API FnAttribute::GroupAttribute GetCoordinateSystems(
+        const SdfPath& modelPath,
+        const std::string& rootLocation);
+
+private:
+    struct _Entry
+    {
+        SdfPath modelPath;
+        // Position of the model in depth first traversal order.
+        size_t traversalIndex;
+        std::string coordSysName;
+        SdfPath coordSysPath;
+    };
+    /// Entries sorted by model path, in traversal order for each model.
+    typedef std::vector<_Entry> _Entries;
+    typedef std::shared_ptr<const _Entries> _EntriesConstPtr;
+
+    _EntriesConstPtr _GetEntries();
+
+    void _OnObjectsChanged(const UsdNotice::ObjectsChanged& notice,
+                           const UsdStageWeakPtr& sender);
+
+    UsdStageWeakPtr _stage;
+    TfNotice::Key _objectsChangedKey;
+
+    std::mutex _mutex;
+    // Null until the first query, and after any change to the stage.
+    _EntriesConstPtr _entries;
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_COORDSYSINDEX_H
@@ -0,0 +1,190 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/globalListsIndex.h"
+
+#include <set>
+#include <utility>
+
+#include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/work/loops.h>
+#include <pxr/usd/usd/prim.h>
+
+#include "usdKatana/utils.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+UsdKatanaGlobalListsIndex::UsdKatanaGlobalListsIndex(const UsdStageWeakPtr& stage)
+    : _stage(stage)
+{
+    _objectsChangedKey = TfNotice::Register(
+        TfCreateWeakPtr(this), &UsdKatanaGlobalListsIndex::_OnObjectsChanged, stage);
+}
+
+UsdKatanaGlobalListsIndex::~UsdKatanaGlobalListsIndex()
+{
+    TfNotice::Revoke(_objectsChangedKey);
+}
+
+SdfPathVector UsdKatanaGlobalListsIndex::GetCameraPaths(const SdfPath& scope)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    SdfPathVector result;
+    for (const _Subtree* subtree : _UpdateSubtrees(scope))
+    {
+        for (const SdfPath& path : subtree->cameraPaths)
+        {
+            if (path.HasPrefix(scope))
+            {
+                result.push_back(path);
+            }
+        }
+    }
+    return result;
+}
+
+SdfPathVector UsdKatanaGlobalListsIndex::GetLightPaths(const SdfPath& scope)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // A light may be published by the light list cache of more than one
+    // subtree; keep the first occurrence, as a single traversal would.
+    SdfPathVector result;
+    std::set<SdfPath, SdfPath::FastLessThan> seen;
+    for (const _Subtree* subtree : _UpdateSubtrees(scope))
+    {
+        for (const SdfPath& path : subtree->lightPaths)
+        {
+            if (path.HasPrefix(scope) && seen.insert(path).second)
+            {
+                result.push_back(path);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<const UsdKatanaGlobalListsIndex::_Subtree*> UsdKatanaGlobalListsIndex::_UpdateSubtrees(
+    const SdfPath& scope)
+{
+    TRACE_FUNCTION();
+
+    std::vector<const _Subtree*> result;
+    UsdStageRefPtr stage = _stage;
+    if (!stage || !scope.IsAbsolutePath())
+    {
+        return result;
+    }
+
+    // Only the top-level prim containing the scope can contribute to it.
+    std::vector<UsdPrim> prims;
+    if (scope.IsAbsoluteRootPath())
+    {
+        for (const UsdPrim& prim : stage->GetPseudoRoot().GetChildren())
+        {
+            prims.push_back(prim);
+        }
+    }
+    else
+    {
+        const UsdPrim prim = stage->GetPrimAtPath(scope.GetPrefixes().front());
+        if (prim && UsdPrimDefaultPredicate(prim))
+        {
+            prims.push_back(prim);
+        }
+    }
+
+    std::vector<std::pair<UsdPrim, _Subtree*>> toTraverse;
+    result.reserve(prims.size());
+    for (const UsdPrim& prim : prims)
+    {
+        auto inserted = _subtrees.emplace(prim.GetName(), _Subtree());
+        if (inserted.second)
+        {
+            toTraverse.emplace_back(prim, &inserted.first->second);
+        }
+        result.push_back(&inserted.first->second);
+    }
+
+    WorkParallelForN(toTraverse.size(), [&toTraverse](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const UsdPrim& prim = toTraverse[i].first;
+            _Subtree* subtree = toTraverse[i].second;
+            UsdKatanaUtils::FindCameraPaths(prim, &subtree->cameraPaths);
+            UsdKatanaUtils::FindLightPaths(prim, &subtree->lightPaths);
+        }
+    });
+
+    return result;
+}
+
+void UsdKatanaGlobalListsIndex::_OnObjectsChanged(const UsdNotice::ObjectsChanged& notice,
+                                                  const UsdStageWeakPtr& sender)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_subtrees.empty())
+    {
+        return;
+    }
+
+    // Returns false once the whole index has been dropped.
+    auto invalidate = [this](const SdfPath& path) {
+        const SdfPath primPath = path.GetPrimPath();
+        if (primPath.IsEmpty() || primPath.IsAbsoluteRootPath())
+        {
+            _subtrees.clear();
+            return false;
+        }
+        _subtrees.erase(primPath.GetPrefixes().front().GetNameToken());
+        return true;
+    };
+
+    for (const SdfPath& path : notice.GetResyncedPaths())
+    {
+        if (!invalidate(path))
+        {
+            return;
+        }
+    }
+
+    // Of the non-structural changes, only model kinds and light list caches
+    // affect what the traversals find.
+    static const std::string lightListPrefix("lightList");
+    for (const SdfPath& path : notice.GetChangedInfoOnlyPaths())
+    {
+        if (path.IsPropertyPath() &&
+            !TfStringStartsWith(path.GetName(), lightListPrefix))
+        {
+            continue;
+        }
+        if (!invalidate(path))
+        {
+            return;
+        }
+    }
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,96 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_GLOBALLISTSINDEX_H
+#define USDKATANA_GLOBALLISTSINDEX_H
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <pxr/pxr.h>
+#include <pxr/base/tf/notice.h>
+#include <pxr/base/tf/token.h>
+#include <pxr/base/tf/weakBase.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/notice.h>
+#include <pxr/usd/usd/stage.h>
+
+#include "usdKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/// \brief Per-stage index of the cameras and lights published for Katana's
+/// global camera and light lists.
+///
+/// The index is kept per top-level prim of the stage, so that only the
+/// subtrees touched by an edit (e.g. a variant selection in the session
+/// layer) are traversed again. Subtrees are traversed in parallel, and
+/// queries restricted to an isolate path only traverse the subtree which
+/// contains it.
+///
+/// \sa UsdKatanaCache::GetGlobalListsIndex
+class UsdKatanaGlobalListsIndex : public TfWeakBase
+{
+public:
+    USDKATANA_API explicit UsdKatanaGlobalListsIndex(const UsdStageWeakPtr& stage);
+    USDKATANA_API ~UsdKatanaGlobalListsIndex();
+
+    UsdKatanaGlobalListsIndex(const UsdKatanaGlobalListsIndex&) = delete;
+    UsdKatanaGlobalListsIndex& operator=(const UsdKatanaGlobalListsIndex&) = delete;
+
+    /// \brief Return the cameras at or below \p scope, as found by
+    ///        UsdKatanaUtils::FindCameraPaths().
+    USDKATANA_API SdfPathVector GetCameraPaths(
+        const SdfPath& scope = SdfPath::AbsoluteRootPath());
+
+    /// \brief Return the lights at or below \p scope, in the order found by
+    ///        UsdKatanaUtils::FindLightPaths().
+    USDKATANA_API SdfPathVector GetLightPaths(
+        const SdfPath& scope = SdfPath::AbsoluteRootPath());
+
+private:
+    struct _Subtree
+    {
+        SdfPathVector cameraPaths;
+        SdfPathVector lightPaths;
+    };
+
+    /// Return the top-level prims relevant to \p scope, traversing those
+    /// which are not indexed yet. Must be called with _mutex held.
+    std::vector<const _Subtree*> _UpdateSubtrees(const SdfPath& scope);
+
+    void _OnObjectsChanged(const UsdNotice::ObjectsChanged& notice,
+                           const UsdStageWeakPtr& sender);
+
+    UsdStageWeakPtr _stage;
+    TfNotice::Key _objectsChangedKey;
+
+    std::mutex _mutex;
+    // Top-level prim name -> indexed subtree. Entries are erased when their
+    // subtree changes, and rebuilt on the next query.
+    std::unordered_map<TfToken, _Subtree, TfToken::HashFunctor> _subtrees;
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_GLOBALLISTSINDEX_H
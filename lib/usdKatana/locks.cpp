@@ -56,6 +56,13 @@ boost::upgrade_mutex& UsdKatanaGetSessionCacheLock()
     return _rwLock;
 }
 
+boost::upgrade_mutex& UsdKatanaGetMaterialLibraryStageLock()
+{
+    // Static accessor method prevents C++ static initialization sadness.
+    static boost::upgrade_mutex _rwLock;
+    return _rwLock;
+}
+
 
 PXR_NAMESPACE_CLOSE_SCOPE
 
@@ -43,6 +43,7 @@ PXR_NAMESPACE_OPEN_SCOPE
 USDKATANA_API boost::upgrade_mutex& UsdKatanaGetStageLock();
 boost::upgrade_mutex& UsdKatanaGetRendererCacheLock();
 boost::upgrade_mutex& UsdKatanaGetSessionCacheLock();
+USDKATANA_API boost::upgrade_mutex& UsdKatanaGetMaterialLibraryStageLock();
 
 
 PXR_NAMESPACE_CLOSE_SCOPE
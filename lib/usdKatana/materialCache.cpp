@@ -0,0 +1,563 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/materialCache.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/base/tf/instantiateSingleton.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/primRange.h>
+#include <pxr/usd/usdShade/material.h>
+
+#include <FnAttribute/FnAttribute.h>
+#include <FnAttribute/FnGroupBuilder.h>
+#include <pystring/pystring.h>
+
+#include "usdKatana/usdInPrivateData.h"
+#include "usdKatana/utils.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+TF_INSTANTIATE_SINGLETON(UsdKatanaMaterialCache);
+
+TF_DEFINE_ENV_SETTING(USD_KATANA_MATERIAL_CACHE_MAX_MB,
+                      512,
+                      "Approximate memory budget, in megabytes, of the converted material cache "
+                      "shared by UsdInCore_LookOp. Set to 0 to disable caching.");
+
+namespace
+{
+
+// Approximate number of bytes held by the given attribute. Only meant to be
+// proportionate, not exact.
+size_t _EstimateAttrBytes(const FnAttribute::Attribute& attr)
+{
+    // Rough per-attribute overhead of the underlying attribute and its name.
+    static const size_t kAttrOverhead = 64;
+
+    switch (attr.getType())
+    {
+    case kFnKatAttributeTypeGroup:
+    {
+        FnAttribute::GroupAttribute groupAttr(attr);
+        size_t bytes = kAttrOverhead;
+        const int64_t numChildren = groupAttr.getNumberOfChildren();
+        for (int64_t i = 0; i < numChildren; ++i)
+        {
+            bytes += _EstimateAttrBytes(groupAttr.getChildByIndex(i));
+        }
+        return bytes;
+    }
+    case kFnKatAttributeTypeInt:
+    case kFnKatAttributeTypeFloat:
+    case kFnKatAttributeTypeDouble:
+    {
+        FnAttribute::DataAttribute dataAttr(attr);
+        const size_t valueSize = attr.getType() == kFnKatAttributeTypeDouble ? 8 : 4;
+        return kAttrOverhead + valueSize * dataAttr.getNumberOfValues() *
+                                   std::max<int64_t>(1, dataAttr.getNumberOfTimeSamples());
+    }
+    case kFnKatAttributeTypeString:
+    {
+        FnAttribute::StringAttribute stringAttr(attr);
+        size_t bytes = kAttrOverhead;
+        const int64_t numSamples = std::max<int64_t>(1, stringAttr.getNumberOfTimeSamples());
+        FnAttribute::StringConstVector values = stringAttr.getNearestSample(0.0f);
+        for (const char* value : values)
+        {
+            bytes += sizeof(char*) + (value ? std::char_traits<char>::length(value) + 1 : 0);
+        }
+        return bytes * numSamples;
+    }
+    default:
+        return kAttrOverhead;
+    }
+}
+
+// Append "<layer>:<specPath>" for every spec contributing to \p prim.
+void _AppendPrimStack(const UsdPrim& prim, std::vector<std::string>& stack)
+{
+    for (const SdfPrimSpecHandle& spec : prim.GetPrimStack())
+    {
+        if (spec)
+        {
+            stack.push_back(spec->GetLayer()->GetIdentifier() + ":" +
+                            spec->GetPath().GetString());
+        }
+    }
+}
+
+// Hash the prim stacks of everything the conversion of \p prim may read: the
+// material subtree, prims reached through connections or relationship
+// targets from it and, when flattening, its base materials. The paths of
+// those prims are returned in \p visited, along with the prototype paths of
+// instance proxies among them.
+std::string _ComputeDependencyHash(const UsdPrim& prim, bool flatten, SdfPathSet& visited)
+{
+    const UsdStageRefPtr stage = prim.GetStage();
+
+    std::vector<std::string> primStack;
+    std::vector<UsdPrim> roots{prim};
+    while (!roots.empty())
+    {
+        const UsdPrim root = roots.back();
+        roots.pop_back();
+        if (!visited.insert(root.GetPath()).second)
+        {
+            continue;
+        }
+
+        for (const UsdPrim& curr : UsdPrimRange(root))
+        {
+            if (curr != root && !visited.insert(curr.GetPath()).second)
+            {
+                continue;
+            }
+            if (curr.IsInstanceProxy())
+            {
+                visited.insert(curr.GetPrimInPrototype().GetPath());
+            }
+            _AppendPrimStack(curr, primStack);
+
+            SdfPathVector targets;
+            for (const UsdAttribute& attr : curr.GetAttributes())
+            {
+                attr.GetConnections(&targets);
+                for (const SdfPath& target : targets)
+                {
+                    if (UsdPrim targetPrim = stage->GetPrimAtPath(target.GetPrimPath()))
+                    {
+                        roots.push_back(targetPrim);
+                    }
+                }
+            }
+            for (const UsdRelationship& rel : curr.GetRelationships())
+            {
+                rel.GetForwardedTargets(&targets);
+                for (const SdfPath& target : targets)
+                {
+                    if (UsdPrim targetPrim = stage->GetPrimAtPath(target.GetPrimPath()))
+                    {
+                        roots.push_back(targetPrim);
+                    }
+                }
+            }
+        }
+
+        if (flatten)
+        {
+            if (UsdShadeMaterial baseMaterial = UsdShadeMaterial(root).GetBaseMaterial())
+            {
+                roots.push_back(baseMaterial.GetPrim());
+            }
+        }
+    }
+
+    return FnAttribute::StringAttribute(primStack).getHash().str();
+}
+
+// Whether a change reported at \p changedPath may affect a conversion which
+// read the prims at \p dependencies.
+bool _IsAffectedBy(const SdfPathSet& dependencies, const SdfPath& changedPath, bool resynced)
+{
+    const SdfPath primPath = changedPath.GetPrimPath();
+    if (dependencies.count(primPath))
+    {
+        return true;
+    }
+    if (!resynced)
+    {
+        return false;
+    }
+
+    // A resync also adds or removes the prims below primPath, including new
+    // children of a dependency.
+    if (dependencies.count(primPath.GetParentPath()))
+    {
+        return true;
+    }
+    const auto prefixed =
+        SdfPathFindPrefixedRange(dependencies.begin(), dependencies.end(), primPath);
+    return prefixed.first != prefixed.second;
+}
+
+}  // namespace
+
+UsdKatanaMaterialCache::UsdKatanaMaterialCache()
+    : _maxBytes(static_cast<size_t>(std::max(0, TfGetEnvSetting(USD_KATANA_MATERIAL_CACHE_MAX_MB))) *
+                1024 * 1024),
+      _hits(0),
+      _misses(0),
+      _evictions(0)
+{
+    _objectsChangedKey = TfNotice::Register(TfCreateWeakPtr(this),
+                                            &UsdKatanaMaterialCache::_OnObjectsChanged);
+    _layersDidChangeKey = TfNotice::Register(TfCreateWeakPtr(this),
+                                             &UsdKatanaMaterialCache::_OnLayersDidChange);
+}
+
+UsdKatanaMaterialCache::~UsdKatanaMaterialCache()
+{
+    TfNotice::Revoke(_objectsChangedKey);
+    TfNotice::Revoke(_layersDidChangeKey);
+}
+
+std::string UsdKatanaMaterialCache::ComputeKey(const UsdShadeMaterial& material,
+                                               bool flatten,
+                                               const UsdKatanaUsdInPrivateData& data,
+                                               const std::string& looksGroupLocation,
+                                               const std::string& materialDestinationLocation,
+                                               const FnAttribute::Attribute& looksCacheKeyPrefixAttr)
+{
+    const UsdPrim prim = material.GetPrim();
+    const UsdStageRefPtr stage = prim.GetStage();
+    const SdfPath primPath =
+        prim.IsInstanceProxy() ? prim.GetPrimInPrototype().GetPath() : prim.GetPath();
+    const std::string dependencyKey = primPath.GetString() + (flatten ? ":1" : ":0");
+
+    auto getStageKeys = [this, &stage]() -> _StageKeys& {
+        _StageKeys& stageKeys = _stageKeys[get_pointer(stage)];
+        if (stageKeys.stage != stage)
+        {
+            // A new stage, possibly at the address of one which has expired.
+            stageKeys = _StageKeys();
+            stageKeys.stage = stage;
+        }
+        return stageKeys;
+    };
+
+    size_t generation = 0;
+    std::string dependencyHash;
+    {
+        std::lock_guard<std::mutex> lock(_stageKeysMutex);
+        _StageKeys& stageKeys = getStageKeys();
+        generation = stageKeys.generations[dependencyKey];
+        auto materialIt = stageKeys.materials.find(dependencyKey);
+        if (materialIt != stageKeys.materials.end())
+        {
+            dependencyHash = materialIt->second.dependencyHash;
+        }
+    }
+
+    if (dependencyHash.empty())
+    {
+        SdfPathSet dependencies;
+        dependencyHash = _ComputeDependencyHash(prim, flatten, dependencies);
+
+        std::lock_guard<std::mutex> lock(_stageKeysMutex);
+        _StageKeys& stageKeys = getStageKeys();
+        if (stageKeys.generations[dependencyKey] == generation)
+        {
+            _MaterialKeys& materialKeys = stageKeys.materials[dependencyKey];
+            materialKeys.dependencyHash = dependencyHash;
+            materialKeys.dependencies = std::move(dependencies);
+        }
+    }
+
+    // Remember the key, so that its entry can be dropped along with the
+    // material.
+    auto registerKey = [&](const std::string& key) {
+        std::lock_guard<std::mutex> lock(_stageKeysMutex);
+        _StageKeys& stageKeys = getStageKeys();
+        auto materialIt = stageKeys.materials.find(dependencyKey);
+        if (materialIt != stageKeys.materials.end() &&
+            stageKeys.generations[dependencyKey] == generation)
+        {
+            materialIt->second.keys.insert(key);
+        }
+        return key;
+    };
+
+    // Materials of a Looks scope with an explicit sharedLooksCacheKey share
+    // their entries across stages until edited.
+    if (looksCacheKeyPrefixAttr.isValid())
+    {
+        return registerKey(
+            FnAttribute::GroupAttribute(
+                "a", looksCacheKeyPrefixAttr, "b", FnAttribute::StringAttribute(prim.GetName()),
+                "generation", FnAttribute::IntAttribute(static_cast<int>(generation)), true)
+                .getHash()
+                .str());
+    }
+
+    // Mirror the relative Katana path computed by UsdKatanaReadMaterial.
+    const UsdKatanaUsdInArgsRefPtr usdInArgs = data.GetUsdInArgs();
+    const std::string& parentPrefix =
+        looksGroupLocation.empty() ? usdInArgs->GetRootLocationPath() : looksGroupLocation;
+    std::string katanaPath = prim.GetName();
+    const std::string fullKatanaPath =
+        !materialDestinationLocation.empty()
+            ? materialDestinationLocation
+            : UsdKatanaUtils::ConvertUsdMaterialPathToKatLocation(prim.GetPath(), data);
+    if (!fullKatanaPath.empty() && pystring::startswith(fullKatanaPath, parentPrefix))
+    {
+        katanaPath = fullKatanaPath.substr(parentPrefix.size());
+    }
+
+    const std::set<std::string>& outputTargets = usdInArgs->GetOutputTargets();
+
+    return registerKey(FnAttribute::GroupBuilder()
+        .set("path", FnAttribute::StringAttribute(primPath.GetString()))
+        .set("stage", FnAttribute::StringAttribute(stage->GetRootLayer()->GetIdentifier()))
+        .set("stageSession",
+             FnAttribute::StringAttribute(stage->GetSessionLayer()
+                                              ? stage->GetSessionLayer()->GetIdentifier()
+                                              : std::string()))
+        .set("generation", FnAttribute::IntAttribute(static_cast<int>(generation)))
+        .set("session", usdInArgs->GetSessionAttr())
+        .set("dependencies", FnAttribute::StringAttribute(dependencyHash))
+        .set("time", FnAttribute::DoubleAttribute(data.GetCurrentTime()))
+        .set("outputTargets", FnAttribute::StringAttribute(std::vector<std::string>(
+                                  outputTargets.begin(), outputTargets.end())))
+        .set("flatten", FnAttribute::IntAttribute(flatten))
+        .set("katanaPath", FnAttribute::StringAttribute(katanaPath))
+        .build()
+        .getHash()
+        .str());
+}
+
+UsdKatanaMaterialCache::_Shard& UsdKatanaMaterialCache::_GetShard(const std::string& key)
+{
+    return _shards[std::hash<std::string>()(key) % _NumShards];
+}
+
+UsdKatanaMaterialCache::UsdKatanaAttrMapRefPtr UsdKatanaMaterialCache::Get(const std::string& key)
+{
+    _Shard& shard = _GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto indexIt = shard.index.find(key);
+    if (indexIt == shard.index.end())
+    {
+        ++_misses;
+        return UsdKatanaAttrMapRefPtr();
+    }
+
+    ++_hits;
+    shard.entries.splice(shard.entries.end(), shard.entries, indexIt->second);
+    return indexIt->second->value;
+}
+
+void UsdKatanaMaterialCache::Insert(const std::string& key,
+                                    UsdKatanaAttrMapRefPtr value,
+                                    const UsdStageWeakPtr& stage)
+{
+    if (!IsEnabled() || !value)
+    {
+        return;
+    }
+
+    // Measure outside of the lock; build() returns the cached group once the
+    // map has been built.
+    const size_t bytes = key.size() + _EstimateAttrBytes(value->build());
+    const size_t maxShardBytes = _maxBytes / _NumShards;
+
+    _Shard& shard = _GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto indexIt = shard.index.find(key);
+    if (indexIt != shard.index.end())
+    {
+        // Replace in place if it's already there.
+        _Entry& entry = *indexIt->second;
+        shard.bytes = shard.bytes - entry.bytes + bytes;
+        entry.value = value;
+        entry.bytes = bytes;
+        entry.stage = stage;
+        shard.entries.splice(shard.entries.end(), shard.entries, indexIt->second);
+    }
+    else
+    {
+        shard.index[key] = shard.entries.insert(shard.entries.end(), _Entry{key, value, bytes, stage});
+        shard.bytes += bytes;
+    }
+
+    // Evict from the front, always keeping the entry just inserted.
+    while (shard.bytes > maxShardBytes && shard.entries.size() > 1)
+    {
+        const _Entry& oldest = shard.entries.front();
+        shard.bytes -= oldest.bytes;
+        shard.index.erase(oldest.key);
+        shard.entries.pop_front();
+        ++_evictions;
+    }
+}
+
+void UsdKatanaMaterialCache::Clear()
+{
+    for (_Shard& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.entries.clear();
+        shard.bytes = 0;
+    }
+
+    // Generations are kept so that keys computed before clearing are not
+    // handed out again.
+    std::lock_guard<std::mutex> lock(_stageKeysMutex);
+    for (auto& stageKeys : _stageKeys)
+    {
+        stageKeys.second.materials.clear();
+    }
+}
+
+template <typename Predicate>
+void UsdKatanaMaterialCache::_EraseEntries(const Predicate& predicate)
+{
+    for (_Shard& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto entryIt = shard.entries.begin(); entryIt != shard.entries.end();)
+        {
+            if (predicate(*entryIt))
+            {
+                shard.bytes -= entryIt->bytes;
+                shard.index.erase(entryIt->key);
+                entryIt = shard.entries.erase(entryIt);
+            }
+            else
+            {
+                ++entryIt;
+            }
+        }
+    }
+}
+
+void UsdKatanaMaterialCache::_EraseKeys(const std::vector<std::string>& keys)
+{
+    for (const std::string& key : keys)
+    {
+        _Shard& shard = _GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto indexIt = shard.index.find(key);
+        if (indexIt != shard.index.end())
+        {
+            shard.bytes -= indexIt->second->bytes;
+            shard.entries.erase(indexIt->second);
+            shard.index.erase(indexIt);
+        }
+    }
+}
+
+void UsdKatanaMaterialCache::_OnObjectsChanged(const UsdNotice::ObjectsChanged& notice)
+{
+    // Prim stacks don't change with values, so any change to a prim a
+    // material depends on invalidates both its dependency hash and the
+    // entries built from it. Other materials of the stage are kept.
+    const UsdStage* stage = get_pointer(notice.GetStage());
+    std::vector<std::string> staleKeys;
+    {
+        std::lock_guard<std::mutex> lock(_stageKeysMutex);
+        auto stageKeysIt = _stageKeys.find(stage);
+        if (stageKeysIt == _stageKeys.end())
+        {
+            return;
+        }
+
+        _StageKeys& stageKeys = stageKeysIt->second;
+        for (auto materialIt = stageKeys.materials.begin();
+             materialIt != stageKeys.materials.end();)
+        {
+            const SdfPathSet& dependencies = materialIt->second.dependencies;
+            bool affected = false;
+            for (const SdfPath& path : notice.GetResyncedPaths())
+            {
+                if (_IsAffectedBy(dependencies, path, /* resynced */ true))
+                {
+                    affected = true;
+                    break;
+                }
+            }
+            if (!affected)
+            {
+                for (const SdfPath& path : notice.GetChangedInfoOnlyPaths())
+                {
+                    if (_IsAffectedBy(dependencies, path, /* resynced */ false))
+                    {
+                        affected = true;
+                        break;
+                    }
+                }
+            }
+
+            if (affected)
+            {
+                staleKeys.insert(staleKeys.end(), materialIt->second.keys.begin(),
+                                 materialIt->second.keys.end());
+                ++stageKeys.generations[materialIt->first];
+                materialIt = stageKeys.materials.erase(materialIt);
+            }
+            else
+            {
+                ++materialIt;
+            }
+        }
+    }
+
+    _EraseKeys(staleKeys);
+}
+
+void UsdKatanaMaterialCache::_OnLayersDidChange(const SdfNotice::LayersDidChange& notice)
+{
+    // Open stages are told about changes to their layers through
+    // ObjectsChanged. Entries of stages which have been closed since can't
+    // be, so drop them instead.
+    {
+        std::lock_guard<std::mutex> lock(_stageKeysMutex);
+        for (auto stageKeysIt = _stageKeys.begin(); stageKeysIt != _stageKeys.end();)
+        {
+            if (stageKeysIt->second.stage.IsExpired())
+            {
+                stageKeysIt = _stageKeys.erase(stageKeysIt);
+            }
+            else
+            {
+                ++stageKeysIt;
+            }
+        }
+    }
+
+    _EraseEntries([](const _Entry& entry) { return entry.stage.IsExpired(); });
+}
+
+UsdKatanaMaterialCache::Stats UsdKatanaMaterialCache::GetStats() const
+{
+    Stats stats;
+    stats.hits = _hits;
+    stats.misses = _misses;
+    stats.evictions = _evictions;
+    stats.maxBytes = _maxBytes;
+    for (const _Shard& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.entries += shard.entries.size();
+        stats.bytes += shard.bytes;
+    }
+    return stats;
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
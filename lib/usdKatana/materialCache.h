@@ -0,0 +1,204 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_MATERIALCACHE_H
+#define USDKATANA_MATERIALCACHE_H
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <pxr/base/tf/notice.h>
+#include <pxr/base/tf/singleton.h>
+#include <pxr/base/tf/weakBase.h>
+#include <pxr/pxr.h>
+#include <pxr/usd/sdf/notice.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/notice.h>
+#include <pxr/usd/usd/stage.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/api.h"
+#include "usdKatana/attrMap.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+class UsdKatanaUsdInPrivateData;
+class UsdShadeMaterial;
+
+/// \brief Process-wide cache of converted materials, shared across cooks.
+///
+/// Materials are keyed by their path and what their conversion depends on
+/// (see ComputeKey), so a material read through several Looks scopes is only
+/// converted once. Materials under a scope with an explicit
+/// sharedLooksCacheKey are keyed by it instead, so they can be shared across
+/// stages.
+///
+/// When a stage reports a change, only the entries of the materials whose
+/// dependencies it touches are dropped. Entries from stages which have since
+/// been closed are dropped on the next layer change.
+///
+/// The cache is split into independently locked shards, each holding an LRU
+/// list bounded by its share of an approximate memory budget. The budget is
+/// taken from USD_KATANA_MATERIAL_CACHE_MAX_MB; a budget of zero disables
+/// caching.
+class UsdKatanaMaterialCache : public TfSingleton<UsdKatanaMaterialCache>, public TfWeakBase
+{
+    friend class TfSingleton<UsdKatanaMaterialCache>;
+
+    UsdKatanaMaterialCache();
+    ~UsdKatanaMaterialCache();
+
+public:
+    typedef boost::shared_ptr<UsdKatanaAttrMap> UsdKatanaAttrMapRefPtr;
+
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+        size_t maxBytes = 0;
+    };
+
+    USDKATANA_API static UsdKatanaMaterialCache& GetInstance()
+    {
+        return TfSingleton<UsdKatanaMaterialCache>::GetInstance();
+    }
+
+    /// \brief Compute the cache key for \p material as read by
+    ///        UsdKatanaReadMaterial with the same arguments.
+    ///
+    /// If \p looksCacheKeyPrefixAttr is valid, the key combines it with the
+    /// material name. Otherwise, the key hashes the material path (its
+    /// prototype path for instance proxies), the prim stacks of the material,
+    /// its descendants, the prims their connections reach and (when
+    /// flattening) its base materials, together with the session attributes,
+    /// time, output targets and the Katana path the material is published at.
+    /// The prim stacks are only gathered once per material until a change to
+    /// the stage touches one of those prims.
+    USDKATANA_API std::string ComputeKey(const UsdShadeMaterial& material,
+                                         bool flatten,
+                                         const UsdKatanaUsdInPrivateData& data,
+                                         const std::string& looksGroupLocation,
+                                         const std::string& materialDestinationLocation,
+                                         const FnAttribute::Attribute& looksCacheKeyPrefixAttr);
+
+    /// \brief Return the cached entry for \p key, or null on a miss.
+    USDKATANA_API UsdKatanaAttrMapRefPtr Get(const std::string& key);
+
+    /// \brief Insert (or replace) the \p value built from \p stage for
+    ///        \p key, evicting least recently used entries of the same shard
+    ///        as needed.
+    USDKATANA_API void Insert(const std::string& key,
+                              UsdKatanaAttrMapRefPtr value,
+                              const UsdStageWeakPtr& stage);
+
+    /// \brief Return false if caching has been disabled.
+    bool IsEnabled() const { return _maxBytes > 0; }
+
+    /// \brief Drop every entry. Counters are left untouched.
+    USDKATANA_API void Clear();
+
+    /// \brief Return a snapshot of the cache counters.
+    USDKATANA_API Stats GetStats() const;
+
+private:
+    struct _Entry
+    {
+        std::string key;
+        UsdKatanaAttrMapRefPtr value;
+        size_t bytes;
+        UsdStageWeakPtr stage;
+    };
+
+    typedef std::list<_Entry> _EntryList;
+
+    struct _Shard
+    {
+        mutable std::mutex mutex;
+        _EntryList entries;
+        std::unordered_map<std::string, _EntryList::iterator> index;
+        size_t bytes = 0;
+    };
+
+    // What the conversion of one material depends on, and the keys computed
+    // from it.
+    struct _MaterialKeys
+    {
+        std::string dependencyHash;
+        // The prims read by the conversion; see _ComputeDependencyHash.
+        SdfPathSet dependencies;
+        std::set<std::string> keys;
+    };
+
+    // The materials of one stage, by path and flattening.
+    struct _StageKeys
+    {
+        UsdStageWeakPtr stage;
+        std::unordered_map<std::string, _MaterialKeys> materials;
+        // Bumped each time a material is invalidated, so that keys computed
+        // before a change are not handed out again.
+        std::unordered_map<std::string, size_t> generations;
+    };
+
+    static constexpr size_t _NumShards = 16;
+
+    _Shard& _GetShard(const std::string& key);
+
+    // Drop the entries for which \p predicate returns true.
+    template <typename Predicate>
+    void _EraseEntries(const Predicate& predicate);
+
+    // Drop the entries of \p keys.
+    void _EraseKeys(const std::vector<std::string>& keys);
+
+    void _OnObjectsChanged(const UsdNotice::ObjectsChanged& notice);
+    void _OnLayersDidChange(const SdfNotice::LayersDidChange& notice);
+
+    _Shard _shards[_NumShards];
+    size_t _maxBytes;
+
+    std::atomic<size_t> _hits;
+    std::atomic<size_t> _misses;
+    std::atomic<size_t> _evictions;
+
+    std::mutex _stageKeysMutex;
+    std::unordered_map<const UsdStage*, _StageKeys> _stageKeys;
+
+    TfNotice::Key _objectsChangedKey;
+    TfNotice::Key _layersDidChangeKey;
+};
+
+USDKATANA_API_TEMPLATE_CLASS(TfSingleton<UsdKatanaMaterialCache>);
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_MATERIALCACHE_H
@@ -37,5 +37,6 @@ TF_WRAP_MODULE
     TF_WRAP(UsdKatanaBlindDataObject);
     TF_WRAP(UsdKatanaCache);
     TF_WRAP(UsdKatanaKatanaLightAPI);
+    TF_WRAP(UsdKatanaMaterialCache);
     TF_WRAP(UsdKatanaChildMaterialAPI);
 }
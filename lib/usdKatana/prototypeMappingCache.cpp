@@ -0,0 +1,404 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/prototypeMappingCache.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+
+#include <pxr/pxr.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/base/work/loops.h>
+#include <pxr/usd/usd/modelAPI.h>
+#include <pxr/usd/usd/primFlags.h>
+#include <pxr/usd/usd/variantSets.h>
+
+#include <FnAttribute/FnGroupBuilder.h>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace
+{
+// Children are traversed in parallel down to this depth; below it the
+// subtrees are usually too small to be worth the scheduling overhead.
+const size_t _maxParallelDepth = 8;
+
+// Name the instance source of a prototype after the asset name and the
+// variant selections of (the first) one of its instances.
+std::string _ComputePrototypeKey(const UsdPrim& instance)
+{
+    std::string assetName;
+    UsdModelAPI(instance).GetAssetName(&assetName);
+    if (assetName.empty())
+    {
+        assetName = "prototype";
+    }
+
+    std::ostringstream buffer;
+    buffer << assetName << "/variants";
+
+    UsdVariantSets variantSets = instance.GetVariantSets();
+
+    std::vector<std::string> names;
+    variantSets.GetNames(&names);
+    TF_FOR_ALL(I, names)
+    {
+        const std::string & variantName = (*I);
+        std::string variantValue =
+                variantSets.GetVariantSet(
+                        variantName).GetVariantSelection();
+        buffer << "__" << variantName << "_" << variantValue;
+    }
+
+    return buffer.str();
+}
+}  // namespace
+
+UsdKatanaPrototypeMappingCache::UsdKatanaPrototypeMappingCache(const UsdStageWeakPtr& stage)
+    : _stage(stage)
+{
+    _objectsChangedKey = TfNotice::Register(
+        TfCreateWeakPtr(this), &UsdKatanaPrototypeMappingCache::_OnObjectsChanged, stage);
+}
+
+UsdKatanaPrototypeMappingCache::~UsdKatanaPrototypeMappingCache()
+{
+    TfNotice::Revoke(_objectsChangedKey);
+}
+
+FnAttribute::GroupAttribute UsdKatanaPrototypeMappingCache::GetMapping(const SdfPath& rootPath)
+{
+    TRACE_FUNCTION();
+
+    UsdStageRefPtr stage = _stage;
+    const UsdPrim rootPrim = stage ? stage->GetPrimAtPath(rootPath) : UsdPrim();
+    if (!rootPrim)
+    {
+        return FnAttribute::GroupBuilder().build();
+    }
+
+    _Instances rootInstances;
+    if (rootPrim.IsInPrototype() || rootPrim.IsInstanceProxy())
+    {
+        // Prototypes are not part of any segment.
+        _CollectItems(rootPrim, 0, &rootInstances);
+    }
+    else
+    {
+        // Answer from the segment rootPath belongs to.
+        UsdPrim segmentRoot = rootPrim;
+        while (!_IsSegmentRoot(segmentRoot))
+        {
+            segmentRoot = segmentRoot.GetParent();
+        }
+        _AppendInstances(*_GetSegment(segmentRoot), rootPath, &rootInstances);
+    }
+
+    // Traverse the prototypes found, and the prototypes they instance in
+    // turn, a wave at a time so that each wave is traversed in parallel.
+    std::unordered_map<SdfPath, _InstancesConstPtr, SdfPath::Hash> prototypeInstances;
+    std::vector<SdfPath> wave;
+    auto enqueue = [&prototypeInstances, &wave](const _Instances& instances) {
+        for (const _Instance& instance : instances)
+        {
+            if (prototypeInstances.emplace(instance.prototypePath, nullptr).second)
+            {
+                wave.push_back(instance.prototypePath);
+            }
+        }
+    };
+    enqueue(rootInstances);
+    while (!wave.empty())
+    {
+        std::vector<SdfPath> prototypePaths;
+        prototypePaths.swap(wave);
+        std::vector<_InstancesConstPtr> results(prototypePaths.size());
+        WorkParallelForN(prototypePaths.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                results[i] = _GetPrototypeInstances(prototypePaths[i]);
+            }
+        });
+        for (size_t i = 0; i < prototypePaths.size(); ++i)
+        {
+            prototypeInstances[prototypePaths[i]] = results[i];
+            enqueue(*results[i]);
+        }
+    }
+
+    // Name the prototypes in depth first traversal order, where the
+    // instances of a prototype are visited right after its first instance.
+    // A container that respects insertion order is needed; USD is not
+    // deterministic when generating the /__Prototype prims given the same
+    // stage, so their paths cannot be used to order the instance sources.
+    std::unordered_set<SdfPath, SdfPath::Hash> namedPrototypes;
+    std::map<std::string, std::vector<std::string>> keyToPrototypes;
+    std::function<void(const _Instances&)> namePrototypes = [&](const _Instances& instances) {
+        for (const _Instance& instance : instances)
+        {
+            if (!namedPrototypes.insert(instance.prototypePath).second)
+            {
+                continue;
+            }
+            const std::string key =
+                _ComputePrototypeKey(stage->GetPrimAtPath(instance.instancePath));
+            keyToPrototypes[key].push_back(instance.prototypePath.GetString());
+            // TODO, Warn when there are multiple prototypes with the
+            //      same key.
+            namePrototypes(*prototypeInstances[instance.prototypePath]);
+        }
+    };
+    namePrototypes(rootInstances);
+
+    FnAttribute::GroupBuilder gb;
+    for (const auto& keyAndPrototypes : keyToPrototypes)
+    {
+        const std::string& key = keyAndPrototypes.first;
+        const std::vector<std::string>& prototypes = keyAndPrototypes.second;
+        for (size_t i = 0; i < prototypes.size(); ++i)
+        {
+            std::ostringstream buffer;
+            buffer << key << "/m" << i;
+            gb.set(FnAttribute::DelimiterEncode(prototypes[i]),
+                   FnAttribute::StringAttribute(buffer.str()));
+        }
+    }
+    return gb.build();
+}
+
+/* static */
+bool UsdKatanaPrototypeMappingCache::_IsSegmentRoot(const UsdPrim& prim)
+{
+    // Payloads are the unit in which UsdIn loads, and so queries, the stage.
+    // Prims inside prototypes are not part of any segment, as the prototypes
+    // themselves may be regenerated.
+    return prim.IsPseudoRoot() ||
+           (prim.HasAuthoredPayloads() && !prim.IsInPrototype() && !prim.IsInstanceProxy());
+}
+
+UsdKatanaPrototypeMappingCache::_SegmentConstPtr UsdKatanaPrototypeMappingCache::_GetSegment(
+    const UsdPrim& root)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _segments.find(root.GetPath());
+        if (it != _segments.end())
+        {
+            return it->second;
+        }
+    }
+
+    auto segment = std::make_shared<_Segment>();
+    segment->rootPath = root.GetPath();
+    _CollectItems(root, 0, &segment->items);
+    segment->itemsByPath.reserve(segment->items.size());
+    for (size_t i = 0; i < segment->items.size(); ++i)
+    {
+        segment->itemsByPath.emplace_back(segment->items[i].instancePath, i);
+    }
+    std::sort(segment->itemsByPath.begin(), segment->itemsByPath.end());
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _segments.emplace(root.GetPath(), segment).first->second;
+}
+
+void UsdKatanaPrototypeMappingCache::_CollectItems(const UsdPrim& prim,
+                                                   size_t depth,
+                                                   _Instances* items)
+{
+    if (prim.IsInstance())
+    {
+        const UsdPrim prototype = prim.GetPrototype();
+        if (prototype.IsValid())
+        {
+            items->push_back({prototype.GetPath(), prim.GetPath()});
+        }
+    }
+
+    // Nested payload prims are listed, and their own segments built, in
+    // place of their subtrees.
+    auto collectChild = [this, depth](const UsdPrim& child, _Instances* childItems) {
+        if (_IsSegmentRoot(child))
+        {
+            childItems->push_back({SdfPath(), child.GetPath()});
+            _GetSegment(child);
+        }
+        else
+        {
+            _CollectItems(child, depth + 1, childItems);
+        }
+    };
+
+    const auto children =
+        prim.GetFilteredChildren(UsdPrimIsDefined && UsdPrimIsActive && !UsdPrimIsAbstract);
+    if (depth < _maxParallelDepth && children.begin() != children.end() &&
+        std::next(children.begin()) != children.end())
+    {
+        const std::vector<UsdPrim> childPrims(children.begin(), children.end());
+        std::vector<_Instances> childItems(childPrims.size());
+        WorkParallelForN(childPrims.size(), [&](size_t childBegin, size_t childEnd) {
+            for (size_t i = childBegin; i < childEnd; ++i)
+            {
+                collectChild(childPrims[i], &childItems[i]);
+            }
+        });
+        for (const _Instances& child : childItems)
+        {
+            items->insert(items->end(), child.begin(), child.end());
+        }
+    }
+    else
+    {
+        for (const UsdPrim& child : children)
+        {
+            collectChild(child, items);
+        }
+    }
+}
+
+void UsdKatanaPrototypeMappingCache::_AppendInstances(const _Segment& segment,
+                                                      const SdfPath& rootPath,
+                                                      _Instances* instances)
+{
+    // A subtree is visited in one go by a depth first traversal, so its items
+    // are a contiguous range of the segment.
+    size_t begin = 0;
+    size_t end = segment.items.size();
+    if (rootPath != segment.rootPath)
+    {
+        begin = end;
+        end = 0;
+        for (auto it = std::lower_bound(segment.itemsByPath.begin(), segment.itemsByPath.end(),
+                                        std::make_pair(rootPath, size_t(0)));
+             it != segment.itemsByPath.end() && it->first.HasPrefix(rootPath); ++it)
+        {
+            begin = std::min(begin, it->second);
+            end = std::max(end, it->second + 1);
+        }
+    }
+
+    UsdStageRefPtr stage = _stage;
+    for (size_t i = begin; i < end; ++i)
+    {
+        const _Instance& item = segment.items[i];
+        if (!item.prototypePath.IsEmpty())
+        {
+            instances->push_back(item);
+        }
+        else if (const UsdPrim payloadPrim = stage->GetPrimAtPath(item.instancePath))
+        {
+            _AppendInstances(*_GetSegment(payloadPrim), item.instancePath, instances);
+        }
+    }
+}
+
+UsdKatanaPrototypeMappingCache::_InstancesConstPtr
+UsdKatanaPrototypeMappingCache::_GetPrototypeInstances(const SdfPath& prototypePath)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _prototypeInstances.find(prototypePath);
+        if (it != _prototypeInstances.end())
+        {
+            return it->second;
+        }
+    }
+
+    auto instances = std::make_shared<_Instances>();
+    UsdStageRefPtr stage = _stage;
+    if (const UsdPrim prototype = stage ? stage->GetPrimAtPath(prototypePath) : UsdPrim())
+    {
+        _CollectItems(prototype, 0, instances.get());
+
+        // Only the first instance of each prototype matters, drop the others
+        // to keep the memoized lists down to the number of distinct
+        // prototypes.
+        std::unordered_set<SdfPath, SdfPath::Hash> seen;
+        instances->erase(std::remove_if(instances->begin(), instances->end(),
+                                        [&seen](const _Instance& instance) {
+                                            return !seen.insert(instance.prototypePath).second;
+                                        }),
+                         instances->end());
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _prototypeInstances[prototypePath] = instances;
+    return instances;
+}
+
+void UsdKatanaPrototypeMappingCache::_OnObjectsChanged(const UsdNotice::ObjectsChanged& notice,
+                                                       const UsdStageWeakPtr& sender)
+{
+    const auto resyncedPaths = notice.GetResyncedPaths();
+    if (resyncedPaths.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Any resync may regenerate prototypes.
+    _prototypeInstances.clear();
+
+    for (const SdfPath& resyncedPath : resyncedPaths)
+    {
+        if (!resyncedPath.IsAbsoluteRootOrPrimPath())
+        {
+            continue;
+        }
+
+        // The segments of payloads at or below the resynced prim are stale.
+        const bool isSegmentRoot = _segments.count(resyncedPath) != 0;
+        for (auto it = _segments.begin(); it != _segments.end();)
+        {
+            if (it->first.HasPrefix(resyncedPath))
+            {
+                it = _segments.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        // So is the segment listing the resynced prim, unless the prim is a
+        // segment root: its segment is listed as a whole, wherever it is.
+        if (!isSegmentRoot)
+        {
+            for (SdfPath path = resyncedPath.GetParentPath(); !path.IsEmpty();
+                 path = path.GetParentPath())
+            {
+                if (_segments.erase(path))
+                {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,119 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_PROTOTYPEMAPPINGCACHE_H
+#define USDKATANA_PROTOTYPEMAPPINGCACHE_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <pxr/pxr.h>
+#include <pxr/base/tf/notice.h>
+#include <pxr/base/tf/weakBase.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usd/notice.h>
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/stage.h>
+
+#include <FnAttribute/FnAttribute.h>
+
+#include "usdKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/// \brief Builds the instance to prototype mapping used by the "as sources
+/// and instances" instance mode, for any subtree of a stage.
+///
+/// The stage is traversed once, split into segments: one for the prims
+/// outside of any payload, and one for each payload prim, each listing the
+/// instances (and nested payload prims) below it in depth first order. The
+/// mapping of any subtree is then assembled from the range of a segment
+/// below the subtree root, and the segments it nests, without traversing the
+/// stage again. Segments are dropped when the stage resyncs them, e.g. when a
+/// payload is loaded, and are traversed in parallel.
+class UsdKatanaPrototypeMappingCache : public TfWeakBase
+{
+public:
+    USDKATANA_API explicit UsdKatanaPrototypeMappingCache(const UsdStageWeakPtr& stage);
+    USDKATANA_API ~UsdKatanaPrototypeMappingCache();
+
+    UsdKatanaPrototypeMappingCache(const UsdKatanaPrototypeMappingCache&) = delete;
+    UsdKatanaPrototypeMappingCache& operator=(const UsdKatanaPrototypeMappingCache&) = delete;
+
+    /// \brief Return, as a group attribute, a map from prototypes to their
+    ///        instance source names for the prims at and below \p rootPath.
+    USDKATANA_API FnAttribute::GroupAttribute GetMapping(const SdfPath& rootPath);
+
+private:
+    /// An instance found during traversal. The instance is kept, rather than
+    /// the key it contributes, as only the first instance of each prototype
+    /// names it.
+    struct _Instance
+    {
+        SdfPath prototypePath;
+        SdfPath instancePath;
+    };
+    /// Instances in traversal order.
+    typedef std::vector<_Instance> _Instances;
+    typedef std::shared_ptr<const _Instances> _InstancesConstPtr;
+
+    /// The instances at and below a segment root, the pseudo-root or a
+    /// payload prim, in traversal order. Nested payload prims are listed in
+    /// place of the instances below them, with an empty prototype path.
+    struct _Segment
+    {
+        SdfPath rootPath;
+        _Instances items;
+        /// (path, index in items) for every item, sorted by path, so that
+        /// the items of a subtree can be found without a scan.
+        std::vector<std::pair<SdfPath, size_t>> itemsByPath;
+    };
+    typedef std::shared_ptr<const _Segment> _SegmentConstPtr;
+
+    static bool _IsSegmentRoot(const UsdPrim& prim);
+
+    _SegmentConstPtr _GetSegment(const UsdPrim& root);
+    void _CollectItems(const UsdPrim& prim, size_t depth, _Instances* items);
+    void _AppendInstances(const _Segment& segment, const SdfPath& rootPath, _Instances* instances);
+    _InstancesConstPtr _GetPrototypeInstances(const SdfPath& prototypePath);
+
+    void _OnObjectsChanged(const UsdNotice::ObjectsChanged& notice,
+                           const UsdStageWeakPtr& sender);
+
+    UsdStageWeakPtr _stage;
+    TfNotice::Key _objectsChangedKey;
+
+    std::mutex _mutex;
+    // Segment root path -> segment.
+    std::unordered_map<SdfPath, _SegmentConstPtr, SdfPath::Hash> _segments;
+    // Prototype path -> instances below it, keeping the first one of each
+    // prototype.
+    std::unordered_map<SdfPath, _InstancesConstPtr, SdfPath::Hash> _prototypeInstances;
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_PROTOTYPEMAPPINGCACHE_H
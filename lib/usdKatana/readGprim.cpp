@@ -27,10 +27,13 @@
 // KIND, either express or implied. See the Apache License for the specific
 // language governing permissions and limitations under the Apache License.
 //
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 #include <pxr/base/gf/gamma.h>
 #include <pxr/pxr.h>
+#include <pxr/usd/usd/attributeQuery.h>
 #include <pxr/usd/usdGeom/curves.h>
 #include <pxr/usd/usdGeom/gprim.h>
 #include <pxr/usd/usdGeom/pointBased.h>
@@ -116,6 +119,91 @@ Foundry::Katana::Attribute UsdKatanaGeomGetWindingOrderAttr(const UsdGeomGprim&
 
 namespace {
 
+// Reads the motion samples of \p usdAttr, ordered by Katana sample time, into
+// \p times and \p values. Returns false if the topology varies across the
+// samples, in which case only the sample at the current time is returned.
+template <typename T_USD>
+bool _ReadGeomSamples(const UsdAttribute& usdAttr,
+                      const UsdKatanaUsdInPrivateData& data,
+                      std::vector<float>* times,
+                      std::vector<VtArray<T_USD>>* values)
+{
+    const double currentTime = data.GetCurrentTime();
+    const std::vector<double> motionSampleTimes = data.GetMotionSampleTimes(usdAttr);
+    const bool isMotionBackward = data.IsMotionBackward();
+
+    // Order the samples up front, so that they can be converted without
+    // going through an intermediate map. Only the first of several samples
+    // at the same Katana time is kept.
+    std::vector<std::pair<float, double>> sampleTimes;
+    sampleTimes.reserve(motionSampleTimes.size());
+    for (double relSampleTime : motionSampleTimes)
+    {
+        const float correctedSampleTime =
+            isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(relSampleTime) : relSampleTime;
+        sampleTimes.emplace_back(correctedSampleTime, relSampleTime);
+    }
+    std::stable_sort(sampleTimes.begin(), sampleTimes.end(),
+                     [](const std::pair<float, double>& a, const std::pair<float, double>& b) {
+                         return a.first < b.first;
+                     });
+    sampleTimes.erase(
+        std::unique(sampleTimes.begin(), sampleTimes.end(),
+                    [](const std::pair<float, double>& a, const std::pair<float, double>& b) {
+                        return a.first == b.first;
+                    }),
+        sampleTimes.end());
+
+    // An attribute that cannot vary over time holds the same value at every
+    // sample time, so it only needs to be read once; the samples then share
+    // the same array.
+    const UsdAttributeQuery query(usdAttr);
+    const bool readOnce = sampleTimes.size() > 1 && !query.ValueMightBeTimeVarying();
+
+    times->reserve(sampleTimes.size());
+    values->reserve(sampleTimes.size());
+    for (const auto& sampleTime : sampleTimes)
+    {
+        VtArray<T_USD> attrArray;
+        if (readOnce && !values->empty())
+        {
+            attrArray = values->front();
+        }
+        else
+        {
+            query.Get(&attrArray, currentTime + sampleTime.second);
+        }
+
+        if (!values->empty() && values->front().size() != attrArray.size())
+        {
+            // Topology has changed. Keep the current frame only, reusing its
+            // sample if it has already been read.
+            VtArray<T_USD> currentArray;
+            bool foundCurrent = false;
+            for (size_t i = 0; i < values->size(); ++i)
+            {
+                if (sampleTimes[i].second == 0.0)
+                {
+                    currentArray = (*values)[i];
+                    foundCurrent = true;
+                    break;
+                }
+            }
+            if (!foundCurrent)
+            {
+                query.Get(&currentArray, currentTime);
+            }
+            times->assign(1, 0.0f);
+            values->assign(1, currentArray);
+            return false;
+        }
+
+        times->push_back(sampleTime.first);
+        values->push_back(attrArray);
+    }
+    return true;
+}
+
 #if KATANA_VERSION_MAJOR >= 3
 
 template <typename T_USD, typename T_ATTR>
@@ -128,43 +216,14 @@ FnKat::Attribute _ConvertGeomAttr(const UsdAttribute& usdAttr,
         return FnKat::Attribute();
     }
 
-    const double currentTime = data.GetCurrentTime();
-    const std::vector<double>& motionSampleTimes = data.GetMotionSampleTimes(usdAttr);
-
-    // Flag to check if we discovered the topology is varying, in
-    // which case we only output the sample at the curent frame.
-    bool varyingTopology = false;
-
-    const bool isMotionBackward = data.IsMotionBackward();
-
-    std::map<float, VtArray<T_USD>> timeToSampleMap;
-    for (double relSampleTime : motionSampleTimes) {
-        double time = currentTime + relSampleTime;
-
-        // Eval attr.
-        VtArray<T_USD> attrArray;
-        usdAttr.Get(&attrArray, time);
-
-        if (!timeToSampleMap.empty()) {
-            if (timeToSampleMap.begin()->second.size() != attrArray.size()) {
-                timeToSampleMap.clear();
-                varyingTopology = true;
-                break;
-            }
-        }
-        float correctedSampleTime =
-            isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(relSampleTime) : relSampleTime;
-        timeToSampleMap.insert({correctedSampleTime, attrArray});
-    }
-
-    // Varying topology was found, build for the current frame only.
-    if (varyingTopology) {
-        VtArray<T_USD> attrArray;
-        usdAttr.Get(&attrArray, currentTime);
-        return VtKatanaMapOrCopy<T_USD>(attrArray);
-    } else {
-        return VtKatanaMapOrCopy<T_USD>(timeToSampleMap);
+    std::vector<float> times;
+    std::vector<VtArray<T_USD>> values;
+    if (!_ReadGeomSamples(usdAttr, data, &times, &values))
+    {
+        // Varying topology was found, build for the current frame only.
+        return VtKatanaMapOrCopy<T_USD>(values.front());
     }
+    return VtKatanaMapOrCopy<T_USD>(times, values);
 }
 
 #else
@@ -179,55 +238,16 @@ FnKat::Attribute _ConvertGeomAttr(const UsdAttribute& usdAttr,
         return FnKat::Attribute();
     }
 
-    const double currentTime = data.GetCurrentTime();
-    const std::vector<double>& motionSampleTimes = data.GetMotionSampleTimes(usdAttr);
-
-    // Flag to check if we discovered the topology is varying, in
-    // which case we only output the sample at the curent frame.
-    bool varyingTopology = false;
-
-    // Used to compare value sizes to identify varying topology.
-    int arraySize = -1;
-
-    const bool isMotionBackward = data.IsMotionBackward();
+    std::vector<float> times;
+    std::vector<VtArray<T_USD>> values;
+    _ReadGeomSamples(usdAttr, data, &times, &values);
 
     FnKat::DataBuilder<T_ATTR> attrBuilder(tupleSize);
-    TF_FOR_ALL(iter, motionSampleTimes)
+    for (size_t i = 0; i < times.size(); ++i)
     {
-        double relSampleTime = *iter;
-        double time = currentTime + relSampleTime;
-
-        // Eval attr.
-        VtArray<T_USD> attrArray;
-        usdAttr.Get(&attrArray, time);
-
-        if (arraySize == -1) {
-            arraySize = attrArray.size();
-        } else if ( attrArray.size() != static_cast<size_t>(arraySize) ) {
-            // Topology has changed. Don't create this or subsequent samples.
-            varyingTopology = true;
-            break;
-        }
-
-        std::vector<typename T_ATTR::value_type>& attrVec = attrBuilder.get(
-            isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(relSampleTime) : relSampleTime);
-
-        UsdKatanaUtils::ConvertArrayToVector(attrArray, &attrVec);
-    }
-
-    // Varying topology was found, build for the current frame only.
-    if (varyingTopology)
-    {
-        FnKat::DataBuilder<T_ATTR> defaultBuilder(tupleSize);
-        VtArray<T_USD> attrArray;
-
-        usdAttr.Get(&attrArray, currentTime);
-        std::vector<typename T_ATTR::value_type> &attrVec = defaultBuilder.get(0);
-        UsdKatanaUtils::ConvertArrayToVector(attrArray, &attrVec);
-
-        return defaultBuilder.build();
+        std::vector<typename T_ATTR::value_type>& attrVec = attrBuilder.get(times[i]);
+        UsdKatanaUtils::ConvertArrayToVector(values[i], &attrVec);
     }
-
     return attrBuilder.build();
 }
 
@@ -35,6 +35,7 @@
 #include <stack>
 #include <tuple>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 #include <pxr/pxr.h>
@@ -72,11 +73,22 @@ FnLogSetup("UsdKatanaReadMaterial");
 
 namespace
 {
+// State shared by every node created while translating one shading network.
+struct ShadingNetworkContext
+{
+    // Handles of the nodes written to material.nodes, and of the shading
+    // groups written to material.layout, so that each node is only created
+    // once.
+    std::unordered_set<std::string> visitedNodes;
+    std::unordered_set<std::string> visitedGroups;
+};
+
 struct ShadingNodeTraversalData
 {
     std::string target{};
     bool targetOverwritten{false};
     bool isMaterial{false};
+    ShadingNetworkContext* network{nullptr};
 };
 
 std::unordered_map<std::string, std::vector<std::string>> s_shaderIdToRenderTarget;
@@ -828,31 +840,33 @@ std::string _CreateShadingNode(UsdPrim shadingNode,
         return "";
     }
 
+    if (!TF_VERIFY(traversalData.network))
+    {
+        return "";
+    }
+    ShadingNetworkContext& network = *traversalData.network;
+
+    // Check if we know about this node already, and if so, just return and
+    // don't create anything. Marking the node as visited before recursing
+    // also prevents infinite recursion.
     const UsdShadeNodeGraph shadingGroup = UsdShadeNodeGraph(shadingNode);
     const UsdShadeMaterial materialPrim = UsdShadeMaterial(shadingNode);
     if (shadingGroup && !materialPrim)
     {
-        // Check if we know about this node already
-        const FnKat::GroupAttribute curLayout = layoutBuilder.build(layoutBuilder.BuildAndRetain);
-        if (curLayout.getChildByName(handle).isValid())
+        if (!network.visitedGroups.insert(handle).second)
         {
-            // If so, just return and don't create anything
             return handle;
         }
-        // Create an empty group at the handle to prevent infinite recursion
+        // Create an empty group at the handle to keep the node order
         layoutBuilder.set(handle, FnKat::GroupBuilder().build());
     }
     else
     {
-        // Check if we know about this node already
-        const FnKat::GroupAttribute curNodes = nodesBuilder.build(nodesBuilder.BuildAndRetain);
-        if (curNodes.getChildByName(handle).isValid())
+        if (!network.visitedNodes.insert(handle).second)
         {
-            // If so, just return and don't create anything
             return handle;
         }
-
-        // Create an empty group at the handle to prevent infinite recursion
+        // Create an empty group at the handle to keep the node order
         nodesBuilder.set(handle, FnKat::GroupBuilder().build());
     }
 
@@ -1033,14 +1047,17 @@ _CreateEnclosingNetworkMaterialLayout(
     FnKat::GroupBuilder& nodesBuilder,
     FnKat::GroupBuilder& interfaceBuilder,
     FnKat::GroupBuilder& layoutBuilder,
+    ShadingNetworkContext& network,
     const std::string & targetName,
     bool flatten)
 {
-    ShadingNodeTraversalData data{targetName};
+    ShadingNodeTraversalData data{targetName, false, false, &network};
     std::string handle = _CreateShadingNode(
         materialPrim, currentTime, nodesBuilder, interfaceBuilder, layoutBuilder, data, flatten);
 
     // Remove from material.nodes, as there is no accompanying shading node.
+    // The handle stays visited, so that connections to the material's
+    // outputs don't add it back.
     nodesBuilder.del(handle);
 
     // We must put the layout attributes are at material.layout.<primname>, else
@@ -1077,12 +1094,13 @@ FnKat::Attribute _GetMaterialAttr(const UsdShadeMaterial& materialSchema,
     FnKat::GroupBuilder interfaceBuilder;
     FnKat::GroupBuilder layoutBuilder;
     FnKat::GroupBuilder terminalsBuilder;
+    ShadingNetworkContext network;
 
     /////////////////
     // RSL SECTION
     /////////////////
 
-    ShadingNodeTraversalData prmanData{"prman"};
+    ShadingNodeTraversalData prmanData{"prman", false, false, &network};
     // look for surface
     UsdShadeShader surfaceShader = riMaterialAPI.GetSurface(/*ignoreBaseMaterial*/ !flatten);
     if (surfaceShader.GetPrim()) {
@@ -1239,11 +1257,11 @@ FnKat::Attribute _GetMaterialAttr(const UsdShadeMaterial& materialSchema,
 
     _CreateEnclosingNetworkMaterialLayout(
         materialPrim, currentTime, nodesBuilder, interfaceBuilder,
-        layoutBuilder, targetName, flatten);
+        layoutBuilder, network, targetName, flatten);
 
     std::stack<UsdPrim> dfs;
     dfs.push(materialPrim);
-    ShadingNodeTraversalData traversalData{targetName};
+    ShadingNodeTraversalData traversalData{targetName, false, false, &network};
     while (!dfs.empty()) {
         UsdPrim curr = dfs.top();
         dfs.pop();
@@ -62,22 +62,15 @@ _GetPolyAttr(const UsdGeomMesh &mesh, double time)
     mesh.GetFaceVertexIndicesAttr().Get(&vertsArray, time);
     mesh.GetFaceVertexCountsAttr().Get(&numVertsArray, time);
     
-    // Convert to vectors.
-    std::vector<int> vertsVec(vertsArray.begin(), vertsArray.end());
-    std::vector<int> numVertsVec(numVertsArray.begin(), numVertsArray.end());
-    std::vector<int> startVertsVec;
-    UsdKatanaUtils::ConvertNumVertsToStartVerts(numVertsVec, &startVertsVec);
+    // Compute startIndex straight into its own array, then hand both arrays
+    // to Katana without the intermediate std::vector copies.
+    VtIntArray startVertsArray;
+    UsdKatanaUtils::ConvertNumVertsToStartVerts(numVertsArray, &startVertsArray);
 
     // Build Katana attribute.
     FnKat::GroupBuilder polyBuilder;
-    {
-        FnKat::IntBuilder vertsBuilder(/* tupleSize = */ 1);
-        FnKat::IntBuilder startVertsBuilder(/* tupleSize = */ 1);
-        vertsBuilder.set(vertsVec);
-        startVertsBuilder.set(startVertsVec);
-        polyBuilder.set("vertexList", vertsBuilder.build());
-        polyBuilder.set("startIndex", startVertsBuilder.build());
-    }
+    polyBuilder.set("vertexList", VtKatanaMapOrCopy(vertsArray));
+    polyBuilder.set("startIndex", VtKatanaMapOrCopy(startVertsArray));
     return polyBuilder.build();
 }
 
@@ -33,7 +33,6 @@
 #include <pxr/usd/usd/modelAPI.h>
 #include <pxr/usd/usd/variantSets.h>
 #include <pxr/usd/usdGeom/xform.h>
-#include <pxr/usd/usdRi/statementsAPI.h>
 #include <pxr/usd/usdUtils/pipeline.h>
 
 #include <FnLogging/FnLogging.h>
@@ -47,53 +46,6 @@ PXR_NAMESPACE_OPEN_SCOPE
 
 FnLogSetup("UsdKatanaReadModel");
 
-/*
- * Traverse the model hierarchy to build up a list of all named
- * coordinate systems and their scenegraph locations.
- *
- * XXX:
- * We plan to work with KatanaProcedural development in order to emit these
- * at the model root level.
- */
-static bool
-_BuildGlobalCoordinateSystems(
-    const UsdPrim& prim, 
-    const std::string& rootLocation,
-    FnKat::GroupBuilder *coordSysBuilder)
-{
-    bool result = false;
-
-    if (prim.GetPath() != SdfPath::AbsoluteRootPath())
-    {
-        UsdRiStatementsAPI riStatements(prim);
-        SdfPathVector coordSysPaths;
-        if (riStatements.GetModelCoordinateSystems(&coordSysPaths)
-            && !coordSysPaths.empty())
-        {
-            TF_FOR_ALL(itr, coordSysPaths)
-            {
-                if (UsdRiStatementsAPI coordSysStmt =
-                        UsdRiStatementsAPI(prim.GetStage()->GetPrimAtPath(*itr)))
-                {
-                    coordSysBuilder->set(
-                        coordSysStmt.GetCoordinateSystem(),
-                        FnKat::StringAttribute(rootLocation + itr->GetString()));
-
-                    result = true;
-                }
-            }
-        }
-    }
-
-    TF_FOR_ALL(itr, prim.GetFilteredChildren(UsdPrimIsModel))
-    {
-        result = result || _BuildGlobalCoordinateSystems(
-            *itr, rootLocation, coordSysBuilder);
-    }
-
-    return result;
-}
-
 void UsdKatanaReadModel(const UsdPrim& prim,
                         const UsdKatanaUsdInPrivateData& data,
                         UsdKatanaAttrMap& attrs)
@@ -104,12 +56,18 @@ void UsdKatanaReadModel(const UsdPrim& prim,
     // Set the 'globals.coordinateSystems' attribute.
     //
 
-    FnKat::GroupBuilder coordSysBuilder;
-    if (_BuildGlobalCoordinateSystems(
-            prim, data.GetUsdInArgs()->GetRootLocationPath(), &coordSysBuilder))
+    // The coordinate systems of the whole model hierarchy are indexed once
+    // per stage, rather than walking the subtree of every nested model.
+    //
+    // XXX:
+    // We plan to work with KatanaProcedural development in order to emit these
+    // at the model root level.
+    FnKat::GroupAttribute coordSysAttr = UsdKatanaCache::GetInstance().GetModelCoordinateSystems(
+        prim.GetStage(), prim.GetPath(), data.GetUsdInArgs()->GetRootLocationPath());
+    if (coordSysAttr.getNumberOfChildren() > 0)
     {
         FnKat::GroupBuilder globalsBuilder;
-        globalsBuilder.set("coordinateSystems", coordSysBuilder.build());
+        globalsBuilder.set("coordinateSystems", coordSysAttr);
         attrs.set("globals", globalsBuilder.build());
     }
 
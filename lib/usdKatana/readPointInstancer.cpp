@@ -29,8 +29,13 @@
 //
 #include "usdKatana/readPointInstancer.h"
 
+#include <algorithm>
+
 #include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/range3d.h>
 #include <pxr/base/gf/transform.h>
+#include <pxr/base/work/loops.h>
+#include <pxr/base/work/reduce.h>
 #include <pxr/usd/kind/registry.h>
 #include <pxr/usd/usd/modelAPI.h>
 #include <pxr/usd/usdGeom/pointInstancer.h>
@@ -83,6 +88,31 @@ namespace
                   FnKat::StringAttribute("[WARNING UsdKatanaReadPointInstancer]: " + message));
     }
 
+    // Transform the axis-aligned \p range by the affine matrix \p matrix and
+    // return the aligned range of the result. This is the same method (Arvo,
+    // Graphics Gems I) used by GfBBox3d::ComputeAlignedRange, without having
+    // to construct a GfBBox3d for every instance.
+    //
+    inline GfRange3d _TransformAlignedRange(const GfRange3d& range, const GfMatrix4d& matrix)
+    {
+        const GfVec3d& rangeMin = range.GetMin();
+        const GfVec3d& rangeMax = range.GetMax();
+
+        GfVec3d resultMin(matrix[3][0], matrix[3][1], matrix[3][2]);
+        GfVec3d resultMax = resultMin;
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                const double a = matrix[i][j] * rangeMin[i];
+                const double b = matrix[i][j] * rangeMax[i];
+                resultMin[j] += std::min(a, b);
+                resultMax[j] += std::max(a, b);
+            }
+        }
+        return GfRange3d(resultMin, resultMax);
+    }
+
     // XXX This is based on UsdGeomPointInstancer::ComputeExtentAtTime. Ideally,
     // we would just use UsdGeomPointInstancer, however it does not account for
     // multi-sampled transforms (see bug 147526).
@@ -96,21 +126,41 @@ namespace
                               const _PathToPrimMap& primCache,
                               const std::vector<bool>& mask)
     {
-        GfRange3d extentRange;
-
         const size_t numSampleTimes = motionSampleTimes.size();
+        const size_t numProtos = protoPaths.size();
+        const size_t numInstances = protoIndices.size();
 
-        for (size_t i = 0; i < protoIndices.size(); ++i) {
-            if (!mask.empty() && !mask[i]) {
-                continue;
+        // Only compute bounds for prototypes that are referenced by at least
+        // one unmasked instance.
+        //
+        std::vector<char> protoUsed(numProtos, 0);
+        for (size_t i = 0; i < numInstances; ++i)
+        {
+            if (mask.empty() || mask[i])
+            {
+                protoUsed[protoIndices[i]] = 1;
             }
+        }
 
-            const int protoIndex = protoIndices[i];
-            const SdfPath &protoPath = protoPaths[protoIndex];
+        // Compute each prototype's bound once per motion sample, rather than
+        // once per instance. Each bound is kept as its untransformed range
+        // and its matrix so that the instance transform can be folded in
+        // with a single matrix product.
+        //
+        std::vector<GfRange3d> protoRanges(numProtos * numSampleTimes);
+        std::vector<GfMatrix4d> protoMatrices(numProtos * numSampleTimes);
+        for (size_t p = 0; p < numProtos; ++p)
+        {
+            if (!protoUsed[p])
+            {
+                continue;
+            }
 
-            _PathToPrimMap::const_iterator pcIt = primCache.find(protoPath);
-            const UsdPrim &protoPrim = pcIt->second;
-            if (!protoPrim) {
+            _PathToPrimMap::const_iterator pcIt = primCache.find(protoPaths[p]);
+            const UsdPrim& protoPrim = pcIt->second;
+            if (!protoPrim)
+            {
+                protoUsed[p] = 0;
                 continue;
             }
 
@@ -118,20 +168,55 @@ namespace
             // that we apply the prototype's local transform to account for any
             // offsets.
             //
-            std::vector<GfBBox3d> sampledBounds = usdInArgs->ComputeBounds(
+            const std::vector<GfBBox3d> sampledBounds = usdInArgs->ComputeBounds(
                 protoPrim, motionSampleTimes, /* applyLocalTransform */ true);
-
-            for (size_t a = 0; a < numSampleTimes; ++a) {
-                // Apply the instance transform to the bounding box for this
-                // time sample. We don't apply the parent transform here, as the
-                // bounds need to be in parent-local space.
-                //
-                GfBBox3d thisBounds(sampledBounds[a]);
-                thisBounds.Transform(xforms[a][i]);
-                extentRange.UnionWith(thisBounds.ComputeAlignedRange());
+            for (size_t a = 0; a < numSampleTimes; ++a)
+            {
+                protoRanges[p * numSampleTimes + a] = sampledBounds[a].GetRange();
+                protoMatrices[p * numSampleTimes + a] = sampledBounds[a].GetMatrix();
             }
         }
 
+        // Apply the instance transforms to the prototype bounds and reduce
+        // them in parallel. We don't apply the parent transform here, as the
+        // bounds need to be in parent-local space.
+        //
+        const GfRange3d extentRange = WorkParallelReduceN(
+            GfRange3d(),
+            numInstances,
+            [&](size_t begin, size_t end, GfRange3d range) {
+                for (size_t i = begin; i < end; ++i)
+                {
+                    if (!mask.empty() && !mask[i])
+                    {
+                        continue;
+                    }
+
+                    const size_t protoIndex = protoIndices[i];
+                    if (!protoUsed[protoIndex])
+                    {
+                        continue;
+                    }
+
+                    for (size_t a = 0; a < numSampleTimes; ++a)
+                    {
+                        const size_t boundIndex = protoIndex * numSampleTimes + a;
+                        const GfRange3d& protoRange = protoRanges[boundIndex];
+                        if (protoRange.IsEmpty())
+                        {
+                            continue;
+                        }
+                        range.UnionWith(_TransformAlignedRange(
+                            protoRange, protoMatrices[boundIndex] * xforms[a][i]));
+                    }
+                }
+                return range;
+            },
+            [](const GfRange3d& lhs, const GfRange3d& rhs) {
+                return GfRange3d::GetUnion(lhs, rhs);
+            },
+            /* grainSize */ 4096);
+
         if (extentRange.IsEmpty()) {
             return false;
         }
@@ -338,34 +423,41 @@ void UsdKatanaReadPointInstancer(const UsdGeomPointInstancer& instancer,
 
     FnGeolibServices::StaticSceneCreateOpArgsBuilder sourcesBldr(false);
 
-    std::vector<int> instanceIndices;
-    instanceIndices.reserve(numInstances);
-
     std::vector<std::string> instanceSources;
     instanceSources.reserve(protoPaths.size());
 
     std::map<std::string, int> instanceSourceIndexMap;
 
-    std::vector<int> omitList;
-    omitList.reserve(numInstances);
-
     std::map<SdfPath, std::string> protoPathsToKatPaths;
     std::map<std::string, std::vector<std::string>> usdPrimPathsTracker;
 
-
-    for (size_t i = 0; i < numInstances; ++i)
+    // Gather the referenced prototype indices in order of first use, so that
+    // instance sources keep the order in which instances refer to them.
+    //
+    std::vector<int> protoOrder;
+    protoOrder.reserve(protoPaths.size());
     {
-        int index = protoIndices[i];
-
-        // Check to see if we are pruned.
-        //
-        bool isPruned = (!pruneMaskValues.empty() and
-                         pruneMaskValues[i] == false);
-        if (isPruned)
+        std::vector<char> protoSeen(protoPaths.size(), 0);
+        for (size_t i = 0; i < numInstances && protoOrder.size() < protoPaths.size(); ++i)
         {
-            omitList.push_back(i);
+            const int index = protoIndices[i];
+            if (!protoSeen[index])
+            {
+                protoSeen[index] = 1;
+                protoOrder.push_back(index);
+            }
         }
+    }
+
+    // Resolve the instance source of each prototype once. All of the string
+    // work happens here, so it scales with the number of prototypes rather
+    // than the number of instances. Prototypes that cannot be resolved keep
+    // an index of -1.
+    //
+    std::vector<int> protoSourceIndices(protoPaths.size(), -1);
 
+    for (const int index : protoOrder)
+    {
         const SdfPath &protoPath = protoPaths[index];
 
         // Compute the Katana path to this prototype.
@@ -609,7 +701,43 @@ void UsdKatanaReadPointInstancer(const UsdGeomPointInstancer& instancer,
             protoPathsToKatPaths[protoPath] = katProtoPath;
         }
 
-        instanceIndices.push_back(instanceSourceIndexMap[katProtoPath]);
+        protoSourceIndices[index] = instanceSourceIndexMap[katProtoPath];
+    }
+
+    // Map every instance to its instance source in a single linear pass.
+    // Instances whose prototype could not be resolved are omitted.
+    //
+    const bool hasUnresolvedProtos =
+        std::any_of(protoOrder.begin(), protoOrder.end(), [&](int index) {
+            return protoSourceIndices[index] < 0;
+        });
+
+    VtIntArray instanceIndices(numInstances);
+    int* instanceIndicesData = instanceIndices.data();
+    WorkParallelForN(
+        numInstances,
+        [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const int sourceIndex = protoSourceIndices[protoIndices[i]];
+                instanceIndicesData[i] = sourceIndex < 0 ? 0 : sourceIndex;
+            }
+        },
+        /* grainSize */ 8192);
+
+    std::vector<int> omitList;
+    if (!pruneMaskValues.empty() || hasUnresolvedProtos)
+    {
+        for (size_t i = 0; i < numInstances; ++i)
+        {
+            // Check to see if we are pruned.
+            //
+            const bool isPruned = !pruneMaskValues.empty() && !pruneMaskValues[i];
+            if (isPruned || protoSourceIndices[protoIndices[i]] < 0)
+            {
+                omitList.push_back(i);
+            }
+        }
     }
 
     //
@@ -624,10 +752,15 @@ void UsdKatanaReadPointInstancer(const UsdGeomPointInstancer& instancer,
             "geometry.instanceSource",
                     FnKat::StringAttribute(instanceSources, 1));
 
+#if KATANA_VERSION_MAJOR >= 3
+    instancesBldr.setAttrAtLocation("instances",
+            "geometry.instanceIndex", VtKatanaMapOrCopy(instanceIndices));
+#else
     instancesBldr.setAttrAtLocation("instances",
             "geometry.instanceIndex",
-                    FnKat::IntAttribute(&instanceIndices[0],
+                    FnKat::IntAttribute(instanceIndices.cdata(),
                             instanceIndices.size(), 1));
+#endif // KATANA_VERSION_MAJOR >= 3
 
 #if KATANA_VERSION_MAJOR >= 3
     // If motion is backwards, make sure to reverse time samples.
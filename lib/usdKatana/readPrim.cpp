@@ -29,9 +29,13 @@
 //
 #include "usdKatana/readPrim.h"
 
+#include <unordered_set>
+#include <vector>
+
 #include <pxr/base/tf/envSetting.h>
 #include <pxr/base/tf/getenv.h>
 #include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/work/loops.h>
 #include <pxr/pxr.h>
 #include <pxr/usd/sdf/path.h>
 #include <pxr/usd/usd/collectionAPI.h>
@@ -56,6 +60,7 @@
 #include "usdKatana/tokens.h"
 #include "usdKatana/usdInPrivateData.h"
 #include "usdKatana/utils.h"
+#include "vtKatana/array.h"
 
 #include <pystring/pystring.h>
 #include <FnLogging/FnLogging.h>
@@ -769,13 +774,82 @@ _AddCustomProperties(
     return foundCustomProperties;
 }
 
+namespace {
+
+// A primvar queued for conversion by UsdKatanaGeomGetPrimvarGroup.
+struct _PrimvarConversion
+{
+    UsdGeomPrimvar primvar;
+    TfToken name;
+    TfToken interpolation;
+    SdfValueTypeName typeName;
+    int elementSize = 0;
+
+    bool isValid = false;
+    bool isIndexed = false;
+    FnKat::Attribute indexAttr;
+    FnKat::Attribute valueAttr;
+    FnKat::Attribute inputTypeAttr;
+    FnKat::Attribute elementSizeAttr;
+};
+
+// Fetches the value of a primvar and converts it to Katana attributes.
+// Indexed primvars keep their indexed form, except for constant primvars,
+// which are flattened. Either way, the values are only read once.
+void _ConvertPrimvar(_PrimvarConversion& conversion, double currentTime)
+{
+    const UsdGeomPrimvar& primvar = conversion.primvar;
+
+    VtValue vtValue;
+    if (conversion.interpolation != UsdGeomTokens->constant && primvar.IsIndexed())
+    {
+        if (!primvar.Get(&vtValue, currentTime))
+        {
+            return;
+        }
+
+        // Without indices at this time, the values are already flat.
+        VtIntArray indices;
+        if (primvar.GetIndices(&indices, currentTime))
+        {
+            conversion.isIndexed = true;
+            conversion.indexAttr = VtKatanaMapOrCopy(indices);
+        }
+    }
+    else if (!primvar.ComputeFlattened(&vtValue, currentTime))
+    {
+        return;
+    }
+
+    UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr(
+        vtValue, conversion.elementSize, conversion.typeName.GetRole(), &conversion.valueAttr,
+        &conversion.inputTypeAttr, &conversion.elementSizeAttr);
+    conversion.isValid = true;
+}
+
+} // anon namespace
+
 FnKat::Attribute UsdKatanaGeomGetPrimvarGroup(const UsdGeomImageable& imageable,
                                               const UsdKatanaUsdInPrivateData& data)
 {
-    // Usd primvars -> Primvar attributes
-    FnKat::GroupBuilder gdBuilder;
+    const UsdPrim prim = imageable.GetPrim();
 
+    // Gather the blind data attributes that are blocked once, rather than
+    // checking every primvar against the blind data object.
+    UsdKatanaBlindDataObject kbd(prim);
+    std::unordered_set<TfToken, TfToken::HashFunctor> blockedKbdAttrs;
+    for (const UsdProperty& prop : kbd.GetKbdAttributes())
+    {
+        const UsdAttribute kbdAttr = prop.As<UsdAttribute>();
+        if (kbdAttr && kbdAttr.GetResolveInfo().ValueIsBlocked())
+        {
+            blockedKbdAttrs.insert(kbdAttr.GetName());
+        }
+    }
+
+    std::vector<_PrimvarConversion> conversions;
     std::vector<UsdGeomPrimvar> primvarAttrs = UsdGeomPrimvarsAPI(imageable).GetPrimvars();
+    conversions.reserve(primvarAttrs.size());
     TF_FOR_ALL(primvar, primvarAttrs) {
         // Katana backends (such as RFK) are not prepared to handle
         // groups of primvars under geometry.arbitrary, which leaves us
@@ -786,49 +860,63 @@ FnKat::Attribute UsdKatanaGeomGetPrimvarGroup(const UsdGeomImageable& imageable,
             continue;
 
         // If there is a block from blind data, skip to avoid the cost
-        UsdKatanaBlindDataObject kbd(imageable.GetPrim());
-
+        //
         // XXX If we allow namespaced primvars (by eliminating the
         // short-circuit above), we will require GetKbdAttribute to be able
         // to translate namespaced names...
-        UsdAttribute blindAttr = kbd.GetKbdAttribute("geometry.arbitrary." +
-                                                     primvar->GetPrimvarName().GetString());
-
-        if (blindAttr.GetResolveInfo().ValueIsBlocked()) {
-            continue;
+        if (!blockedKbdAttrs.empty())
+        {
+            UsdAttribute blindAttr = kbd.GetKbdAttribute("geometry.arbitrary." +
+                                                         primvar->GetPrimvarName().GetString());
+            if (blockedKbdAttrs.count(blindAttr.GetName()) > 0)
+            {
+                continue;
+            }
         }
 
-        TfToken          name, interpolation;
-        SdfValueTypeName typeName;
-        int              elementSize;
+        conversions.emplace_back();
+        _PrimvarConversion& conversion = conversions.back();
+        conversion.primvar = *primvar;
 
         // GetDeclarationInfo inclues all namespaces other than "primvars:" in
         // 'name'
-        primvar->GetDeclarationInfo(&name, &typeName,
-                                    &interpolation, &elementSize);
+        primvar->GetDeclarationInfo(&conversion.name, &conversion.typeName,
+                                    &conversion.interpolation, &conversion.elementSize);
+    }
+
+    // Fetching and converting the values dominates for heavy primvars (such
+    // as faceVarying UV sets), so convert them concurrently.
+    const double currentTime = data.GetCurrentTime();
+    WorkParallelForN(conversions.size(), [&conversions, currentTime](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            _ConvertPrimvar(conversions[i], currentTime);
+        }
+    });
+
+    // Usd primvars -> Primvar attributes
+    FnKat::GroupBuilder gdBuilder;
+    const bool isCurve = prim.IsA<UsdGeomCurves>();
+    for (const _PrimvarConversion& conversion : conversions)
+    {
+        if (!conversion.isValid)
+        {
+            continue;
+        }
+
+        const TfToken& interpolation = conversion.interpolation;
+        const SdfValueTypeName& typeName = conversion.typeName;
 
         // Name: this will eventually need to know how to translate namespaces
-        std::string gdName = name;
+        const std::string& gdName = conversion.name.GetString();
 
-        VtValue vtValue;
-        VtIntArray indices;
-        bool isFaceVarying = false;
         // Convert interpolation -> scope
         FnKat::StringAttribute scopeAttr;
-        const bool isCurve = imageable.GetPrim().IsA<UsdGeomCurves>();
         if (isCurve && interpolation == UsdGeomTokens->varying)
         {
             // it's a curve, so "varying" == "vertex"
             scopeAttr = FnKat::StringAttribute("vertex");
         }
-        else if (interpolation == UsdGeomTokens->faceVarying)
-        {
-            scopeAttr = FnKat::StringAttribute("vertex");
-            if (primvar->GetAttr().Get(&vtValue, data.GetCurrentTime()) &&
-                primvar->GetIndices(&indices, data.GetCurrentTime())) {
-                isFaceVarying = true;
-            }
-        }
         else
         {
             scopeAttr = FnKat::StringAttribute(
@@ -839,22 +927,10 @@ FnKat::Attribute UsdKatanaGeomGetPrimvarGroup(const UsdGeomImageable& imageable,
                     "primitive" );
         }
 
-        // Resolve the value if not face-varying
-        if (!isFaceVarying && !primvar->ComputeFlattened(
-                &vtValue, data.GetCurrentTime()))
-        {
-            continue;
-        }
-
-        // Convert value to the required Katana attributes to describe it.
-        FnKat::Attribute valueAttr, inputTypeAttr, elementSizeAttr;
-        UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr(
-            vtValue, elementSize, typeName.GetRole(), &valueAttr, &inputTypeAttr, &elementSizeAttr);
-
         // Bundle them into a group attribute
         FnKat::GroupBuilder attrBuilder;
         attrBuilder.set("scope", scopeAttr);
-        attrBuilder.set("inputType", inputTypeAttr);
+        attrBuilder.set("inputType", conversion.inputTypeAttr);
         // Retain the usd type name so that we can use this attribute when converting back to USD
         attrBuilder.set("usd.usdType", FnKat::StringAttribute(typeName.GetAsToken().GetString()));
 
@@ -863,23 +939,24 @@ FnKat::Attribute UsdKatanaGeomGetPrimvarGroup(const UsdGeomImageable& imageable,
                             FnKat::StringAttribute(typeName.GetRole().GetString()));
         }
 
-        if (elementSizeAttr.isValid()) {
-            attrBuilder.set("elementSize", elementSizeAttr);
+        if (conversion.elementSizeAttr.isValid()) {
+            attrBuilder.set("elementSize", conversion.elementSizeAttr);
         }
 
-        if (isFaceVarying) {
-            attrBuilder.set("indexedValue", valueAttr);
-            attrBuilder.set("index", FnAttribute::IntAttribute(indices.data(), indices.size(), 1));
+        if (conversion.isIndexed) {
+            attrBuilder.set("indexedValue", conversion.valueAttr);
+            attrBuilder.set("index", conversion.indexAttr);
         } else {
-            attrBuilder.set("value", valueAttr);
-            // Note that 'varying' vs 'vertex' require special handling, as in
-            // Katana they are both expressed as 'point' scope above. To get
-            // 'vertex' interpolation we must set an additional
-            // 'interpolationType' attribute.  So we will flag that here.
-            if (interpolation == UsdGeomTokens->vertex) {
-                attrBuilder.set("interpolationType",
-                                FnKat::StringAttribute("subdiv"));
-            }
+            attrBuilder.set("value", conversion.valueAttr);
+        }
+
+        // Note that 'varying' vs 'vertex' require special handling, as in
+        // Katana they are both expressed as 'point' scope above. To get
+        // 'vertex' interpolation we must set an additional
+        // 'interpolationType' attribute.  So we will flag that here.
+        if (interpolation == UsdGeomTokens->vertex) {
+            attrBuilder.set("interpolationType",
+                            FnKat::StringAttribute("subdiv"));
         }
 
         gdBuilder.set(gdName, attrBuilder.build());
@@ -29,7 +29,9 @@
 //
 #include "usdKatana/readXformable.h"
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 #include <pxr/pxr.h>
 #include <pxr/usd/usdGeom/xform.h>
@@ -40,6 +42,7 @@
 
 #include "usdKatana/attrMap.h"
 #include "usdKatana/readPrim.h"
+#include "usdKatana/usdInArgs.h"
 #include "usdKatana/usdInPrivateData.h"
 #include "usdKatana/utils.h"
 
@@ -47,22 +50,16 @@ PXR_NAMESPACE_OPEN_SCOPE
 
 FnLogSetup("UsdKatanaReadXformable");
 
-bool UsdKatanaReadXformable(const UsdGeomXformable& xformable,
-                            const UsdKatanaUsdInPrivateData& data,
-                            FnAttribute::GroupAttribute& attr)
-{
-    //
-    // Calculate and set the xform attribute.
-    //
+namespace {
 
+// Builds one matrix per xform op and motion sample, and lets Katana compose
+// them into the xform matrix.
+FnAttribute::DoubleAttribute _ComposeXformOpsInKatana(
+    const std::vector<UsdGeomXformOp>& orderedXformOps,
+    const UsdKatanaUsdInPrivateData& data)
+{
     double currentTime = data.GetCurrentTime();
 
-    // Get the ordered xform ops for the prim.
-    //
-    bool resetsXformStack = false;
-    std::vector<UsdGeomXformOp> orderedXformOps =
-        xformable.GetOrderedXformOps(&resetsXformStack);
-
     FnKat::GroupBuilder gb;
 
     const bool isMotionBackward = data.IsMotionBackward();
@@ -71,33 +68,41 @@ bool UsdKatanaReadXformable(const UsdGeomXformable& xformable,
     // transformation data for each time sample it has.
     //
     int opCount = 0;
-    for (std::vector<UsdGeomXformOp>::iterator I = orderedXformOps.begin(); 
+    for (std::vector<UsdGeomXformOp>::const_iterator I = orderedXformOps.begin(); 
             I != orderedXformOps.end(); ++I)
     {
-        UsdGeomXformOp& xformOp = (*I);
+        const UsdGeomXformOp& xformOp = (*I);
 
         const std::vector<double>& motionSampleTimes = 
             data.GetMotionSampleTimes(xformOp.GetAttr());
 
-        FnKat::DoubleBuilder matBuilder(16);
+        std::vector<GfMatrix4d> mats;
+        mats.reserve(motionSampleTimes.size());
         TF_FOR_ALL(iter, motionSampleTimes)
         {
-            double relSampleTime = *iter;
-            double time = currentTime + relSampleTime;
+            mats.push_back(xformOp.GetOpTransform(currentTime + *iter));
+        }
 
-            GfMatrix4d mat = xformOp.GetOpTransform(time);
+        // Ops with fewer authored samples than requested motion times yield
+        // identical matrices; emit those as a single static sample.
+        const bool isStatic =
+            mats.size() > 1 &&
+            std::all_of(mats.begin() + 1, mats.end(),
+                        [&mats](const GfMatrix4d& mat) { return mat == mats.front(); });
+        const size_t numSamples = isStatic ? 1 : mats.size();
+
+        FnKat::DoubleBuilder matBuilder(16);
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const double relSampleTime = isStatic ? 0.0 : motionSampleTimes[i];
 
             // Convert to vector.
-            const double *matArray = mat.GetArray();
+            const double *matArray = mats[i].GetArray();
             std::vector<double>& matVec =
                 matBuilder.get(isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(relSampleTime)
                                                 : relSampleTime);
 
-            matVec.resize(16);
-            for (int i = 0; i < 16; ++i)
-            {
-                matVec[i] = matArray[i];
-            }
+            matVec.assign(matArray, matArray + 16);
         }
 
         std::stringstream ss;
@@ -106,6 +111,72 @@ bool UsdKatanaReadXformable(const UsdGeomXformable& xformable,
         opCount++;
     }
 
+    return FnGeolibServices::FnXFormUtil::CalcTransformMatrixAtExistingTimes(gb.build()).first;
+}
+
+// Reads the local transform once per motion sample, at the union of the
+// sample times of the ops, and writes it as a single matrix.
+FnAttribute::DoubleAttribute _ReadLocalTransformation(
+    const std::vector<UsdGeomXformOp>& orderedXformOps,
+    const UsdKatanaUsdInPrivateData& data)
+{
+    const double currentTime = data.GetCurrentTime();
+    const bool isMotionBackward = data.IsMotionBackward();
+
+    std::vector<double> motionSampleTimes;
+    for (const UsdGeomXformOp& xformOp : orderedXformOps)
+    {
+        const std::vector<double> opSampleTimes = data.GetMotionSampleTimes(xformOp.GetAttr());
+        motionSampleTimes.insert(motionSampleTimes.end(), opSampleTimes.begin(),
+                                 opSampleTimes.end());
+    }
+    std::sort(motionSampleTimes.begin(), motionSampleTimes.end());
+    motionSampleTimes.erase(std::unique(motionSampleTimes.begin(), motionSampleTimes.end()),
+                            motionSampleTimes.end());
+
+    std::vector<GfMatrix4d> mats(motionSampleTimes.size());
+    for (size_t i = 0; i < motionSampleTimes.size(); ++i)
+    {
+        UsdGeomXformable::GetLocalTransformation(&mats[i], orderedXformOps,
+                                                 currentTime + motionSampleTimes[i]);
+    }
+
+    // Emit stacks that don't vary over the shutter as a single static sample.
+    const bool isStatic =
+        mats.size() > 1 &&
+        std::all_of(mats.begin() + 1, mats.end(),
+                    [&mats](const GfMatrix4d& mat) { return mat == mats.front(); });
+    const size_t numSamples = isStatic ? 1 : mats.size();
+
+    FnKat::DoubleBuilder matBuilder(16);
+    for (size_t i = 0; i < numSamples; ++i)
+    {
+        const double relSampleTime = isStatic ? 0.0 : motionSampleTimes[i];
+        const double* matArray = mats[i].GetArray();
+        std::vector<double>& matVec =
+            matBuilder.get(isMotionBackward ? UsdKatanaUtils::ReverseTimeSample(relSampleTime)
+                                            : relSampleTime);
+        matVec.assign(matArray, matArray + 16);
+    }
+    return matBuilder.build();
+}
+
+} // anon namespace
+
+bool UsdKatanaReadXformable(const UsdGeomXformable& xformable,
+                            const UsdKatanaUsdInPrivateData& data,
+                            FnAttribute::GroupAttribute& attr)
+{
+    //
+    // Calculate and set the xform attribute.
+    //
+
+    // Get the ordered xform ops for the prim.
+    //
+    bool resetsXformStack = false;
+    std::vector<UsdGeomXformOp> orderedXformOps =
+        xformable.GetOrderedXformOps(&resetsXformStack);
+
     // Only set an 'xform' attribute if xform ops were found.
     //
     if (!orderedXformOps.empty())
@@ -121,8 +192,9 @@ bool UsdKatanaReadXformable(const UsdGeomXformable& xformable,
         }
 
         FnAttribute::DoubleAttribute matrixAttr =
-        FnGeolibServices::FnXFormUtil::
-            CalcTransformMatrixAtExistingTimes(gb.build()).first;
+            data.GetUsdInArgs()->GetComposeXformOpsInKatana()
+                ? _ComposeXformOpsInKatana(orderedXformOps, data)
+                : _ReadLocalTransformation(orderedXformOps, data);
 
         xformGb.set("matrix", matrixAttr);
 
@@ -0,0 +1,135 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/skinningCache.h"
+
+#include <algorithm>
+
+#include <pxr/pxr.h>
+#include <pxr/base/tf/envSetting.h>
+#include <pxr/base/trace/trace.h>
+#include <pxr/usd/usd/primFlags.h>
+#include <pxr/usd/usdSkel/skeleton.h>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+TF_DEFINE_ENV_SETTING(USD_KATANA_SKINNING_CACHE_MAX_TIMES,
+                      16,
+                      "Number of times whose skinning transforms are kept by "
+                      "UsdKatanaSkinningCache.");
+
+UsdKatanaSkinningCache::UsdKatanaSkinningCache() {}
+
+bool UsdKatanaSkinningCache::Populate(const UsdSkelRoot& skelRoot)
+{
+    if (!skelRoot)
+    {
+        return false;
+    }
+
+    // The accessor holds a write lock on the SkelRoot's entry, so concurrent
+    // requests for the same SkelRoot wait for the first one to populate it
+    // while other SkelRoots can be populated in parallel.
+    _PopulatedRootMap::accessor accessor;
+    if (_populatedRoots.insert(accessor, skelRoot.GetPath()))
+    {
+        TRACE_FUNCTION();
+        accessor->second = _skelCache.Populate(skelRoot, UsdTraverseInstanceProxies());
+    }
+    return accessor->second;
+}
+
+UsdSkelSkinningQuery UsdKatanaSkinningCache::GetSkinningQuery(const UsdPrim& prim) const
+{
+    return _skelCache.GetSkinningQuery(prim);
+}
+
+UsdSkelSkeletonQuery UsdKatanaSkinningCache::GetSkelQuery(const UsdSkelSkeleton& skel) const
+{
+    return _skelCache.GetSkelQuery(skel);
+}
+
+bool UsdKatanaSkinningCache::ComputeSkinningTransforms(const UsdSkelSkeletonQuery& skelQuery,
+                                                       double time,
+                                                       VtMatrix4dArray* xforms)
+{
+    if (!skelQuery || !xforms)
+    {
+        return false;
+    }
+
+    const SdfPath skelPath = skelQuery.GetPrim().GetPath();
+    {
+        std::lock_guard<std::mutex> lock(_skinningXformsMutex);
+        auto found = _skinningXforms.find(time);
+        if (found != _skinningXforms.end())
+        {
+            _recentTimes.splice(_recentTimes.end(), _recentTimes, found->second.recentTime);
+            auto skinningXforms = found->second.skinningXforms.find(skelPath);
+            if (skinningXforms != found->second.skinningXforms.end())
+            {
+                *xforms = skinningXforms->second;
+                return true;
+            }
+        }
+    }
+
+    // Computed outside of any lock; if two meshes race on the same skeleton
+    // and time the results are identical, so the first insert wins.
+    if (!skelQuery.ComputeSkinningTransforms(xforms, time))
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(_skinningXformsMutex);
+    auto found = _skinningXforms.find(time);
+    if (found == _skinningXforms.end())
+    {
+        // Evict the least recently used times.
+        const size_t maxTimes = static_cast<size_t>(
+            std::max(1, TfGetEnvSetting(USD_KATANA_SKINNING_CACHE_MAX_TIMES)));
+        while (_skinningXforms.size() >= maxTimes)
+        {
+            _skinningXforms.erase(_recentTimes.front());
+            _recentTimes.pop_front();
+        }
+        found = _skinningXforms
+                    .emplace(time, _TimeEntry{_SkinningXformMap(),
+                                              _recentTimes.insert(_recentTimes.end(), time)})
+                    .first;
+    }
+    found->second.skinningXforms.emplace(skelPath, *xforms);
+    return true;
+}
+
+void UsdKatanaSkinningCache::Clear()
+{
+    _populatedRoots.clear();
+    {
+        std::lock_guard<std::mutex> lock(_skinningXformsMutex);
+        _skinningXforms.clear();
+        _recentTimes.clear();
+    }
+    _skelCache.Clear();
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
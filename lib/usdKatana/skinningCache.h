@@ -0,0 +1,112 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_SKINNINGCACHE_H
+#define USDKATANA_SKINNINGCACHE_H
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
+#include <pxr/pxr.h>
+#include <pxr/base/vt/types.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usdSkel/cache.h>
+#include <pxr/usd/usdSkel/root.h>
+#include <pxr/usd/usdSkel/skeletonQuery.h>
+#include <pxr/usd/usdSkel/skinningQuery.h>
+
+#include <tbb/concurrent_hash_map.h>
+
+#include "usdKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/// \brief Thread-safe cache of UsdSkel data shared by every location cooked
+/// with the same UsdKatanaUsdInArgs.
+///
+/// Each SkelRoot is only populated once, no matter how many skinned meshes
+/// are bound beneath it, and joint skinning transforms are memoized per
+/// skeleton and time so that each mesh only pays for its own deformation.
+/// Transforms are kept for the most recently used
+/// USD_KATANA_SKINNING_CACHE_MAX_TIMES times only.
+class UsdKatanaSkinningCache
+{
+public:
+    USDKATANA_API UsdKatanaSkinningCache();
+
+    UsdKatanaSkinningCache(const UsdKatanaSkinningCache&) = delete;
+    UsdKatanaSkinningCache& operator=(const UsdKatanaSkinningCache&) = delete;
+
+    /// \brief Populate the cache for \p skelRoot, traversing instance
+    ///        proxies. Subsequent calls for the same SkelRoot are no-ops.
+    USDKATANA_API bool Populate(const UsdSkelRoot& skelRoot);
+
+    /// \brief Return the skinning query for \p prim. The SkelRoot enclosing
+    ///        \p prim must have been populated first.
+    USDKATANA_API UsdSkelSkinningQuery GetSkinningQuery(const UsdPrim& prim) const;
+
+    /// \brief Return the skeleton query for \p skel.
+    USDKATANA_API UsdSkelSkeletonQuery GetSkelQuery(const UsdSkelSkeleton& skel) const;
+
+    /// \brief Compute (or fetch previously computed) skinning transforms of
+    ///        the skeleton of \p skelQuery at \p time.
+    USDKATANA_API bool ComputeSkinningTransforms(const UsdSkelSkeletonQuery& skelQuery,
+                                                 double time,
+                                                 VtMatrix4dArray* xforms);
+
+    /// \brief Drop all populated SkelRoots and memoized transforms.
+    USDKATANA_API void Clear();
+
+    UsdSkelCache& GetUsdSkelCache() { return _skelCache; }
+
+private:
+    struct _PathHashCompare
+    {
+        static size_t hash(const SdfPath& path) { return path.GetHash(); }
+        static bool equal(const SdfPath& a, const SdfPath& b) { return a == b; }
+    };
+
+    UsdSkelCache _skelCache;
+
+    // SkelRoot path -> whether population succeeded.
+    typedef tbb::concurrent_hash_map<SdfPath, bool, _PathHashCompare> _PopulatedRootMap;
+    _PopulatedRootMap _populatedRoots;
+
+    // Skeleton path -> skinning transforms, for one time.
+    typedef std::unordered_map<SdfPath, VtMatrix4dArray, SdfPath::Hash> _SkinningXformMap;
+    struct _TimeEntry
+    {
+        _SkinningXformMap skinningXforms;
+        std::list<double>::iterator recentTime;
+    };
+
+    std::mutex _skinningXformsMutex;
+    std::map<double, _TimeEntry> _skinningXforms;
+    // Times of _skinningXforms, least recently used first.
+    std::list<double> _recentTimes;
+};
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_SKINNINGCACHE_H
@@ -0,0 +1,98 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "pxr/pxr.h"
+#include "pxr/usd/kind/registry.h"
+#include "pxr/usd/usd/modelAPI.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/bboxCache.h"
+#include "pxr/usd/usdGeom/cube.h"
+#include "pxr/usd/usdGeom/tokens.h"
+#include "pxr/usd/usdGeom/xform.h"
+
+#include "usdKatana/boundsCache.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace BoundsCacheTests
+{
+// Adds an assembly of count components below /World, each holding a cube of
+// a different size, and returns the paths of every model.
+SdfPathVector CreateModels(const UsdStageRefPtr& stage, int count)
+{
+    const SdfPath worldPath("/World");
+    UsdGeomXform::Define(stage, worldPath);
+    UsdModelAPI(stage->GetPrimAtPath(worldPath)).SetKind(KindTokens->assembly);
+
+    SdfPathVector modelPaths = {worldPath};
+    for (int i = 0; i < count; ++i)
+    {
+        const SdfPath modelPath = worldPath.AppendChild(TfToken("model" + std::to_string(i)));
+        UsdGeomXform::Define(stage, modelPath);
+        UsdModelAPI(stage->GetPrimAtPath(modelPath)).SetKind(KindTokens->component);
+        UsdGeomCube::Define(stage, modelPath.AppendChild(TfToken("cube")))
+            .CreateSizeAttr(VtValue(1.0 + i));
+        modelPaths.push_back(modelPath);
+    }
+    return modelPaths;
+}
+
+TEST(BoundsCacheTest, WarmUpFillsModelBounds)
+{
+    const UsdStageRefPtr stage = UsdStage::CreateInMemory();
+    const SdfPathVector modelPaths = CreateModels(stage, 8);
+    const std::vector<double> times = {1.0, 2.0};
+
+    UsdKatanaBoundsCache& boundsCache = UsdKatanaBoundsCache::GetInstance();
+    boundsCache.WarmUp(stage->GetPseudoRoot(), times);
+
+    // Every model bound is now a lookup.
+    const UsdKatanaBoundsCache::Stats warm = boundsCache.GetStats();
+    for (const SdfPath& modelPath : modelPaths)
+    {
+        const UsdPrim prim = stage->GetPrimAtPath(modelPath);
+        const std::vector<GfBBox3d> bounds = boundsCache.ComputeBounds(prim, times);
+        ASSERT_EQ(bounds.size(), times.size());
+        for (size_t i = 0; i < times.size(); ++i)
+        {
+            UsdGeomBBoxCache bboxCache(times[i],
+                                       {UsdGeomTokens->default_, UsdGeomTokens->render},
+                                       /* useExtentsHint */ true);
+            EXPECT_EQ(bounds[i], bboxCache.ComputeUntransformedBound(prim)) << modelPath;
+        }
+    }
+    const UsdKatanaBoundsCache::Stats queried = boundsCache.GetStats();
+    EXPECT_EQ(queried.misses, warm.misses);
+    EXPECT_EQ(queried.hits, warm.hits + modelPaths.size() * times.size());
+
+    // Non-model prims were not warmed up.
+    boundsCache.ComputeBounds(stage->GetPrimAtPath(modelPaths.back().AppendChild(TfToken("cube"))),
+                              times);
+    EXPECT_EQ(boundsCache.GetStats().misses, warm.misses + times.size());
+}
+
+TEST(BoundsCacheTest, EditDropsWarmedUpBounds)
+{
+    const UsdStageRefPtr stage = UsdStage::CreateInMemory();
+    const SdfPathVector modelPaths = CreateModels(stage, 2);
+    const std::vector<double> times = {1.0};
+
+    UsdKatanaBoundsCache& boundsCache = UsdKatanaBoundsCache::GetInstance();
+    boundsCache.WarmUp(stage->GetPseudoRoot(), times);
+
+    const SdfPath cubePath = modelPaths.back().AppendChild(TfToken("cube"));
+    UsdGeomCube(stage->GetPrimAtPath(cubePath)).GetSizeAttr().Set(10.0);
+
+    const UsdKatanaBoundsCache::Stats edited = boundsCache.GetStats();
+    const UsdPrim prim = stage->GetPrimAtPath(modelPaths.back());
+    const std::vector<GfBBox3d> bounds = boundsCache.ComputeBounds(prim, times);
+    ASSERT_EQ(bounds.size(), 1u);
+    EXPECT_EQ(bounds[0].GetRange(), GfRange3d(GfVec3d(-5.0), GfVec3d(5.0)));
+    EXPECT_EQ(boundsCache.GetStats().misses, edited.misses + 1);
+}
+
+}  // namespace BoundsCacheTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
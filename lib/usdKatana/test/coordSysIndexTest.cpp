@@ -0,0 +1,219 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "pxr/base/tf/iterator.h"
+#include "pxr/base/tf/stringUtils.h"
+#include "pxr/pxr.h"
+#include "pxr/usd/kind/registry.h"
+#include "pxr/usd/usd/modelAPI.h"
+#include "pxr/usd/usd/primFlags.h"
+#include "pxr/usd/usd/primRange.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/xform.h"
+#include "pxr/usd/usdRi/statementsAPI.h"
+
+#include "usdKatana/cache.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace CoordSysIndexTests
+{
+const std::string kRootLocation = "/root";
+
+// The walk of the model hierarchy that the index replaces, as it was.
+static bool
+_BuildGlobalCoordinateSystems(
+    const UsdPrim& prim,
+    const std::string& rootLocation,
+    FnAttribute::GroupBuilder *coordSysBuilder)
+{
+    bool result = false;
+
+    if (prim.GetPath() != SdfPath::AbsoluteRootPath())
+    {
+        UsdRiStatementsAPI riStatements(prim);
+        SdfPathVector coordSysPaths;
+        if (riStatements.GetModelCoordinateSystems(&coordSysPaths)
+            && !coordSysPaths.empty())
+        {
+            TF_FOR_ALL(itr, coordSysPaths)
+            {
+                if (UsdRiStatementsAPI coordSysStmt =
+                        UsdRiStatementsAPI(prim.GetStage()->GetPrimAtPath(*itr)))
+                {
+                    coordSysBuilder->set(
+                        coordSysStmt.GetCoordinateSystem(),
+                        FnAttribute::StringAttribute(rootLocation + itr->GetString()));
+
+                    result = true;
+                }
+            }
+        }
+    }
+
+    TF_FOR_ALL(itr, prim.GetFilteredChildren(UsdPrimIsModel))
+    {
+        result = result || _BuildGlobalCoordinateSystems(
+            *itr, rootLocation, coordSysBuilder);
+    }
+
+    return result;
+}
+
+// Adds depth levels of nested assemblies below prim, with branching models
+// per level and components at the bottom. Every model declares a coordinate
+// system of its own, and the components also redeclare a shared one.
+void CreateAssembly(const UsdStageRefPtr& stage, const SdfPath& path, int depth, int branching)
+{
+    UsdGeomXform::Define(stage, path);
+    UsdModelAPI(stage->GetPrimAtPath(path))
+        .SetKind(depth > 0 ? KindTokens->assembly : KindTokens->component);
+
+    const std::string name = TfStringReplace(path.GetString().substr(1), "/", "_");
+    UsdRiStatementsAPI(UsdGeomXform::Define(stage, path.AppendChild(TfToken("coordSys"))).GetPrim())
+        .SetCoordinateSystem(name);
+    if (depth == 0)
+    {
+        UsdRiStatementsAPI(
+            UsdGeomXform::Define(stage, path.AppendChild(TfToken("sharedCoordSys"))).GetPrim())
+            .SetCoordinateSystem("shared");
+        return;
+    }
+
+    for (int i = 0; i < branching; ++i)
+    {
+        CreateAssembly(stage, path.AppendChild(TfToken(TfStringPrintf("model%d", i))), depth - 1,
+                       branching);
+    }
+}
+
+void ExpectIndexMatchesRecursion(const UsdStageRefPtr& stage, const UsdPrim& prim)
+{
+    FnAttribute::GroupBuilder gb;
+    _BuildGlobalCoordinateSystems(prim, kRootLocation, &gb);
+    const FnAttribute::GroupAttribute expected = gb.build();
+    const FnAttribute::GroupAttribute actual =
+        UsdKatanaCache::GetInstance().GetModelCoordinateSystems(stage, prim.GetPath(),
+                                                                kRootLocation);
+    EXPECT_TRUE(expected == actual) << prim.GetPath().GetString();
+}
+
+void ExpectIndexMatchesRecursion(const UsdStageRefPtr& stage)
+{
+    size_t numModels = 0;
+    for (const UsdPrim& prim : UsdPrimRange(stage->GetPrimAtPath(SdfPath("/root")),
+                                            UsdPrimIsModel))
+    {
+        ExpectIndexMatchesRecursion(stage, prim);
+        ++numModels;
+    }
+    EXPECT_GT(numModels, 1u);
+}
+
+TEST(CoordSysIndexTest, DeepAssemblyMatchesRecursion)
+{
+    UsdStageRefPtr stage = UsdStage::CreateInMemory("deepAssembly.usda");
+    CreateAssembly(stage, SdfPath("/root"), /* depth */ 6, /* branching */ 3);
+
+    ExpectIndexMatchesRecursion(stage);
+
+    // The walk stops at the first model declaring coordinate systems.
+    FnAttribute::GroupAttribute rootAttr = UsdKatanaCache::GetInstance().GetModelCoordinateSystems(
+        stage, SdfPath("/root"), kRootLocation);
+    EXPECT_EQ(rootAttr.getNumberOfChildren(), 1);
+    FnAttribute::StringAttribute nameAttr = rootAttr.getChildByName("root");
+    ASSERT_TRUE(nameAttr.isValid());
+    EXPECT_EQ(nameAttr.getValue("", false), "/root/root/coordSys");
+
+    // All the coordinate systems of that model are set.
+    const SdfPath componentPath("/root/model2/model2/model2/model2/model2/model2");
+    FnAttribute::GroupAttribute componentAttr =
+        UsdKatanaCache::GetInstance().GetModelCoordinateSystems(stage, componentPath,
+                                                                kRootLocation);
+    EXPECT_EQ(componentAttr.getNumberOfChildren(), 2);
+    FnAttribute::StringAttribute sharedAttr = componentAttr.getChildByName("shared");
+    ASSERT_TRUE(sharedAttr.isValid());
+    EXPECT_EQ(sharedAttr.getValue("", false),
+              kRootLocation + componentPath.GetString() + "/sharedCoordSys");
+
+    // Prims which are not models do not declare coordinate systems.
+    FnAttribute::GroupAttribute leafAttr = UsdKatanaCache::GetInstance().GetModelCoordinateSystems(
+        stage, SdfPath("/root/model0/coordSys"), kRootLocation);
+    EXPECT_EQ(leafAttr.getNumberOfChildren(), 0);
+}
+
+TEST(CoordSysIndexTest, IndexFollowsStageEdits)
+{
+    UsdStageRefPtr stage = UsdStage::CreateInMemory("editedAssembly.usda");
+    CreateAssembly(stage, SdfPath("/root"), /* depth */ 2, /* branching */ 2);
+    ExpectIndexMatchesRecursion(stage);
+
+    // A new coordinate system, and a renamed one.
+    UsdRiStatementsAPI(
+        UsdGeomXform::Define(stage, SdfPath("/root/model1/model0/newCoordSys")).GetPrim())
+        .SetCoordinateSystem("new");
+    UsdRiStatementsAPI(stage->GetPrimAtPath(SdfPath("/root/model0/coordSys")))
+        .SetCoordinateSystem("renamed");
+    ExpectIndexMatchesRecursion(stage);
+
+    FnAttribute::GroupAttribute coordSysAttr =
+        UsdKatanaCache::GetInstance().GetModelCoordinateSystems(
+            stage, SdfPath("/root/model1/model0"), kRootLocation);
+    EXPECT_TRUE(coordSysAttr.getChildByName("new").isValid());
+    EXPECT_FALSE(coordSysAttr.getChildByName("renamed").isValid());
+
+    // Once the models above stop declaring any, the first descendant which
+    // does is used.
+    stage->RemovePrim(SdfPath("/root/coordSys"));
+    stage->RemovePrim(SdfPath("/root/model0/coordSys"));
+    ExpectIndexMatchesRecursion(stage);
+
+    coordSysAttr = UsdKatanaCache::GetInstance().GetModelCoordinateSystems(
+        stage, SdfPath("/root"), kRootLocation);
+    EXPECT_EQ(coordSysAttr.getNumberOfChildren(), 2);
+    EXPECT_TRUE(coordSysAttr.getChildByName("root_model0_model0").isValid());
+    EXPECT_TRUE(coordSysAttr.getChildByName("shared").isValid());
+}
+
+TEST(CoordSysIndexTest, InstancedModels)
+{
+    UsdStageRefPtr stage = UsdStage::CreateInMemory("instancedAssembly.usda");
+    CreateAssembly(stage, SdfPath("/assets/asset"), /* depth */ 2, /* branching */ 2);
+
+    UsdGeomXform::Define(stage, SdfPath("/root"));
+    UsdModelAPI(stage->GetPrimAtPath(SdfPath("/root"))).SetKind(KindTokens->assembly);
+    for (int i = 0; i < 2; ++i)
+    {
+        UsdPrim instance =
+            UsdGeomXform::Define(stage, SdfPath(TfStringPrintf("/root/instance%d", i)))
+                .GetPrim();
+        instance.GetReferences().AddInternalReference(SdfPath("/assets/asset"));
+        instance.SetInstanceable(true);
+    }
+
+    // UsdIn reads the models of instances through their prototype.
+    const UsdPrim prototype = stage->GetPrimAtPath(SdfPath("/root/instance0")).GetPrototype();
+    ASSERT_TRUE(prototype.IsValid());
+    ExpectIndexMatchesRecursion(stage, prototype);
+    for (const UsdPrim& prim : prototype.GetFilteredChildren(UsdPrimIsModel))
+    {
+        for (const UsdPrim& model : UsdPrimRange(prim, UsdPrimIsModel))
+        {
+            ExpectIndexMatchesRecursion(stage, model);
+        }
+    }
+
+    FnAttribute::GroupAttribute coordSysAttr =
+        UsdKatanaCache::GetInstance().GetModelCoordinateSystems(stage, prototype.GetPath(),
+                                                                kRootLocation);
+    EXPECT_EQ(coordSysAttr.getNumberOfChildren(), 1);
+    FnAttribute::StringAttribute nameAttr = coordSysAttr.getChildByName("assets_asset");
+    ASSERT_TRUE(nameAttr.isValid());
+    EXPECT_EQ(nameAttr.getValue("", false),
+              kRootLocation + prototype.GetPath().GetString() + "/coordSys");
+}
+}  // namespace CoordSysIndexTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
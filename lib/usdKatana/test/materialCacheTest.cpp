@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "pxr/pxr.h"
+#include "pxr/usd/sdf/types.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdShade/material.h"
+#include "pxr/usd/usdShade/shader.h"
+
+#include "usdKatana/materialCache.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace MaterialCacheTests
+{
+UsdShadeShader CreateMaterial(const UsdStageRefPtr& stage, const SdfPath& materialPath)
+{
+    UsdShadeMaterial material = UsdShadeMaterial::Define(stage, materialPath);
+    UsdShadeShader shader =
+        UsdShadeShader::Define(stage, materialPath.AppendChild(TfToken("surface")));
+    shader.CreateIdAttr(VtValue(TfToken("FnTestPattern")));
+    shader.CreateInput(TfToken("a"), SdfValueTypeNames->Float).Set(1.0f);
+    material.CreateSurfaceOutput().ConnectToSource(shader.ConnectableAPI(), TfToken("out"));
+    return shader;
+}
+
+std::string ComputeKey(const UsdStageRefPtr& stage, const SdfPath& materialPath)
+{
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.stage = stage;
+    usdInArgsBuilder.rootLocation = "/root";
+    auto usdInArgs = usdInArgsBuilder.build();
+
+    UsdShadeMaterial material(stage->GetPrimAtPath(materialPath));
+    UsdKatanaUsdInPrivateData privateData(material.GetPrim(), usdInArgs);
+    return UsdKatanaMaterialCache::GetInstance().ComputeKey(
+        material, /* flatten */ true, privateData, "/root/materials", "",
+        FnAttribute::Attribute());
+}
+
+void Insert(const UsdStageRefPtr& stage, const std::string& key)
+{
+    UsdKatanaMaterialCache::UsdKatanaAttrMapRefPtr attrs(new UsdKatanaAttrMap);
+    attrs->set("material.key", FnAttribute::StringAttribute(key));
+    attrs->build();
+    UsdKatanaMaterialCache::GetInstance().Insert(key, attrs, stage);
+}
+
+TEST(MaterialCacheTest, EditDropsOnlyAffectedMaterials)
+{
+    UsdKatanaMaterialCache& cache = UsdKatanaMaterialCache::GetInstance();
+    ASSERT_TRUE(cache.IsEnabled());
+
+    UsdStageRefPtr stage = UsdStage::CreateInMemory();
+    const SdfPath editedPath("/root/Looks/edited");
+    const SdfPath keptPath("/root/Looks/kept");
+    UsdShadeShader editedShader = CreateMaterial(stage, editedPath);
+    CreateMaterial(stage, keptPath);
+
+    const std::string editedKey = ComputeKey(stage, editedPath);
+    const std::string keptKey = ComputeKey(stage, keptPath);
+    EXPECT_NE(editedKey, keptKey);
+    EXPECT_EQ(ComputeKey(stage, keptPath), keptKey);
+    Insert(stage, editedKey);
+    Insert(stage, keptKey);
+
+    editedShader.GetInput(TfToken("a")).Set(2.0f);
+
+    EXPECT_FALSE(cache.Get(editedKey));
+    EXPECT_TRUE(cache.Get(keptKey));
+    EXPECT_EQ(ComputeKey(stage, keptPath), keptKey);
+    EXPECT_NE(ComputeKey(stage, editedPath), editedKey);
+
+    // New prims below a material invalidate it as well.
+    UsdShadeShader::Define(stage, keptPath.AppendChild(TfToken("extra")));
+    EXPECT_FALSE(cache.Get(keptKey));
+
+    cache.Clear();
+}
+
+}  // namespace MaterialCacheTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
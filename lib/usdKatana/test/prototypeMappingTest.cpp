@@ -0,0 +1,372 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "pxr/base/tf/stringUtils.h"
+#include "pxr/pxr.h"
+#include "pxr/usd/sdf/layer.h"
+#include "pxr/usd/usd/modelAPI.h"
+#include "pxr/usd/usd/primFlags.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usd/variantSets.h"
+
+#include <FnAttribute/FnGroupBuilder.h>
+
+#include "usdKatana/prototypeMappingCache.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace PrototypeMappingTests
+{
+// The uncached walk that UsdKatanaPrototypeMappingCache replaces, as it was.
+typedef std::map<std::string, std::string> StringMap;
+typedef std::vector<std::string> StringVec;
+typedef std::map<std::string, StringVec> StringVecMap;
+
+void _walkForPrototypes(const UsdPrim& prim,
+                        StringMap& prototypeToKey,
+                        StringVecMap& keyToPrototypes)
+{
+    if (prim.IsInstance())
+    {
+        const UsdPrim prototype = prim.GetPrototype();
+
+        if (prototype.IsValid())
+        {
+            std::string prototypePath = prototype.GetPath().GetString();
+
+            if (prototypeToKey.find(prototypePath) == prototypeToKey.end())
+            {
+                std::string assetName;
+                UsdModelAPI(prim).GetAssetName(&assetName);
+                if (assetName.empty())
+                {
+                    assetName = "prototype";
+                }
+
+                std::ostringstream buffer;
+                buffer << assetName << "/variants";
+
+                UsdVariantSets variantSets = prim.GetVariantSets();
+
+                std::vector<std::string> names;
+                variantSets.GetNames(&names);
+                TF_FOR_ALL(I, names)
+                {
+                    const std::string & variantName = (*I);
+                    std::string variantValue =
+                            variantSets.GetVariantSet(
+                                    variantName).GetVariantSelection();
+                    buffer << "__" << variantName << "_" << variantValue;
+                }
+
+                std::string key = buffer.str();
+                prototypeToKey[prototypePath] = key;
+                if (std::find(keyToPrototypes[key].begin(),
+                              keyToPrototypes[key].end(),
+                              prototypePath) == keyToPrototypes[key].end())
+                {
+                    keyToPrototypes[key].push_back(prototypePath);
+                }
+
+                _walkForPrototypes(prototype, prototypeToKey, keyToPrototypes);
+            }
+        }
+    }
+
+
+    TF_FOR_ALL(childIter, prim.GetFilteredChildren(
+            UsdPrimIsDefined && UsdPrimIsActive && !UsdPrimIsAbstract))
+    {
+        const UsdPrim& child = *childIter;
+        _walkForPrototypes(child, prototypeToKey, keyToPrototypes);
+    }
+}
+
+FnAttribute::GroupAttribute BuildInstancePrototypeMapping(const UsdStageRefPtr& stage,
+                                                    const SdfPath& rootPath)
+{
+    StringMap prototypeToKey;
+    StringVecMap keyToPrototypes;
+    _walkForPrototypes(stage->GetPrimAtPath(rootPath), prototypeToKey, keyToPrototypes);
+
+    FnAttribute::GroupBuilder gb;
+    TF_FOR_ALL(I, keyToPrototypes)
+    {
+        const std::string & key = (*I).first;
+        const StringVec& prototypes = (*I).second;
+
+        size_t i = 0;
+
+        TF_FOR_ALL(J, prototypes)
+        {
+            const std::string& prototype = (*J);
+
+            std::ostringstream buffer;
+
+            buffer << key << "/m" << i;
+            gb.set(FnAttribute::DelimiterEncode(prototype), FnAttribute::StringAttribute(buffer.str()));
+
+            ++i;
+        }
+    }
+
+
+    return gb.build();
+}
+
+SdfLayerRefPtr CreateLayer(const std::string& contents)
+{
+    SdfLayerRefPtr layer = SdfLayer::CreateAnonymous(".usda");
+    EXPECT_TRUE(layer->ImportFromString("#usda 1.0\n" + contents));
+    return layer;
+}
+
+// Two rock assets of the same name, so that their prototypes are told apart
+// by naming order only, a tree asset with variants, a forest nesting
+// instances of both, and a set payload instancing all of them.
+class PrototypeMappingTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const std::string rock = R"(
+(
+    defaultPrim = "rock"
+)
+def Xform "rock" (
+    kind = "component"
+    assetInfo = {
+        string name = "rock"
+    }
+)
+{
+    def %s "geo"
+    {
+    }
+}
+)";
+        _rockA = CreateLayer(TfStringPrintf(rock.c_str(), "Cube"));
+        _rockB = CreateLayer(TfStringPrintf(rock.c_str(), "Sphere"));
+        _tree = CreateLayer(R"(
+(
+    defaultPrim = "tree"
+)
+def Xform "tree" (
+    kind = "component"
+    assetInfo = {
+        string name = "tree"
+    }
+    variants = {
+        string color = "red"
+    }
+    prepend variantSets = "color"
+)
+{
+    variantSet "color" = {
+        "green" {
+            def Cube "green"
+            {
+            }
+        }
+        "red" {
+            def Cube "red"
+            {
+            }
+        }
+    }
+}
+)");
+        _forest = CreateLayer(TfStringPrintf(R"(
+(
+    defaultPrim = "forest"
+)
+def Xform "forest" (
+    kind = "assembly"
+    assetInfo = {
+        string name = "forest"
+    }
+)
+{
+    def "tree1" (
+        instanceable = true
+        prepend references = @%s@
+        variants = {
+            string color = "green"
+        }
+    )
+    {
+    }
+
+    def "rock1" (
+        instanceable = true
+        prepend references = @%s@
+    )
+    {
+    }
+}
+)",
+                                             _tree->GetIdentifier().c_str(),
+                                             _rockA->GetIdentifier().c_str()));
+        _set = CreateLayer(TfStringPrintf(R"(
+(
+    defaultPrim = "set"
+)
+def Xform "set"
+{
+    def Xform "group"
+    {
+        def "forest1" (
+            instanceable = true
+            prepend references = @%s@
+        )
+        {
+        }
+
+        def "rockB1" (
+            instanceable = true
+            prepend references = @%s@
+        )
+        {
+        }
+    }
+
+    def "rockA1" (
+        instanceable = true
+        prepend references = @%s@
+    )
+    {
+    }
+}
+)",
+                                          _forest->GetIdentifier().c_str(),
+                                          _rockB->GetIdentifier().c_str(),
+                                          _rockA->GetIdentifier().c_str()));
+        _root = CreateLayer(TfStringPrintf(R"(
+def Xform "World"
+{
+    def Xform "props"
+    {
+        def "rockB2" (
+            instanceable = true
+            prepend references = @%s@
+        )
+        {
+        }
+
+        def "tree1" (
+            instanceable = true
+            prepend references = @%s@
+        )
+        {
+        }
+
+        def "tree2" (
+            instanceable = true
+            prepend references = @%s@
+            variants = {
+                string color = "green"
+            }
+        )
+        {
+        }
+    }
+
+    def "setA" (
+        prepend payload = @%s@
+    )
+    {
+    }
+
+    def "rockA2" (
+        instanceable = true
+        prepend references = @%s@
+    )
+    {
+    }
+}
+)",
+                                           _rockB->GetIdentifier().c_str(),
+                                           _tree->GetIdentifier().c_str(),
+                                           _tree->GetIdentifier().c_str(),
+                                           _set->GetIdentifier().c_str(),
+                                           _rockA->GetIdentifier().c_str()));
+        _stage = UsdStage::Open(_root);
+        ASSERT_TRUE(_stage);
+    }
+
+    // Compare the cached mapping of each of paths with the baseline walk.
+    void ExpectBaselineMappings(UsdKatanaPrototypeMappingCache& cache,
+                                const std::vector<std::string>& paths)
+    {
+        for (const std::string& path : paths)
+        {
+            const FnAttribute::GroupAttribute expected =
+                BuildInstancePrototypeMapping(_stage, SdfPath(path));
+            EXPECT_EQ(cache.GetMapping(SdfPath(path)).getXML(), expected.getXML()) << path;
+        }
+    }
+
+    SdfLayerRefPtr _rockA;
+    SdfLayerRefPtr _rockB;
+    SdfLayerRefPtr _tree;
+    SdfLayerRefPtr _forest;
+    SdfLayerRefPtr _set;
+    SdfLayerRefPtr _root;
+    UsdStageRefPtr _stage;
+};
+
+const std::vector<std::string> kPaths = {
+    "/", "/World", "/World/props", "/World/setA", "/World/setA/group", "/World/rockA2"};
+
+TEST_F(PrototypeMappingTest, MatchesBaselineWalk)
+{
+    UsdKatanaPrototypeMappingCache cache(_stage);
+    ExpectBaselineMappings(cache, kPaths);
+
+    // Subtree queries are answered from the mapping built for the stage, in
+    // any order.
+    ExpectBaselineMappings(cache, {"/World/setA/group", "/World", "/"});
+
+    // The two rock prototypes share a name, and are numbered in traversal
+    // order.
+    const FnAttribute::GroupAttribute mapping = cache.GetMapping(SdfPath::AbsoluteRootPath());
+    std::vector<std::string> names;
+    for (int64_t i = 0; i < mapping.getNumberOfChildren(); ++i)
+    {
+        names.push_back(FnAttribute::StringAttribute(mapping.getChildByIndex(i)).getValue());
+    }
+    EXPECT_NE(std::find(names.begin(), names.end(), "rock/variants/m1"), names.end());
+    EXPECT_NE(std::find(names.begin(), names.end(), "tree/variants__color_green/m0"),
+              names.end());
+}
+
+TEST_F(PrototypeMappingTest, ResyncInvalidates)
+{
+    UsdKatanaPrototypeMappingCache cache(_stage);
+    ExpectBaselineMappings(cache, kPaths);
+
+    _stage->Unload(SdfPath("/World/setA"));
+    ExpectBaselineMappings(cache, kPaths);
+
+    _stage->Load(SdfPath("/World/setA"));
+    ExpectBaselineMappings(cache, kPaths);
+
+    // A new instance outside of any payload.
+    UsdPrim rock = _stage->DefinePrim(SdfPath("/World/props/rockA3"));
+    rock.GetReferences().AddReference(_rockA->GetIdentifier());
+    rock.SetInstanceable(true);
+    ExpectBaselineMappings(cache, kPaths);
+
+    // Deactivating the first instance of a prototype renames the prototypes.
+    _stage->GetPrimAtPath(SdfPath("/World/props/rockB2")).SetActive(false);
+    ExpectBaselineMappings(cache, kPaths);
+}
+
+}  // namespace PrototypeMappingTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
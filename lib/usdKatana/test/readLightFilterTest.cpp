@@ -70,5 +70,27 @@ TEST_F(ReadLightFilterTest, ReadType)
     ASSERT_EQ(typeAttr.getValue("", true), "light filter");
 }
 
+TEST_F(ReadLightFilterTest, IsLightFilter)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/lightfilter1.usda");
+    const SdfPath gafferPath("/root/lgt/gaffer");
+    const UsdTimeCode time = UsdTimeCode::Default();
+
+    UsdPrim typedPrim =
+        stage->GetPrimAtPath(gafferPath.AppendChild(TfToken("ShaderIdLightFilter")));
+    ASSERT_TRUE(static_cast<bool>(typedPrim));
+    EXPECT_TRUE(UsdKatanaUtils::IsLightFilter(typedPrim, time));
+
+    // Untyped prims are not rejected by type if they author a shader id.
+    UsdPrim untypedPrim =
+        stage->GetPrimAtPath(gafferPath.AppendChild(TfToken("UntypedLightFilter")));
+    ASSERT_TRUE(static_cast<bool>(untypedPrim));
+    EXPECT_TRUE(UsdKatanaUtils::IsLightFilter(untypedPrim, time));
+
+    EXPECT_FALSE(UsdKatanaUtils::IsLightFilter(
+        stage->GetPrimAtPath(gafferPath.AppendChild(TfToken("Untyped"))), time));
+    EXPECT_FALSE(UsdKatanaUtils::IsLightFilter(stage->GetPrimAtPath(gafferPath), time));
+}
+
 }  // namespace ReadLightFilterTests
 PXR_NAMESPACE_CLOSE_SCOPE
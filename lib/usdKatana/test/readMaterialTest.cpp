@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "pxr/base/tf/stringUtils.h"
+#include "pxr/pxr.h"
+#include "pxr/usd/sdf/types.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdShade/material.h"
+#include "pxr/usd/usdShade/shader.h"
+
+#include "usdKatana/attrMap.h"
+#include "usdKatana/readMaterial.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace ReadMaterialTests
+{
+// Builds a material whose surface is a network of numNodes shaders, where
+// every shader is connected to the next two shaders in the chain.
+UsdShadeMaterial CreateSyntheticNetwork(const UsdStageRefPtr& stage, int numNodes)
+{
+    const SdfPath materialPath("/root/materials/network");
+    UsdShadeMaterial material = UsdShadeMaterial::Define(stage, materialPath);
+
+    const TfToken outName("out");
+    std::vector<UsdShadeShader> shaders;
+    shaders.reserve(numNodes);
+    for (int i = 0; i < numNodes; ++i)
+    {
+        UsdShadeShader shader = UsdShadeShader::Define(
+            stage, materialPath.AppendChild(TfToken(TfStringPrintf("node%d", i))));
+        shader.CreateIdAttr(VtValue(TfToken("FnTestPattern")));
+        shader.CreateOutput(outName, SdfValueTypeNames->Float);
+        shaders.push_back(shader);
+    }
+    for (int i = 0; i < numNodes; ++i)
+    {
+        if (i + 1 < numNodes)
+        {
+            shaders[i]
+                .CreateInput(TfToken("a"), SdfValueTypeNames->Float)
+                .ConnectToSource(shaders[i + 1].ConnectableAPI(), outName);
+        }
+        if (i + 2 < numNodes)
+        {
+            shaders[i]
+                .CreateInput(TfToken("b"), SdfValueTypeNames->Float)
+                .ConnectToSource(shaders[i + 2].ConnectableAPI(), outName);
+        }
+    }
+    material.CreateSurfaceOutput().ConnectToSource(shaders.front().ConnectableAPI(), outName);
+    return material;
+}
+
+TEST(ReadMaterialTest, ReadLargeShadingNetwork)
+{
+    const int numNodes = 1000;
+    UsdStageRefPtr stage = UsdStage::CreateInMemory("syntheticNetwork.usda");
+    UsdShadeMaterial material = CreateSyntheticNetwork(stage, numNodes);
+    ASSERT_TRUE(static_cast<bool>(material));
+
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.stage = stage;
+    usdInArgsBuilder.rootLocation = "/root";
+    usdInArgsBuilder.isolatePath = "";
+    usdInArgsBuilder.sessionLocation = "";
+    auto usdInArgs = usdInArgsBuilder.build();
+
+    UsdKatanaUsdInPrivateData privateData(material.GetPrim(), usdInArgs);
+    UsdKatanaAttrMap attrs;
+
+    const auto start = std::chrono::steady_clock::now();
+    UsdKatanaReadMaterial(material, /* flatten */ true, privateData, attrs);
+    FnAttribute::GroupAttribute result = attrs.build();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    ::testing::Test::RecordProperty("translationTimeMs", static_cast<int>(elapsed.count()));
+
+    FnAttribute::GroupAttribute nodesAttr = result.getChildByName("material.nodes");
+    ASSERT_TRUE(nodesAttr.isValid());
+    ASSERT_EQ(nodesAttr.getNumberOfChildren(), numNodes);
+
+    // Every shader is created exactly once, with its connections intact.
+    FnAttribute::StringAttribute connectionAttr =
+        nodesAttr.getChildByName("node0.connections.b");
+    ASSERT_TRUE(connectionAttr.isValid());
+    ASSERT_EQ(connectionAttr.getValue("", false), "out@node2");
+
+    FnAttribute::StringAttribute terminalAttr =
+        result.getChildByName("material.terminals.usdSurface");
+    ASSERT_TRUE(terminalAttr.isValid());
+    ASSERT_EQ(terminalAttr.getValue("", false), "node0");
+}
+}  // namespace ReadMaterialTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
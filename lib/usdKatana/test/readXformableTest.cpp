@@ -0,0 +1,185 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pxr/base/gf/math.h"
+#include "pxr/base/gf/matrix4d.h"
+#include "pxr/pxr.h"
+#include "pxr/usd/usd/prim.h"
+#include "pxr/usd/usd/stage.h"
+#include "pxr/usd/usdGeom/xformable.h"
+
+#include "usdKatana/attrMap.h"
+#include "usdKatana/readXformable.h"
+#include "usdKatana/usdInArgs.h"
+#include "usdKatana/usdInPrivateData.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace ReadXformableTests
+{
+const std::vector<std::string> kPrimPaths = {
+    "/root/animated",
+    "/root/animated/mixed",
+    "/root/animated/mixed/reset",
+    "/root/animated/mixed/reset/static",
+};
+
+UsdKatanaUsdInArgsRefPtr CreateUsdInArgs(const UsdStageRefPtr& stage,
+                                         bool composeXformOpsInKatana)
+{
+    ArgsBuilder usdInArgsBuilder;
+    usdInArgsBuilder.stage = stage;
+    usdInArgsBuilder.rootLocation = "/root";
+    usdInArgsBuilder.isolatePath = "";
+    usdInArgsBuilder.sessionLocation = "";
+    usdInArgsBuilder.currentTime = 1.0;
+    usdInArgsBuilder.shutterOpen = 0.0;
+    usdInArgsBuilder.shutterClose = 1.0;
+    usdInArgsBuilder.motionSampleTimes = {0.0, 1.0};
+    usdInArgsBuilder.composeXformOpsInKatana = composeXformOpsInKatana;
+    return usdInArgsBuilder.build();
+}
+
+FnAttribute::GroupAttribute ReadXformAttr(const UsdPrim& prim,
+                                          const UsdKatanaUsdInPrivateData& data)
+{
+    UsdKatanaAttrMap attrs;
+    UsdKatanaReadXformable(UsdGeomXformable(prim), data, attrs);
+    return attrs.build().getChildByName("xform");
+}
+
+GfMatrix4d GetMatrix(const FnAttribute::DoubleAttribute& matrixAttr, float sampleTime)
+{
+    FnAttribute::DoubleConstVector values = matrixAttr.getNearestSample(sampleTime);
+    GfMatrix4d matrix(1.0);
+    if (values.size() == 16)
+    {
+        std::copy(values.begin(), values.end(), matrix.data());
+    }
+    return matrix;
+}
+
+// Reads the xform of each of kPrimPaths, and composes their world-space
+// matrices at each of sampleTimes, the way Katana would.
+std::vector<std::vector<GfMatrix4d>> ComputeWorldMatrices(const UsdStageRefPtr& stage,
+                                                          bool composeXformOpsInKatana,
+                                                          const std::vector<float>& sampleTimes)
+{
+    UsdKatanaUsdInArgsRefPtr usdInArgs = CreateUsdInArgs(stage, composeXformOpsInKatana);
+    UsdKatanaUsdInPrivateData rootData(stage->GetPrimAtPath(SdfPath("/root")), usdInArgs);
+
+    std::vector<std::vector<GfMatrix4d>> result;
+    std::vector<GfMatrix4d> parentWorld(sampleTimes.size(), GfMatrix4d(1.0));
+    std::vector<std::unique_ptr<UsdKatanaUsdInPrivateData>> datas;
+    const UsdKatanaUsdInPrivateData* parentData = &rootData;
+    for (const std::string& primPath : kPrimPaths)
+    {
+        UsdPrim prim = stage->GetPrimAtPath(SdfPath(primPath));
+        datas.emplace_back(new UsdKatanaUsdInPrivateData(prim, usdInArgs, parentData));
+        parentData = datas.back().get();
+
+        FnAttribute::GroupAttribute xformAttr = ReadXformAttr(prim, *parentData);
+        EXPECT_TRUE(xformAttr.isValid()) << primPath;
+
+        const bool resetsXformStack = xformAttr.getChildByName("origin").isValid();
+        const FnAttribute::DoubleAttribute matrixAttr = xformAttr.getChildByName("matrix");
+        EXPECT_TRUE(matrixAttr.isValid()) << primPath;
+
+        std::vector<GfMatrix4d> world(sampleTimes.size());
+        for (size_t i = 0; i < sampleTimes.size(); ++i)
+        {
+            const GfMatrix4d local = GetMatrix(matrixAttr, sampleTimes[i]);
+            world[i] = resetsXformStack ? local : local * parentWorld[i];
+        }
+        result.push_back(world);
+        parentWorld = world;
+    }
+    return result;
+}
+
+void ExpectMatricesClose(const GfMatrix4d& expected,
+                         const GfMatrix4d& actual,
+                         const std::string& primPath,
+                         float sampleTime)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            EXPECT_TRUE(GfIsClose(expected[i][j], actual[i][j], 1e-6))
+                << primPath << " at shutter time " << sampleTime << ": expected " << expected
+                << ", got " << actual;
+        }
+    }
+}
+
+TEST(ReadXformableTest, LocalTransformationMatchesKatanaComposition)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/xform1.usda");
+    ASSERT_TRUE(static_cast<bool>(stage));
+
+    const std::vector<float> sampleTimes = {0.0f, 1.0f};
+    const std::vector<std::vector<GfMatrix4d>> composedInKatana =
+        ComputeWorldMatrices(stage, /* composeXformOpsInKatana */ true, sampleTimes);
+    const std::vector<std::vector<GfMatrix4d>> localTransformation =
+        ComputeWorldMatrices(stage, /* composeXformOpsInKatana */ false, sampleTimes);
+    ASSERT_EQ(composedInKatana.size(), kPrimPaths.size());
+    ASSERT_EQ(localTransformation.size(), kPrimPaths.size());
+
+    for (size_t p = 0; p < kPrimPaths.size(); ++p)
+    {
+        const UsdGeomXformable xformable(stage->GetPrimAtPath(SdfPath(kPrimPaths[p])));
+        for (size_t i = 0; i < sampleTimes.size(); ++i)
+        {
+            ExpectMatricesClose(composedInKatana[p][i], localTransformation[p][i], kPrimPaths[p],
+                                sampleTimes[i]);
+
+            // Both agree with USD's own world-space transform.
+            ExpectMatricesClose(xformable.ComputeLocalToWorldTransform(1.0 + sampleTimes[i]),
+                                localTransformation[p][i], kPrimPaths[p], sampleTimes[i]);
+        }
+    }
+}
+
+TEST(ReadXformableTest, LocalTransformationSamples)
+{
+    UsdStageRefPtr stage = UsdStage::Open("test/xform1.usda");
+    ASSERT_TRUE(static_cast<bool>(stage));
+    UsdKatanaUsdInArgsRefPtr usdInArgs =
+        CreateUsdInArgs(stage, /* composeXformOpsInKatana */ false);
+
+    // Animated ops are read once per motion sample.
+    UsdPrim mixedPrim = stage->GetPrimAtPath(SdfPath("/root/animated/mixed"));
+    UsdKatanaUsdInPrivateData mixedData(mixedPrim, usdInArgs);
+    FnAttribute::GroupAttribute mixedAttr = ReadXformAttr(mixedPrim, mixedData);
+    ASSERT_TRUE(mixedAttr.isValid());
+    FnAttribute::DoubleAttribute mixedMatrixAttr = mixedAttr.getChildByName("matrix");
+    ASSERT_TRUE(mixedMatrixAttr.isValid());
+    EXPECT_EQ(mixedMatrixAttr.getNumberOfTimeSamples(), 2);
+    EXPECT_EQ(mixedMatrixAttr.getTupleSize(), 16);
+    EXPECT_FALSE(mixedAttr.getChildByName("origin").isValid());
+
+    // Static stacks are written as a single sample.
+    UsdPrim staticPrim = stage->GetPrimAtPath(SdfPath("/root/animated/mixed/reset/static"));
+    UsdKatanaUsdInPrivateData staticData(staticPrim, usdInArgs);
+    FnAttribute::GroupAttribute staticAttr = ReadXformAttr(staticPrim, staticData);
+    ASSERT_TRUE(staticAttr.isValid());
+    FnAttribute::DoubleAttribute staticMatrixAttr = staticAttr.getChildByName("matrix");
+    ASSERT_TRUE(staticMatrixAttr.isValid());
+    EXPECT_EQ(staticMatrixAttr.getNumberOfTimeSamples(), 1);
+    EXPECT_EQ(staticMatrixAttr.getSampleTime(0), 0.0f);
+
+    // Resetting the xform stack is preserved.
+    UsdPrim resetPrim = stage->GetPrimAtPath(SdfPath("/root/animated/mixed/reset"));
+    UsdKatanaUsdInPrivateData resetData(resetPrim, usdInArgs);
+    FnAttribute::GroupAttribute resetAttr = ReadXformAttr(resetPrim, resetData);
+    ASSERT_TRUE(resetAttr.isValid());
+    EXPECT_TRUE(resetAttr.getChildByName("origin").isValid());
+}
+}  // namespace ReadXformableTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,43 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "pxr/pxr.h"
+#include "pxr/usd/sdf/layer.h"
+
+#include "usdKatana/cache.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace SessionLayerCacheTests
+{
+const std::string kEmptySession = FnAttribute::GroupAttribute(true).getXML();
+
+TEST(SessionLayerCacheTest, EvictionKeepsLayersInUse)
+{
+    UsdKatanaCache& cache = UsdKatanaCache::GetInstance();
+    cache.Flush();
+    cache.SetSessionLayerLimits(1, 0);
+
+    // Held by the test, so it must survive going over the limit.
+    const SdfLayerRefPtr heldLayer = cache.FindOrCreateSessionLayer(kEmptySession, "/held");
+    ASSERT_TRUE(heldLayer);
+    cache.FindOrCreateSessionLayer(kEmptySession, "/released");
+    cache.FindOrCreateSessionLayer(kEmptySession, "/other");
+
+    const size_t misses = cache.GetStats().sessionLayerMisses;
+    EXPECT_EQ(cache.FindOrCreateSessionLayer(kEmptySession, "/held"), heldLayer);
+    EXPECT_EQ(cache.GetStats().sessionLayerMisses, misses);
+
+    // Released layers are evicted, down to the most recently used one.
+    EXPECT_GT(cache.GetStats().sessionLayerEvictions, 0u);
+    cache.FindOrCreateSessionLayer(kEmptySession, "/released");
+    EXPECT_EQ(cache.GetStats().sessionLayerMisses, misses + 1);
+
+    cache.SetSessionLayerLimits(0, 0);
+    cache.Flush();
+}
+
+}  // namespace SessionLayerCacheTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
@@ -0,0 +1,896 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <pxr/base/arch/demangle.h>
+#include <pxr/base/gf/half.h>
+#include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/gf/vec2d.h>
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec3d.h>
+#include <pxr/base/gf/vec3f.h>
+#include <pxr/base/gf/vec3h.h>
+#include <pxr/base/gf/vec4d.h>
+#include <pxr/base/gf/vec4f.h>
+#include <pxr/base/tf/diagnostic.h>
+#include <pxr/base/tf/iterator.h>
+#include <pxr/base/tf/stringUtils.h>
+#include <pxr/base/tf/token.h>
+#include <pxr/base/vt/array.h>
+#include <pxr/base/vt/value.h>
+#include <pxr/pxr.h>
+#include <pxr/usd/sdf/assetPath.h>
+#include <pxr/usd/sdf/types.h>
+
+#include <FnAttribute/FnAttribute.h>
+#include <FnAttribute/FnDataBuilder.h>
+
+#include "usdKatana/utils.h"
+#include "usdKatana/valueConverterRegistry.h"
+#include "vtKatana/array.h"
+#include "vtKatana/value.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace FnKat = Foundry::Katana;
+
+namespace ValueConverterRegistryTests
+{
+// The if/else chains that UsdKatanaUtils used before the registry was
+// introduced, kept verbatim as the reference for the conversions.
+
+// Only resolved asset paths are used in these tests.
+static const std::string _ResolveAssetPath(const SdfAssetPath& assetPath)
+{
+    return assetPath.GetResolvedPath();
+}
+
+FnKat::Attribute LegacyConvertVtValueToKatAttr(const VtValue& val, bool asShaderParam)
+{
+    if (val.IsHolding<bool>()) {
+        return FnKat::IntAttribute(int(val.UncheckedGet<bool>()));
+    }
+    if (val.IsHolding<int>()) {
+        return FnKat::IntAttribute(val.UncheckedGet<int>());
+    }
+    if (val.IsHolding<uint32_t>()) {
+        // Lossy translation of 32bit unsigned int to int
+        return FnKat::IntAttribute(static_cast<int>(val.UncheckedGet<uint32_t>()));
+    }
+    if (val.IsHolding<float>()) {
+        return FnKat::FloatAttribute(val.UncheckedGet<float>());
+    }
+    if (val.IsHolding<double>()) {
+        return FnKat::DoubleAttribute(val.UncheckedGet<double>());
+    }
+    if (val.IsHolding<std::string>()) {
+        if (val.UncheckedGet<std::string>() == "_NO_VALUE_") {
+            return FnKat::NullAttribute();
+        }
+        else {
+            return FnKat::StringAttribute(val.UncheckedGet<std::string>());
+        }
+    }
+    if (val.IsHolding<SdfAssetPath>()) {
+        const SdfAssetPath& assetPath(val.UncheckedGet<SdfAssetPath>());
+        return FnKat::StringAttribute(_ResolveAssetPath(assetPath));
+    }
+    if (val.IsHolding<TfToken>()) {
+        const TfToken &myVal = val.UncheckedGet<TfToken>();
+        return FnKat::StringAttribute(myVal.GetString());
+    }
+
+    // Compound types require special handling.  Because they do not
+    // correspond 1:1 to Fn attribute types, we must describe the
+    // type as a separate attribute.
+    FnKat::Attribute typeAttr;
+    FnKat::Attribute valueAttr;
+
+    if (val.IsHolding<VtArray<std::string> >()) {
+        const auto& array = val.UncheckedGet<VtArray<std::string> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        typeAttr = FnKat::StringAttribute(
+            TfStringPrintf("string [%zu]", array.size()));
+    }
+
+    else if (val.IsHolding<VtArray<TfToken> >()) {
+        const auto& array = val.UncheckedGet<VtArray<TfToken> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        typeAttr = FnKat::StringAttribute(
+            TfStringPrintf("string [%zu]", array.size()));
+    }
+
+    else if (val.IsHolding<VtArray<int> >()) {
+        const VtArray<int> array = val.UncheckedGet<VtArray<int> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        typeAttr = FnKat::StringAttribute(
+            TfStringPrintf("int [%zu]", array.size()));
+    }
+
+    else if (val.IsHolding<VtArray<unsigned> >()) {
+        // Lossy translation of array<unsigned> to array<int>
+        // No warning is printed as they obscure more important warnings
+        const VtArray<unsigned> array = val.Get<VtArray<unsigned> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        typeAttr = FnKat::StringAttribute(
+            TfStringPrintf("unsigned [%zu]", array.size()));
+    }
+
+    else if (val.IsHolding<VtArray<long> >()) {
+        // Lossy translation of array<long> to array<int>
+        // No warning is printed as they obscure more important warnings
+        const VtArray<long> array = val.Get<VtArray<long> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        typeAttr = FnKat::StringAttribute(
+            TfStringPrintf("long [%zu]", array.size()));
+    }
+
+    else if (val.IsHolding<VtArray<float> >()) {
+        const VtArray<float> array = val.UncheckedGet<VtArray<float> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        typeAttr = FnKat::StringAttribute(
+            TfStringPrintf("float [%zu]", array.size()));
+    }
+    else if (val.IsHolding<VtArray<double> >()) {
+        const VtArray<double> array = val.UncheckedGet<VtArray<double> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        typeAttr = FnKat::StringAttribute(
+            TfStringPrintf("double [%zu]", array.size()));
+    }
+
+    // XXX: Should matrices also be brought in as doubles?
+    // What implications does this have? xform.matrix is handled explicitly as
+    // a double, and apparently we don't use GfMatrix4f.
+    // Shader parameter floats might expect a float matrix?
+    if (val.IsHolding<VtArray<GfMatrix4d> >()) {
+        const VtArray<GfMatrix4d> rawVal = val.UncheckedGet<VtArray<GfMatrix4d> >();
+        std::vector<float> vec;
+        TF_FOR_ALL(mat, rawVal) {
+             for (int i=0; i < 4; ++i) {
+                 for (int j=0; j < 4; ++j) {
+                     vec.push_back( static_cast<float>((*mat)[i][j]) );
+                 }
+             }
+         }
+         FnKat::FloatBuilder builder(/* tupleSize = */ 16);
+         builder.set(vec);
+         valueAttr = builder.build();
+         typeAttr = FnKat::StringAttribute(
+             TfStringPrintf("matrix [%zu]", rawVal.size()));
+    }
+
+    // GfVec2f
+    else if (val.IsHolding<GfVec2f>()) {
+        const GfVec2f rawVal = val.UncheckedGet<GfVec2f>();
+        valueAttr = VtKatanaCopy(rawVal);
+        typeAttr = FnKat::StringAttribute("float [2]");
+    }
+
+    // GfVec2d
+    else if (val.IsHolding<GfVec2d>()) {
+        const GfVec2d rawVal = val.UncheckedGet<GfVec2d>();
+        valueAttr = VtKatanaCopy(rawVal);
+        typeAttr = FnKat::StringAttribute("double [2]");
+    }
+
+    // GfVec3f
+    else if (val.IsHolding<GfVec3f>()) {
+        const GfVec3f rawVal = val.UncheckedGet<GfVec3f>();
+        valueAttr = VtKatanaCopy(rawVal);
+        typeAttr = FnKat::StringAttribute("float [3]");
+    }
+
+    // GfVec3d
+    else if (val.IsHolding<GfVec3d>()) {
+        const GfVec3d rawVal = val.UncheckedGet<GfVec3d>();
+        valueAttr = VtKatanaCopy(rawVal);
+        typeAttr = FnKat::StringAttribute("double [3]");
+    }
+
+    // GfVec4f
+    else if (val.IsHolding<GfVec4f>()) {
+        const GfVec4f rawVal = val.UncheckedGet<GfVec4f>();
+        valueAttr = VtKatanaCopy(rawVal);
+        typeAttr = FnKat::StringAttribute("float [4]");
+    }
+
+    // GfVec4d
+    else if (val.IsHolding<GfVec4d>()) {
+        const GfVec4d rawVal = val.UncheckedGet<GfVec4d>();
+        valueAttr = VtKatanaCopy(rawVal);
+        typeAttr = FnKat::StringAttribute("double [4]");
+    }
+
+    // GfMatrix4d
+    // XXX: Should matrices also be brought in as doubles?
+    // What implications does this have? xform.matrix is handled explicitly as
+    // a double, and apparently we don't use GfMatrix4f.
+    // Shader parameter floats might expect a float matrix?
+    else if (val.IsHolding<GfMatrix4d>()) {
+        const GfMatrix4d rawVal = val.UncheckedGet<GfMatrix4d>();
+        FnKat::FloatBuilder builder(/* tupleSize = */ 16);
+        std::vector<float> vec;
+        vec.resize(16);
+        for (int i=0; i < 4; ++i) {
+            for (int j=0; j < 4; ++j) {
+                vec[i*4+j] = static_cast<float>(rawVal[i][j]);
+            }
+        }
+        builder.set(vec);
+        typeAttr = FnKat::StringAttribute("matrix [1]");
+        valueAttr = builder.build();
+    }
+
+    // TODO: support complex types such as primvars
+    // VtArray<GfVec4f>
+    else if (val.IsHolding<VtArray<GfVec4f> >()) {
+        const VtArray<GfVec4f> array = val.UncheckedGet<VtArray<GfVec4f> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        // NOTE: needs typeAttr set?
+    }
+
+    // VtArray<GfVec3f>
+    else if (val.IsHolding<VtArray<GfVec3f> >()) {
+        const VtArray<GfVec3f> array = val.UncheckedGet<VtArray<GfVec3f> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        // NOTE: needs typeAttr set?
+    }
+
+    // VtArray<GfVec2f>
+    else if (val.IsHolding<VtArray<GfVec2f> >()) {
+        const VtArray<GfVec2f> array = val.UncheckedGet<VtArray<GfVec2f> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        // NOTE: needs typeAttr set?
+    }
+
+    // VtArray<GfVec4d>
+    else if (val.IsHolding<VtArray<GfVec4d> >()) {
+        const VtArray<GfVec4d> array = val.UncheckedGet<VtArray<GfVec4d> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        // NOTE: needs typeAttr set?
+    }
+
+    // VtArray<GfVec3d>
+    else if (val.IsHolding<VtArray<GfVec3d> >()) {
+        const VtArray<GfVec3d> array = val.UncheckedGet<VtArray<GfVec3d> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        // NOTE: needs typeAttr set?
+    }
+
+    // VtArray<GfVec2d>
+    else if (val.IsHolding<VtArray<GfVec2d> >()) {
+        const VtArray<GfVec2d> array = val.UncheckedGet<VtArray<GfVec2d> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        // NOTE: needs typeAttr set?
+    }
+
+    // VtArray<SdfAssetPath>
+    else if (val.IsHolding<VtArray<SdfAssetPath> >()) {
+        // This will replicate the previous behavior:
+        // if (asShaderParam) return valueAttr; asShaderParam = false;
+        const VtArray<SdfAssetPath> &array = val.UncheckedGet<VtArray<SdfAssetPath> >();
+        valueAttr = VtKatanaMapOrCopy(array);
+        typeAttr = FnKat::StringAttribute(
+            TfStringPrintf("string [%zu]", array.size()));
+    }
+
+    // If being used as a shader param, the type will be provided elsewhere,
+    // so simply return the value attribute as-is.
+    if (asShaderParam) {
+        return valueAttr;
+    }
+    // Otherwise, return the type & value in a group.
+    if (typeAttr.isValid() && valueAttr.isValid()) {
+        FnKat::GroupBuilder groupBuilder;
+        groupBuilder.set("type", typeAttr);
+        groupBuilder.set("value", valueAttr);
+        return groupBuilder.build();
+    }
+    return FnKat::Attribute();
+}
+
+static bool
+_KTypeAndSizeFromUsdVec2(TfToken const &roleName,
+                         const char *typeStr,
+                         FnKat::Attribute *inputTypeAttr,
+                         FnKat::Attribute *elementSizeAttr)
+{
+    if (roleName == SdfValueRoleNames->Point) {
+        *inputTypeAttr = FnKat::StringAttribute("point2");
+    } else if (roleName == SdfValueRoleNames->Vector) {
+        *inputTypeAttr = FnKat::StringAttribute("vector2");
+    } else if (roleName == SdfValueRoleNames->Normal) {
+        *inputTypeAttr = FnKat::StringAttribute("normal2");
+    } else if (roleName == SdfValueRoleNames->TextureCoordinate ||
+               roleName.IsEmpty()) {
+        *inputTypeAttr = FnKat::StringAttribute(typeStr);
+        *elementSizeAttr = FnKat::IntAttribute(2);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool
+_KTypeAndSizeFromUsdVec3(TfToken const &roleName,
+                         const char *typeStr,
+                         FnKat::Attribute *inputTypeAttr,
+                         FnKat::Attribute *elementSizeAttr)
+{
+    if (roleName == SdfValueRoleNames->Point) {
+        *inputTypeAttr = FnKat::StringAttribute("point3");
+    } else if (roleName == SdfValueRoleNames->Vector) {
+        *inputTypeAttr = FnKat::StringAttribute("vector3");
+    } else if (roleName == SdfValueRoleNames->Normal) {
+        *inputTypeAttr = FnKat::StringAttribute("normal3");
+    } else if (roleName == SdfValueRoleNames->Color) {
+        *inputTypeAttr = FnKat::StringAttribute("color3");
+    } else if (roleName == SdfValueRoleNames->TextureCoordinate ||
+               roleName.IsEmpty()) {
+        // Deserves explanation: there is no type in prman
+        // (or apparently, katana) that represents
+        // "a 3-vector with no additional behavior/meaning.
+        // P-refs fall into this category.  In our pipeline,
+        // we have chosen to represent this as float[3] to
+        // renderers.
+        *inputTypeAttr = FnKat::StringAttribute(typeStr);
+        *elementSizeAttr = FnKat::IntAttribute(3);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool
+_KTypeAndSizeFromUsdVec4(TfToken const &roleName,
+                         const char *typeStr,
+                         FnKat::Attribute *inputTypeAttr,
+                         FnKat::Attribute *elementSizeAttr)
+{
+    if (roleName == SdfValueRoleNames->Point) {
+        *inputTypeAttr = FnKat::StringAttribute("point4");
+    } else if (roleName == SdfValueRoleNames->Vector) {
+        *inputTypeAttr = FnKat::StringAttribute("vector4");
+    } else if (roleName == SdfValueRoleNames->Normal) {
+        *inputTypeAttr = FnKat::StringAttribute("normal4");
+    } else if (roleName == SdfValueRoleNames->Color) {
+        *inputTypeAttr = FnKat::StringAttribute("color4");
+    } else if (roleName.IsEmpty()) {
+        // We are mimicking the behavior of
+        // _KTypeAndSizeFromUsdVec3 here.
+        *inputTypeAttr = FnKat::StringAttribute(typeStr);
+        *elementSizeAttr = FnKat::IntAttribute(4);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool
+_KTypeAndSizeFromUsdVec2(TfToken const &roleName,
+                         FnKat::Attribute *inputTypeAttr,
+                         FnKat::Attribute *elementSizeAttr)
+{
+    if (roleName.IsEmpty()) {
+        // Deserves explanation: there is no type in prman
+        // (or apparently, katana) that represents
+        // "a 2-vector with no additional behavior/meaning.
+        // UVs fall into this category.  In our pipeline,
+        // we have chosen to represent this as float[2] to
+        // renderers.
+        *inputTypeAttr = FnKat::StringAttribute("float");
+        *elementSizeAttr = FnKat::IntAttribute(2);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void LegacyConvertVtValueToKatCustomGeomAttr(const VtValue& val,
+                                                 int elementSize,
+                                                 const TfToken& roleName,
+                                                 FnKat::Attribute* valueAttr,
+                                                 FnKat::Attribute* inputTypeAttr,
+                                                 FnKat::Attribute* elementSizeAttr)
+{
+    // The following encoding is taken from Katana's
+    // "LOCATIONS AND ATTRIBUTES" doc, which says this about
+    // the "geometry.arbitrary.xxx" attributes:
+    //
+    // > Note: Katana currently supports the following types: float,
+    // > double, int, string, color3, color4, normal2, normal3, vector2,
+    // > vector3, vector4, point2, point3, point4, matrix9, matrix16.
+    // > Depending on the renderer's capabilities, all these nodes might
+    // > not be supported.
+
+    // Usd half and half3 are converted to katana float and float3
+
+    // TODO:
+    // half4, color4, vector4, point4, matrix9
+
+    if (val.IsHolding<float>()) {
+        *valueAttr =  FnKat::FloatAttribute(val.Get<float>());
+        *inputTypeAttr = FnKat::StringAttribute("float");
+        *elementSizeAttr = FnKat::IntAttribute(elementSize);
+        // Leave elementSize empty.
+        return;
+    }
+    if (val.IsHolding<double>()) {
+        // XXX(USD) Kat says it supports double here -- should we preserve
+        // double-ness?
+        *valueAttr =
+            FnKat::DoubleAttribute(val.Get<double>());
+        *inputTypeAttr = FnKat::StringAttribute("double");
+        // Leave elementSize empty.
+        return;
+    }
+    if (val.IsHolding<int>()) {
+        *valueAttr = FnKat::IntAttribute(val.Get<int>());
+        *inputTypeAttr = FnKat::StringAttribute("int");
+        // Leave elementSize empty.
+        return;
+    }
+    if (val.IsHolding<std::string>()) {
+        // TODO: support NO_VALUE here?
+        // *valueAttr = FnKat::NullAttribute();
+        // *inputTypeAttr = FnKat::NullAttribute();
+        *valueAttr = FnKat::StringAttribute(val.Get<std::string>());
+        *inputTypeAttr = FnKat::StringAttribute("string");
+        // Leave elementSize empty.
+        return;
+    }
+    if (val.IsHolding<GfVec2f>()) {
+        if (_KTypeAndSizeFromUsdVec2(roleName, "float",
+                                     inputTypeAttr, elementSizeAttr)){
+            const GfVec2f rawVal = val.Get<GfVec2f>();
+            *valueAttr = VtKatanaCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<GfVec2d>()) {
+        if (_KTypeAndSizeFromUsdVec2(roleName, "double",
+                                     inputTypeAttr, elementSizeAttr)){
+            const GfVec2d rawVal = val.Get<GfVec2d>();
+            *valueAttr = VtKatanaCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<GfVec3f>()) {
+        if (_KTypeAndSizeFromUsdVec3(roleName, "float",
+                                     inputTypeAttr, elementSizeAttr)){
+            const GfVec3f rawVal = val.Get<GfVec3f>();
+            *valueAttr = VtKatanaCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<GfVec4f>()) {
+        if (_KTypeAndSizeFromUsdVec4(roleName, "float",
+                                     inputTypeAttr, elementSizeAttr)){
+            const GfVec4f rawVal = val.Get<GfVec4f>();
+            *valueAttr = VtKatanaCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<GfVec2f>()) {
+        if (_KTypeAndSizeFromUsdVec2(roleName, inputTypeAttr, elementSizeAttr)){
+            const GfVec2f rawVal = val.Get<GfVec2f>();
+            *valueAttr = VtKatanaCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<GfVec3d>()) {
+        if (_KTypeAndSizeFromUsdVec3(roleName, "double",
+                                     inputTypeAttr, elementSizeAttr)){
+            const GfVec3d rawVal = val.Get<GfVec3d>();
+            *valueAttr = VtKatanaCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<GfVec4d>()) {
+        if (_KTypeAndSizeFromUsdVec4(roleName, "double",
+                                     inputTypeAttr, elementSizeAttr)){
+            const GfVec4d rawVal = val.Get<GfVec4d>();
+            *valueAttr = VtKatanaCopy(rawVal);
+        }
+        return;
+    }
+    // XXX: Should matrices also be brought in as doubles?
+    // What implications does this have? xform.matrix is handled explicitly as
+    // a double, and apparently we don't use GfMatrix4f.
+    // Shader parameter floats might expect a float matrix?
+    if (val.IsHolding<GfMatrix4d>()) {
+        const GfMatrix4d rawVal = val.Get<GfMatrix4d>();
+        FnKat::FloatBuilder builder(/* tupleSize = */ 16);
+        std::vector<float> vec;
+        vec.resize(16);
+        for (int i=0; i < 4; ++i) {
+            for (int j=0; j < 4; ++j) {
+                vec[i*4+j] = static_cast<float>(rawVal[i][j]);
+            }
+        }
+        builder.set(vec);
+        *valueAttr = builder.build();
+        *inputTypeAttr = FnKat::StringAttribute("matrix16");
+        // Leave elementSize empty.
+        return;
+    }
+
+    if (val.IsHolding<VtArray<GfHalf> >()) {
+        if (_KTypeAndSizeFromUsdVec3(roleName, "float",
+                                     inputTypeAttr, elementSizeAttr)){
+            const VtArray<GfHalf> rawVal = val.Get<VtArray<GfHalf> >();
+            *valueAttr = VtKatanaMapOrCopy(rawVal);
+        }
+        return;
+    }
+
+    if (val.IsHolding<VtFloatArray>()) {
+        const VtFloatArray rawVal = val.Get<VtFloatArray>();
+        *valueAttr = VtKatanaMapOrCopy(rawVal);
+        *inputTypeAttr = FnKat::StringAttribute("float");
+        if (elementSize > 1) {
+            *elementSizeAttr = FnKat::IntAttribute(elementSize);
+        }
+        return;
+    }
+    if (val.IsHolding<VtDoubleArray>()) {
+        const VtDoubleArray rawVal = val.Get<VtDoubleArray>();
+        *valueAttr = VtKatanaMapOrCopy(rawVal);
+        *inputTypeAttr = FnKat::StringAttribute("double");
+        if (elementSize > 1) {
+            *elementSizeAttr = FnKat::IntAttribute(elementSize);
+        }
+        return;
+    }
+    // XXX: Should matrices also be brought in as doubles?
+    // What implications does this have? xform.matrix is handled explicitly as
+    // a double, and apparently we don't use GfMatrix4f.
+    // Shader parameter floats might expect a float matrix?
+    if (val.IsHolding<VtArray<GfMatrix4d> >()) {
+        const VtArray<GfMatrix4d> rawVal = val.Get<VtArray<GfMatrix4d> >();
+        std::vector<float> vec;
+        TF_FOR_ALL(mat, rawVal) {
+            for (int i=0; i < 4; ++i) {
+                for (int j=0; j < 4; ++j) {
+                    vec.push_back( static_cast<float>((*mat)[i][j]) );
+                }
+            }
+        }
+        FnKat::FloatBuilder builder(/* tupleSize = */ 16);
+        builder.set(vec);
+        *valueAttr = builder.build();
+        *inputTypeAttr = FnKat::StringAttribute("matrix16");
+        if (elementSize > 1) {
+            *elementSizeAttr = FnKat::IntAttribute(elementSize);
+        }
+        return;
+    }
+    if (val.IsHolding<VtArray<GfVec2f> >()) {
+        if (_KTypeAndSizeFromUsdVec2(roleName, "float",
+                                     inputTypeAttr, elementSizeAttr)){
+            const VtArray<GfVec2f> rawVal = val.Get<VtArray<GfVec2f> >();
+            *valueAttr = VtKatanaMapOrCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<VtArray<GfVec2d> >()) {
+        if (_KTypeAndSizeFromUsdVec2(roleName, "double",
+                                     inputTypeAttr, elementSizeAttr)){
+            const VtArray<GfVec2d> rawVal = val.Get<VtArray<GfVec2d> >();
+            *valueAttr = VtKatanaMapOrCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<VtArray<GfVec3h> >()) {
+        if (_KTypeAndSizeFromUsdVec3(roleName, "float",
+                                     inputTypeAttr, elementSizeAttr)){
+            const VtArray<GfVec3h> rawVal = val.Get<VtArray<GfVec3h> >();
+            *valueAttr = VtKatanaMapOrCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<VtArray<GfVec3f> >()) {
+        if (_KTypeAndSizeFromUsdVec3(roleName, "float",
+                                     inputTypeAttr, elementSizeAttr)){
+            const VtArray<GfVec3f> rawVal = val.Get<VtArray<GfVec3f> >();
+            *valueAttr = VtKatanaMapOrCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<VtArray<GfVec3d> >()) {
+        if (_KTypeAndSizeFromUsdVec3(roleName, "double",
+                                     inputTypeAttr, elementSizeAttr)){
+            const VtArray<GfVec3d> rawVal = val.Get<VtArray<GfVec3d> >();
+            *valueAttr = VtKatanaMapOrCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<VtArray<GfVec4f> >()) {
+        if (_KTypeAndSizeFromUsdVec4(roleName, "float",
+                                     inputTypeAttr, elementSizeAttr)){
+            const VtArray<GfVec4f> rawVal = val.Get<VtArray<GfVec4f> >();
+            *valueAttr = VtKatanaMapOrCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<VtArray<GfVec4d> >()) {
+        if (_KTypeAndSizeFromUsdVec4(roleName, "double",
+                                     inputTypeAttr, elementSizeAttr)){
+            const VtArray<GfVec4d> rawVal = val.Get<VtArray<GfVec4d> >();
+            *valueAttr = VtKatanaMapOrCopy(rawVal);
+        }
+        return;
+    }
+    if (val.IsHolding<VtArray<int> >()) {
+        const VtArray<int> rawVal = val.Get<VtArray<int> >();
+        *valueAttr = VtKatanaMapOrCopy(rawVal);
+        *inputTypeAttr = FnKat::StringAttribute("int");
+        if (elementSize > 1) {
+            *elementSizeAttr = FnKat::IntAttribute(elementSize);
+        }
+        return;
+    }
+    if (val.IsHolding<VtArray<unsigned> >()) {
+        // Lossy translation of array<unsigned> to array<int>
+        // No warning is printed as they obscure more important warnings
+        const VtArray<unsigned> rawVal = val.Get<VtArray<unsigned> >();
+        *valueAttr = VtKatanaMapOrCopy(rawVal);
+        *inputTypeAttr = FnKat::StringAttribute("unsigned");
+        if (elementSize > 1) {
+            *elementSizeAttr = FnKat::IntAttribute(elementSize);
+        }
+        return;
+    }
+    if (val.IsHolding<VtArray<long> >()) {
+        // Lossy translation of array<long> to array<int>
+        // No warning is printed as they obscure more important warnings
+        const VtArray<long> rawVal = val.Get<VtArray<long> >();
+        *valueAttr = VtKatanaMapOrCopy(rawVal);
+        *inputTypeAttr = FnKat::StringAttribute("long");
+        if (elementSize > 1) {
+            *elementSizeAttr = FnKat::IntAttribute(elementSize);
+        }
+        return;
+    }
+    if (val.IsHolding<VtArray<std::string> >()) {
+        const VtArray<std::string> rawVal = val.Get<VtArray<std::string> >();
+        *valueAttr = VtKatanaMapOrCopy(rawVal);
+        *inputTypeAttr = FnKat::StringAttribute("string");
+        if (elementSize > 1) {
+            *elementSizeAttr = FnKat::IntAttribute(elementSize);
+        }
+        return;
+    }
+    if (val.IsHolding<TfToken>())
+    {
+        *valueAttr = FnKat::StringAttribute(val.Get<TfToken>().GetString());
+        *inputTypeAttr = FnKat::StringAttribute("string");
+        return;
+    }
+
+    TF_WARN("Unsupported primvar value type: %s",
+            ArchGetDemangled(val.GetTypeid()).c_str());
+}
+
+struct CustomValue
+{
+    int value;
+
+    bool operator==(const CustomValue& other) const { return value == other.value; }
+};
+
+size_t hash_value(const CustomValue& value)
+{
+    return static_cast<size_t>(value.value);
+}
+
+std::ostream& operator<<(std::ostream& out, const CustomValue& value)
+{
+    return out << value.value;
+}
+
+// Registrations can't be undone, so the converters registered by
+// RegisterCustomConverter are for this type only, leaving CustomValue
+// unsupported whatever order the tests run in.
+struct RegisteredValue
+{
+    int value;
+
+    bool operator==(const RegisteredValue& other) const { return value == other.value; }
+};
+
+size_t hash_value(const RegisteredValue& value)
+{
+    return static_cast<size_t>(value.value);
+}
+
+std::ostream& operator<<(std::ostream& out, const RegisteredValue& value)
+{
+    return out << value.value;
+}
+
+std::vector<VtValue> GetSupportedValues()
+{
+    const GfMatrix4d matrix(1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0, 11.0, 12.0,
+                            13.0, 14.0, 15.0, 16.0);
+    const SdfAssetPath assetPath("texture.tex", "/textures/texture.tex");
+
+    return {VtValue(true),
+            VtValue(42),
+            VtValue(uint32_t(4000000000u)),
+            VtValue(1.5f),
+            VtValue(2.5),
+            VtValue(std::string("value")),
+            VtValue(std::string("_NO_VALUE_")),
+            VtValue(assetPath),
+            VtValue(TfToken("token")),
+            VtValue(VtArray<std::string>{"a", "b", "c"}),
+            VtValue(VtArray<TfToken>{TfToken("a"), TfToken("b")}),
+            VtValue(VtArray<int>{1, 2, 3}),
+            VtValue(VtArray<unsigned>{1u, 2u, 3u}),
+            VtValue(VtArray<long>{1l, 2l, 3l}),
+            VtValue(VtArray<float>{1.0f, 2.0f, 3.0f}),
+            VtValue(VtArray<double>{1.0, 2.0, 3.0}),
+            VtValue(VtArray<SdfAssetPath>{assetPath, assetPath}),
+            VtValue(VtArray<GfMatrix4d>{matrix, matrix * 2.0}),
+            VtValue(VtArray<GfMatrix4d>()),
+            VtValue(GfVec2f(1.0f, 2.0f)),
+            VtValue(GfVec2d(1.0, 2.0)),
+            VtValue(GfVec3f(1.0f, 2.0f, 3.0f)),
+            VtValue(GfVec3d(1.0, 2.0, 3.0)),
+            VtValue(GfVec4f(1.0f, 2.0f, 3.0f, 4.0f)),
+            VtValue(GfVec4d(1.0, 2.0, 3.0, 4.0)),
+            VtValue(matrix),
+            VtValue(VtArray<GfHalf>{GfHalf(1.0f), GfHalf(2.0f), GfHalf(3.0f)}),
+            VtValue(VtArray<GfVec2f>{GfVec2f(1.0f), GfVec2f(2.0f)}),
+            VtValue(VtArray<GfVec2d>{GfVec2d(1.0), GfVec2d(2.0)}),
+            VtValue(VtArray<GfVec3h>{GfVec3h(GfHalf(1.0f)), GfVec3h(GfHalf(2.0f))}),
+            VtValue(VtArray<GfVec3f>{GfVec3f(1.0f), GfVec3f(2.0f)}),
+            VtValue(VtArray<GfVec3d>{GfVec3d(1.0), GfVec3d(2.0)}),
+            VtValue(VtArray<GfVec4f>{GfVec4f(1.0f), GfVec4f(2.0f)}),
+            VtValue(VtArray<GfVec4d>{GfVec4d(1.0), GfVec4d(2.0)}),
+            // Not supported by either conversion.
+            VtValue(CustomValue{7})};
+}
+
+void ExpectSameAttr(const FnKat::Attribute& expected,
+                    const FnKat::Attribute& actual,
+                    const VtValue& value)
+{
+    ASSERT_EQ(expected.isValid(), actual.isValid()) << ArchGetDemangled(value.GetTypeid());
+    if (expected.isValid())
+    {
+        EXPECT_TRUE(expected == actual) << ArchGetDemangled(value.GetTypeid());
+    }
+}
+
+TEST(ValueConverterRegistryTest, ConvertVtValueToKatAttrMatchesLegacy)
+{
+    for (const VtValue& value : GetSupportedValues())
+    {
+        for (bool asShaderParam : {false, true})
+        {
+            ExpectSameAttr(LegacyConvertVtValueToKatAttr(value, asShaderParam),
+                           UsdKatanaUtils::ConvertVtValueToKatAttr(value, asShaderParam), value);
+        }
+    }
+}
+
+TEST(ValueConverterRegistryTest, ConvertVtValueToKatCustomGeomAttrMatchesLegacy)
+{
+    const std::vector<TfToken> roleNames = {
+        TfToken(),
+        SdfValueRoleNames->Point,
+        SdfValueRoleNames->Vector,
+        SdfValueRoleNames->Normal,
+        SdfValueRoleNames->Color,
+        SdfValueRoleNames->TextureCoordinate,
+    };
+
+    for (const VtValue& value : GetSupportedValues())
+    {
+        for (const TfToken& roleName : roleNames)
+        {
+            for (int elementSize : {1, 3})
+            {
+                FnKat::Attribute expectedValue, expectedInputType, expectedElementSize;
+                LegacyConvertVtValueToKatCustomGeomAttr(value, elementSize, roleName,
+                                                        &expectedValue, &expectedInputType,
+                                                        &expectedElementSize);
+                FnKat::Attribute actualValue, actualInputType, actualElementSize;
+                UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr(value, elementSize, roleName,
+                                                                  &actualValue, &actualInputType,
+                                                                  &actualElementSize);
+
+                ExpectSameAttr(expectedValue, actualValue, value);
+                ExpectSameAttr(expectedInputType, actualInputType, value);
+                ExpectSameAttr(expectedElementSize, actualElementSize, value);
+            }
+        }
+    }
+}
+
+TEST(ValueConverterRegistryTest, RegisterCustomConverter)
+{
+    const VtValue value(RegisteredValue{7});
+    UsdKatanaValueConverterRegistry& registry = UsdKatanaValueConverterRegistry::GetInstance();
+
+    // Only registered by the first run when the tests are repeated.
+    if (!registry.GetAttrConverter(typeid(RegisteredValue)))
+    {
+        ASSERT_FALSE(UsdKatanaUtils::ConvertVtValueToKatAttr(value).isValid());
+
+        ASSERT_TRUE(registry.RegisterAttrConverter<RegisteredValue>(
+            [](const VtValue& val, bool) -> FnKat::Attribute {
+                return FnKat::IntAttribute(val.UncheckedGet<RegisteredValue>().value);
+            }));
+        ASSERT_TRUE(registry.RegisterCustomGeomAttrConverter<RegisteredValue>(
+            [](const VtValue& val, int, const TfToken&, FnKat::Attribute* valueAttr,
+               FnKat::Attribute* inputTypeAttr, FnKat::Attribute*) {
+                *valueAttr = FnKat::IntAttribute(val.UncheckedGet<RegisteredValue>().value);
+                *inputTypeAttr = FnKat::StringAttribute("int");
+            }));
+    }
+
+    // Converters can't be replaced once registered, including the built-in
+    // ones.
+    EXPECT_FALSE(registry.RegisterAttrConverter<RegisteredValue>(
+        [](const VtValue&, bool) { return FnKat::Attribute(); }));
+    EXPECT_FALSE(registry.RegisterAttrConverter<int>(
+        [](const VtValue&, bool) { return FnKat::Attribute(); }));
+
+    FnKat::IntAttribute attr(UsdKatanaUtils::ConvertVtValueToKatAttr(value));
+    ASSERT_TRUE(attr.isValid());
+    EXPECT_EQ(attr.getValue(0, false), 7);
+
+    FnKat::Attribute valueAttr, inputTypeAttr, elementSizeAttr;
+    UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr(value, 1, TfToken(), &valueAttr,
+                                                      &inputTypeAttr, &elementSizeAttr);
+    EXPECT_EQ(FnKat::IntAttribute(valueAttr).getValue(0, false), 7);
+    EXPECT_EQ(FnKat::StringAttribute(inputTypeAttr).getValue("", false), "int");
+    EXPECT_FALSE(elementSizeAttr.isValid());
+}
+
+TEST(ValueConverterRegistryTest, ConversionTiming)
+{
+    // The last types in the legacy if/else chains are the ones that gain
+    // the most from the direct dispatch.
+    const std::vector<VtValue> values = {
+        VtValue(GfVec4d(1.0, 2.0, 3.0, 4.0)),
+        VtValue(VtArray<GfVec2d>{GfVec2d(1.0), GfVec2d(2.0)}),
+        VtValue(VtArray<SdfAssetPath>{SdfAssetPath("a.tex", "/a.tex")}),
+        VtValue(TfToken("token")),
+    };
+    const int numIterations = 100000;
+
+    // Warm up the registry, so that the first measurement doesn't include
+    // the registration of the built-in converters.
+    UsdKatanaUtils::ConvertVtValueToKatAttr(values.front());
+
+    auto timeConversions = [&](FnKat::Attribute (*convert)(const VtValue&, bool)) {
+        const auto start = std::chrono::steady_clock::now();
+        size_t numValid = 0;
+        for (int i = 0; i < numIterations; ++i)
+        {
+            for (const VtValue& value : values)
+            {
+                numValid += convert(value, true).isValid() ? 1 : 0;
+            }
+        }
+        EXPECT_EQ(numValid, numIterations * values.size());
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now() - start)
+            .count();
+    };
+
+    const auto legacyUs = timeConversions(&LegacyConvertVtValueToKatAttr);
+    const auto registryUs = timeConversions(&UsdKatanaUtils::ConvertVtValueToKatAttr);
+    ::testing::Test::RecordProperty("legacyConversionTimeUs", static_cast<int>(legacyUs));
+    ::testing::Test::RecordProperty("registryConversionTimeUs", static_cast<int>(registryUs));
+}
+}  // namespace ValueConverterRegistryTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
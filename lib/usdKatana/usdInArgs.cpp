@@ -29,6 +29,7 @@
 //
 #include "usdKatana/usdInArgs.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 
@@ -36,7 +37,9 @@
 #include <pxr/usd/usdGeom/boundable.h>
 
 #include <FnAttribute/FnDataBuilder.h>
+#include <pystring/pystring.h>
 
+#include "usdKatana/boundsCache.h"
 #include "usdKatana/utils.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
@@ -57,6 +60,7 @@ UsdKatanaUsdInArgs::UsdKatanaUsdInArgs(UsdStageRefPtr stage,
                                        bool verbose,
                                        const std::set<std::string>& outputTargets,
                                        const bool evaluateUsdSkelBindings,
+                                       const bool composeXformOpsInKatana,
                                        const char* errorMessage)
     : _stage(stage),
       _rootLocation(rootLocation),
@@ -73,73 +77,129 @@ UsdKatanaUsdInArgs::UsdKatanaUsdInArgs(UsdStageRefPtr stage,
       _prePopulate(prePopulate),
       _verbose(verbose),
       _outputTargets(outputTargets),
-      _evaluateUsdSkelBindings(evaluateUsdSkelBindings)
+      _evaluateUsdSkelBindings(evaluateUsdSkelBindings),
+      _composeXformOpsInKatana(composeXformOpsInKatana)
 {
     if (errorMessage)
     {
         _errorMessage = errorMessage;
     }
-}
-
-UsdKatanaUsdInArgs::~UsdKatanaUsdInArgs() {}
 
-std::vector<GfBBox3d> UsdKatanaUsdInArgs::ComputeBounds(
-    const UsdPrim& prim,
-    const std::vector<double>& motionSampleTimes,
-    bool applyLocalTransform)
-{
-    std::vector<GfBBox3d> ret;
-
-    std::map<double, UsdGeomBBoxCache>& bboxCaches = _bboxCaches.local();
-
-    TfTokenVector includedPurposes;
-
-    for (size_t i = 0; i < motionSampleTimes.size(); i++)
+    // Index the per-location overrides of the session once rather than
+    // looking them up by encoded location name for every private data.
+    FnAttribute::GroupAttribute overridesAttr = _sessionAttr.getChildByName("overrides");
+    for (int64_t i = 0, e = overridesAttr.getNumberOfChildren(); i < e; ++i)
     {
-        double relSampleTime = motionSampleTimes[i];
-
-        std::map<double, UsdGeomBBoxCache>::iterator it =
-            bboxCaches.find(relSampleTime);
-        if (it == bboxCaches.end())
+        const std::string location = FnAttribute::DelimiterDecode(overridesAttr.getChildName(i));
+        if (!pystring::startswith(location, _sessionLocation))
         {
-            if (includedPurposes.size() == 0)
-            {
-                // XXX: selected purposes should be driven by the UI.
-                // See usdGeom/imageable.h GetPurposeAttr() for allowed values.
-                includedPurposes.push_back(UsdGeomTokens->default_);
-                includedPurposes.push_back(UsdGeomTokens->render);
-            }
+            continue;
+        }
+        const std::string primPathStr = location.substr(_sessionLocation.size());
+        if (primPathStr.empty() || primPathStr[0] != '/')
+        {
+            continue;
+        }
+        const SdfPath primPath(primPathStr);
+        if (primPath.IsEmpty())
+        {
+            continue;
+        }
 
-            // Initialize the bounding box cache for this time sample if it
-            // hasn't yet been initialized.
-            UsdGeomBBoxCache bboxCache(_currentTime + relSampleTime,
-                                       includedPurposes,
-                                       /* useExtentsHint */ true);
-            bboxCaches.insert(
-                std::pair<double, UsdGeomBBoxCache>(relSampleTime, bboxCache));
-            if (applyLocalTransform)
-            {
-                ret.push_back(bboxCache.ComputeLocalBound(prim));
-            }
-            else
-            {
-                ret.push_back(bboxCache.ComputeUntransformedBound(prim));
-            }
+        FnAttribute::GroupAttribute entryAttr = overridesAttr.getChildByIndex(i);
+        SessionOverride entry;
+
+        FnAttribute::FloatAttribute currentTimeAttr = entryAttr.getChildByName("currentTime");
+        if (currentTimeAttr.isValid())
+        {
+            entry.hasCurrentTime = true;
+            entry.currentTime = currentTimeAttr.getValue();
         }
-        else
+        FnAttribute::FloatAttribute shutterOpenAttr = entryAttr.getChildByName("shutterOpen");
+        if (shutterOpenAttr.isValid())
         {
-            if (applyLocalTransform)
+            entry.hasShutterOpen = true;
+            entry.shutterOpen = shutterOpenAttr.getValue();
+        }
+        FnAttribute::FloatAttribute shutterCloseAttr = entryAttr.getChildByName("shutterClose");
+        if (shutterCloseAttr.isValid())
+        {
+            entry.hasShutterClose = true;
+            entry.shutterClose = shutterCloseAttr.getValue();
+        }
+
+        FnAttribute::Attribute motionSampleTimesAttr =
+            entryAttr.getChildByName("motionSampleTimes");
+        if (motionSampleTimesAttr.isValid())
+        {
+            entry.motionSampleTimesOverride = SessionOverride::MotionSampleTimesIgnored;
+            if (motionSampleTimesAttr.getType() == kFnKatAttributeTypeInt)
             {
-                ret.push_back(it->second.ComputeLocalBound(prim));
+                entry.motionSampleTimesOverride = SessionOverride::MotionSampleTimesDefaults;
             }
-            else
+            else if (motionSampleTimesAttr.getType() == kFnKatAttributeTypeFloat)
             {
-                ret.push_back(it->second.ComputeUntransformedBound(prim));
+                const auto sampleTimes =
+                    FnAttribute::FloatAttribute(motionSampleTimesAttr).getNearestSample(0.0f);
+                if (!sampleTimes.empty())
+                {
+                    entry.motionSampleTimesOverride = SessionOverride::MotionSampleTimesExplicit;
+                    entry.motionSampleTimes.assign(sampleTimes.begin(), sampleTimes.end());
+                }
             }
         }
+
+        _sessionOverrides[primPath] = std::move(entry);
+    }
+
+    _materialBindingCaches = std::make_shared<_MaterialBindingCaches>();
+    TfTokenVector purposes = _materialBindingPurposes;
+    if (std::find(purposes.begin(), purposes.end(), UsdShadeTokens->allPurpose) == purposes.end())
+    {
+        purposes.emplace_back(UsdShadeTokens->allPurpose);
+    }
+    for (const TfToken& purpose : purposes)
+    {
+        _materialBindingCaches->bindingsCaches[purpose].reset(
+            new UsdShadeMaterialBindingAPI::BindingsCache);
+    }
+}
+
+UsdKatanaUsdInArgs::~UsdKatanaUsdInArgs() {}
+
+UsdShadeMaterialBindingAPI::BindingsCache* UsdKatanaUsdInArgs::GetBindingsCache(
+    const TfToken& purpose) const
+{
+    const auto purposeBindings = _materialBindingCaches->bindingsCaches.find(purpose);
+    return purposeBindings != _materialBindingCaches->bindingsCaches.end()
+               ? purposeBindings->second.get()
+               : nullptr;
+}
+
+std::vector<GfBBox3d> UsdKatanaUsdInArgs::ComputeBounds(
+    const UsdPrim& prim,
+    const std::vector<double>& motionSampleTimes,
+    bool applyLocalTransform)
+{
+    // Bounds are shared with every other UsdKatanaUsdInArgs (and thread)
+    // reading the same stage.
+    std::vector<double> times(motionSampleTimes.size());
+    for (size_t i = 0; i < motionSampleTimes.size(); i++)
+    {
+        times[i] = _currentTime + motionSampleTimes[i];
     }
+    return UsdKatanaBoundsCache::GetInstance().ComputeBounds(prim, times, applyLocalTransform);
+}
 
-    return ret;
+void UsdKatanaUsdInArgs::WarmUpBounds(const UsdPrim& root,
+                                      const std::vector<double>& motionSampleTimes)
+{
+    std::vector<double> times(motionSampleTimes.size());
+    for (size_t i = 0; i < motionSampleTimes.size(); i++)
+    {
+        times[i] = _currentTime + motionSampleTimes[i];
+    }
+    UsdKatanaBoundsCache::GetInstance().WarmUp(root, times);
 }
 
 UsdPrim UsdKatanaUsdInArgs::GetRootPrim() const
@@ -30,16 +30,20 @@
 #ifndef USDKATANA_USDIN_ARGS_H
 #define USDKATANA_USDIN_ARGS_H
 
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
 
+#include <pxr/base/gf/bbox3d.h>
 #include <pxr/base/tf/refPtr.h>
 #include <pxr/pxr.h>
-#include <pxr/usd/usdGeom/bboxCache.h>
-#include <pxr/usd/usdSkel/cache.h>
-
-#include <tbb/enumerable_thread_specific.h>
+#include <pxr/usd/sdf/path.h>
+#include <pxr/usd/usdShade/materialBindingAPI.h>
 
 #include "usdKatana/api.h"
+#include "usdKatana/skinningCache.h"
 
 /// \brief Reference counted container for op state that should be constructed
 /// at an ops root and passed to read USD prims into Katana attributes.
@@ -111,13 +115,14 @@ public:
         bool verbose,
         const std::set<std::string>& outputTargets,
         const bool evaluateUsdSkelBindings,
+        const bool composeXformOpsInKatana,
         const char* errorMessage = 0)
     {
         return TfCreateRefPtr(new UsdKatanaUsdInArgs(
             stage, rootLocation, isolatePath, sessionLocation, sessionAttr, ignoreLayerRegex,
             currentTime, shutterOpen, shutterClose, motionSampleTimes, extraAttributesOrNamespaces,
             materialBindingPurposes, prePopulate, verbose, outputTargets, evaluateUsdSkelBindings,
-            errorMessage));
+            composeXformOpsInKatana, errorMessage));
     }
 
     // bounds computation is kind of important, so we centralize it here.
@@ -126,6 +131,11 @@ public:
         const std::vector<double>& motionSampleTimes,
         bool applyLocalTransform = false);
 
+    /// Compute, in parallel, the bounds of \p root and of the models below
+    /// it at each of \p motionSampleTimes, ahead of ComputeBounds() queries.
+    USDKATANA_API void WarmUpBounds(const UsdPrim& root,
+                                    const std::vector<double>& motionSampleTimes);
+
     USDKATANA_API UsdPrim GetRootPrim() const;
 
     UsdStageRefPtr GetStage() const {
@@ -188,12 +198,12 @@ public:
         return _verbose;
     }
 
-    std::map<double, UsdGeomBBoxCache>& GetBBoxCache() {
-        return _bboxCaches.local();
+    UsdSkelCache& GetUsdSkelCache() {
+        return _skinningCache.GetUsdSkelCache();
     }
 
-    UsdSkelCache& GetUsdSkelCache() {
-        return _usdSkelCache;
+    UsdKatanaSkinningCache& GetSkinningCache() {
+        return _skinningCache;
     }
     
     const std::set<std::string> & GetOutputTargets() {
@@ -204,6 +214,59 @@ public:
         return _evaluateUsdSkelBindings;
     }
 
+    /// Whether xform ops are read one by one and composed by Katana, rather
+    /// than read as a single local transform per motion sample.
+    bool GetComposeXformOpsInKatana() const {
+        return _composeXformOpsInKatana;
+    }
+
+    /// \brief Motion overrides found in the "overrides" group of the session
+    ///        attribute for a single location.
+    struct SessionOverride
+    {
+        enum MotionSampleTimesOverride
+        {
+            MotionSampleTimesNone,      ///< No motionSampleTimes entry.
+            MotionSampleTimesIgnored,   ///< An entry of an unusable type or empty.
+            MotionSampleTimesDefaults,  ///< An IntAttribute: use the args' defaults.
+            MotionSampleTimesExplicit,  ///< A FloatAttribute: use motionSampleTimes.
+        };
+
+        bool hasCurrentTime = false;
+        bool hasShutterOpen = false;
+        bool hasShutterClose = false;
+        double currentTime = 0.0;
+        double shutterOpen = 0.0;
+        double shutterClose = 0.0;
+        MotionSampleTimesOverride motionSampleTimesOverride = MotionSampleTimesNone;
+        std::vector<double> motionSampleTimes;
+    };
+
+    /// \brief Return the session overrides for the USD \p primPath, or null
+    ///        if there are none. The overrides are parsed once on construction.
+    const SessionOverride* GetSessionOverride(const SdfPath& primPath) const {
+        if (_sessionOverrides.empty()) {
+            return nullptr;
+        }
+        const auto it = _sessionOverrides.find(primPath);
+        return it != _sessionOverrides.end() ? &it->second : nullptr;
+    }
+
+    bool HasSessionOverrides() const {
+        return !_sessionOverrides.empty();
+    }
+
+    /// \brief Material binding caches shared by every location cooked with
+    ///        these args (and any args derived from them for the same stage).
+    ///        Both caches are safe to use concurrently.
+    UsdShadeMaterialBindingAPI::CollectionQueryCache* GetCollectionQueryCache() const {
+        return &_materialBindingCaches->collectionQueryCache;
+    }
+
+    /// \brief Returns null for purposes which were not requested.
+    USDKATANA_API UsdShadeMaterialBindingAPI::BindingsCache* GetBindingsCache(
+        const TfToken& purpose = UsdShadeTokens->allPurpose) const;
+
     const std::string & GetErrorMessage() {
         return _errorMessage;
     }
@@ -224,10 +287,20 @@ private:
                        bool verbose,
                        const std::set<std::string>& outputTargets,
                        bool evaluateUsdSkelBindings,
+                       bool composeXformOpsInKatana,
                        const char* errorMessage = 0);
 
     ~UsdKatanaUsdInArgs();
 
+    friend struct ArgsBuilder;
+
+    struct _MaterialBindingCaches
+    {
+        UsdShadeMaterialBindingAPI::CollectionQueryCache collectionQueryCache;
+        std::map<TfToken, std::unique_ptr<UsdShadeMaterialBindingAPI::BindingsCache>>
+            bindingsCaches;
+    };
+
     UsdStageRefPtr _stage;
 
     std::string _rootLocation;
@@ -235,6 +308,9 @@ private:
 
     std::string _sessionLocation;
     FnAttribute::GroupAttribute _sessionAttr;
+
+    // Session overrides keyed by USD prim path (relative to _sessionLocation).
+    std::unordered_map<SdfPath, SessionOverride, SdfPath::Hash> _sessionOverrides;
     std::string _ignoreLayerRegex;
 
     double _currentTime;
@@ -252,14 +328,19 @@ private:
 
     std::set<std::string> _outputTargets;
 
-    typedef tbb::enumerable_thread_specific< std::map<double, UsdGeomBBoxCache> > _ThreadLocalBBoxCaches;
-    _ThreadLocalBBoxCaches _bboxCaches;
 
-    // Cache for accelerating UsdSkel skinning data calculation.
-    UsdSkelCache _usdSkelCache;
+    // Cache for accelerating UsdSkel skinning data calculation, shared by
+    // every skinned mesh cooked with these args.
+    UsdKatanaSkinningCache _skinningCache;
+
+    // Populated on construction and never modified afterwards so that the
+    // caches themselves can be looked up without locking.
+    std::shared_ptr<_MaterialBindingCaches> _materialBindingCaches;
     
     bool _evaluateUsdSkelBindings{true};
 
+    bool _composeXformOpsInKatana{false};
+
     std::string _errorMessage;
 };
 
@@ -282,6 +363,7 @@ struct ArgsBuilder
     bool verbose;
     std::set<std::string> outputTargets;
     bool evaluateUsdSkelBindings;
+    bool composeXformOpsInKatana;
     const char* errorMessage;
 
     ArgsBuilder()
@@ -291,18 +373,29 @@ struct ArgsBuilder
     , prePopulate(false)
     , verbose(true)
     , evaluateUsdSkelBindings(true)
+    , composeXformOpsInKatana(false)
     , errorMessage(0)
     {
     }
 
     UsdKatanaUsdInArgsRefPtr build()
     {
-        return UsdKatanaUsdInArgs::New(
+        UsdKatanaUsdInArgsRefPtr args = UsdKatanaUsdInArgs::New(
             stage, rootLocation, isolatePath, sessionLocation,
             sessionAttr.isValid() ? sessionAttr : FnAttribute::GroupAttribute(true),
             ignoreLayerRegex, currentTime, shutterOpen, shutterClose, motionSampleTimes,
             extraAttributesOrNamespaces, materialBindingPurposes, prePopulate, verbose,
-            outputTargets, evaluateUsdSkelBindings, errorMessage);
+            outputTargets, evaluateUsdSkelBindings, composeXformOpsInKatana, errorMessage);
+
+        // Material bindings don't vary with time, keep sharing the caches of
+        // the args we were updated from as long as they read the same stage
+        // for the same purposes.
+        if (_updatedFrom && _updatedFrom->GetStage() == stage &&
+            _updatedFrom->GetMaterialBindingPurposes() == materialBindingPurposes)
+        {
+            args->_materialBindingCaches = _updatedFrom->_materialBindingCaches;
+        }
+        return args;
     }
 
     void update(UsdKatanaUsdInArgsRefPtr other)
@@ -323,7 +416,9 @@ struct ArgsBuilder
         verbose = other->IsVerbose();
         outputTargets = other->GetOutputTargets();
         evaluateUsdSkelBindings = other->GetEvaluateUsdSkelBindings();
+        composeXformOpsInKatana = other->GetComposeXformOpsInKatana();
         errorMessage = other->GetErrorMessage().c_str();
+        _updatedFrom = other;
     }
 
     UsdKatanaUsdInArgsRefPtr buildWithError(std::string errorStr)
@@ -331,7 +426,9 @@ struct ArgsBuilder
         errorMessage = errorStr.c_str();
         return build();
     }
-    
+
+private:
+    UsdKatanaUsdInArgsRefPtr _updatedFrom;
 };
 
 
@@ -30,15 +30,19 @@
 #include "usdKatana/usdInPluginRegistry.h"
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <pxr/base/plug/plugin.h>
 #include <pxr/base/plug/registry.h>
+#include <pxr/base/tf/hash.h>
 #include <pxr/pxr.h>
 #include <pxr/usd/kind/registry.h>
 #include <pxr/usd/usd/schemaBase.h>
 
+#include <tbb/concurrent_unordered_map.h>
+
 #include <FnLogging/FnLogging.h>
 
 FnLogSetup("UsdInPluginRegistry");
@@ -57,6 +61,7 @@ void UsdKatanaUsdInPluginRegistry::_RegisterUsdType(const std::string& tfTypeNam
                                                     const std::string& opName)
 {
     _usdTypeReg[tfTypeName] = opName;
+    _InvalidateDispatchCaches();
 }
 
 /* static */
@@ -64,6 +69,7 @@ void UsdKatanaUsdInPluginRegistry::_RegisterSchema(const TfToken& schemaName,
                                                    const std::string& opName)
 {
     _usdSchemaReg[schemaName] = opName;
+    _InvalidateDispatchCaches();
 }
 
 /* static */
@@ -71,6 +77,7 @@ void UsdKatanaUsdInPluginRegistry::_RegisterUsdTypeForSite(const std::string& tf
                                                            const std::string& opName)
 {
     _usdTypeSiteReg[tfTypeName] = opName;
+    _InvalidateDispatchCaches();
 }
 
 bool 
@@ -114,6 +121,7 @@ static _KindRegistry _kindExtReg;
 void UsdKatanaUsdInPluginRegistry::RegisterKind(const TfToken& kind, const std::string& opName)
 {
     _kindReg[kind] = opName;
+    _InvalidateDispatchCaches();
 }
 
 /* static */
@@ -121,6 +129,7 @@ void UsdKatanaUsdInPluginRegistry::RegisterKindForSite(const TfToken& kind,
                                                        const std::string& opName)
 {
     _kindExtReg[kind] = opName;
+    _InvalidateDispatchCaches();
 }
 
 /* static */
@@ -172,6 +181,7 @@ void UsdKatanaUsdInPluginRegistry::RegisterOpDirectExecFnc(const std::string& op
                                                            OpDirectExecFnc fnc)
 {
     _opDirectExecFncTable[opName] = fnc;
+    _InvalidateDispatchCaches();
 }
 
 void UsdKatanaUsdInPluginRegistry::ExecuteOpDirectExecFnc(
@@ -234,6 +244,132 @@ FnKat::GroupAttribute UsdKatanaUsdInPluginRegistry::ExecuteLocationDecoratorOps(
     return opArgs;
 }
 
+// Memoized dispatch, keyed on the prim type name followed by its applied
+// schemas (built-in ones included), and on the kind. Entries are only ever
+// added while cooking so lookups need no lock. Registration (which happens at
+// plug-in load) swaps in empty caches rather than clearing them, as cooks may
+// still be reading the previous ones.
+struct _TokenVectorHash
+{
+    size_t operator()(const TfTokenVector& tokens) const
+    {
+        size_t hash = tokens.size();
+        for (const TfToken& token : tokens)
+        {
+            hash = TfHash::Combine(hash, token.Hash());
+        }
+        return hash;
+    }
+};
+
+typedef tbb::concurrent_unordered_map<TfTokenVector,
+                                      UsdKatanaUsdInPluginRegistry::TypeDispatch,
+                                      _TokenVectorHash>
+    _TypeDispatchCache;
+static std::shared_ptr<_TypeDispatchCache> _typeDispatchCache =
+    std::make_shared<_TypeDispatchCache>();
+
+typedef tbb::concurrent_unordered_map<TfToken,
+                                      UsdKatanaUsdInPluginRegistry::KindDispatch,
+                                      TfToken::HashFunctor>
+    _KindDispatchCache;
+static std::shared_ptr<_KindDispatchCache> _kindDispatchCache =
+    std::make_shared<_KindDispatchCache>();
+
+/* static */
+void UsdKatanaUsdInPluginRegistry::_InvalidateDispatchCaches()
+{
+    std::atomic_store(&_typeDispatchCache, std::make_shared<_TypeDispatchCache>());
+    std::atomic_store(&_kindDispatchCache, std::make_shared<_KindDispatchCache>());
+}
+
+/* static */
+UsdKatanaUsdInPluginRegistry::OpDirectExecFnc UsdKatanaUsdInPluginRegistry::_FindOpDirectExecFnc(
+    const std::string& opName)
+{
+    if (opName.empty())
+    {
+        return nullptr;
+    }
+    _OpDirectExecFncTable::const_iterator I = _opDirectExecFncTable.find(opName);
+    return I != _opDirectExecFncTable.end() ? I->second : nullptr;
+}
+
+/* static */
+UsdKatanaUsdInPluginRegistry::TypeDispatch UsdKatanaUsdInPluginRegistry::FindTypeDispatch(
+    const TfToken& usdTypeName,
+    const TfTokenVector& appliedSchemas)
+{
+    TfTokenVector key;
+    key.reserve(appliedSchemas.size() + 1);
+    key.push_back(usdTypeName);
+    key.insert(key.end(), appliedSchemas.begin(), appliedSchemas.end());
+
+    const std::shared_ptr<_TypeDispatchCache> cache = std::atomic_load(&_typeDispatchCache);
+    _TypeDispatchCache::const_iterator I = cache->find(key);
+    if (I != cache->end())
+    {
+        return I->second;
+    }
+
+    TypeDispatch dispatch;
+    std::string opName;
+    if (!FindUsdType(usdTypeName, &opName))
+    {
+        // If there is no type registered, we search through the applied
+        // schemas to see if one of those has an op registered against them.
+        bool foundRegisteredSchema = false;
+        for (const TfToken& appliedSchemaName : appliedSchemas)
+        {
+            if (FindSchema(appliedSchemaName, &opName))
+            {
+                dispatch.hasMultipleSchemaOps |= foundRegisteredSchema;
+                foundRegisteredSchema = true;
+            }
+        }
+    }
+    dispatch.typeFnc = _FindOpDirectExecFnc(opName);
+
+    opName.clear();
+    if (FindUsdTypeForSite(usdTypeName, &opName))
+    {
+        dispatch.siteTypeFnc = _FindOpDirectExecFnc(opName);
+    }
+
+    static const TfToken skelRootTypeName("SkelRoot");
+    dispatch.isSkelRoot = usdTypeName == skelRootTypeName;
+
+    cache->insert(std::make_pair(std::move(key), dispatch));
+    return dispatch;
+}
+
+/* static */
+UsdKatanaUsdInPluginRegistry::KindDispatch UsdKatanaUsdInPluginRegistry::FindKindDispatch(
+    const TfToken& kind)
+{
+    const std::shared_ptr<_KindDispatchCache> cache = std::atomic_load(&_kindDispatchCache);
+    _KindDispatchCache::const_iterator I = cache->find(kind);
+    if (I != cache->end())
+    {
+        return I->second;
+    }
+
+    KindDispatch dispatch;
+    std::string opName;
+    if (FindKind(kind, &opName))
+    {
+        dispatch.kindFnc = _FindOpDirectExecFnc(opName);
+    }
+    opName.clear();
+    if (HasKindsForSite() && FindKindForSite(kind, &opName))
+    {
+        dispatch.siteKindFnc = _FindOpDirectExecFnc(opName);
+    }
+
+    cache->insert(std::make_pair(kind, dispatch));
+    return dispatch;
+}
+
 
 
 
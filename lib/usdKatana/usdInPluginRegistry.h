@@ -156,6 +156,53 @@ public:
             std::string* opName);
 
 
+    typedef void (*OpDirectExecFnc)(const UsdKatanaUsdInPrivateData& privateData,
+                                    FnKat::GroupAttribute opArgs,
+                                    FnKat::GeolibCookInterface& interface);
+
+    /// \brief The direct exec functions of the ops handling a prim's type,
+    ///        in the order they should run. Null when no op applies.
+    struct TypeDispatch
+    {
+        /// Core op for the prim type or, failing that, for one of its
+        /// applied schemas.
+        OpDirectExecFnc typeFnc = nullptr;
+        /// Site-specific op for the prim type.
+        OpDirectExecFnc siteTypeFnc = nullptr;
+        /// True if more than one applied schema has an op registered.
+        bool hasMultipleSchemaOps = false;
+        /// True for UsdSkelRoot prims, whose op may be disabled.
+        bool isSkelRoot = false;
+    };
+
+    /// \brief The direct exec functions of the ops handling a model kind,
+    ///        in the order they should run. Null when no op applies.
+    struct KindDispatch
+    {
+        OpDirectExecFnc kindFnc = nullptr;
+        OpDirectExecFnc siteKindFnc = nullptr;
+    };
+
+    /// \brief Resolves the ops to run for a prim of type \p usdTypeName with
+    ///        the applied schemas \p appliedSchemas, as FindUsdType,
+    ///        FindSchema and FindUsdTypeForSite would, straight to their
+    ///        direct exec functions.
+    ///
+    /// \p appliedSchemas should include built-in API schemas, as returned
+    /// by UsdPrim::GetAppliedSchemas(), so that e.g. typed UsdLux lights
+    /// match ops registered against UsdLuxLightAPI.
+    ///
+    /// Results are memoized and the memo is replaced whenever a type, schema,
+    /// kind or op is registered. Lookups don't lock, registration is expected
+    /// to happen when plug-ins are loaded rather than while cooking.
+    USDKATANA_API static TypeDispatch FindTypeDispatch(const TfToken& usdTypeName,
+                                                       const TfTokenVector& appliedSchemas);
+
+    /// \brief Resolves the ops to run for \p kind, as FindKind and
+    ///        FindKindForSite would, straight to their direct exec functions.
+    ///        Memoized in the same way as FindTypeDispatch.
+    USDKATANA_API static KindDispatch FindKindDispatch(const TfToken& kind);
+
     /// \brief The signature for a plug-in "light list" function.
     /// These functions are called for each light path.  The
     /// argument allows for building the Katana light list.
@@ -173,10 +220,6 @@ public:
     /// path. This allows for modifying the Katana light list.
     USDKATANA_API static void ExecuteLightListFncs(UsdKatanaUtilsLightListAccess& access);
 
-    typedef void (*OpDirectExecFnc)(const UsdKatanaUsdInPrivateData& privateData,
-                                    FnKat::GroupAttribute opArgs,
-                                    FnKat::GeolibCookInterface& interface);
-
     /// \brief Makes an UsdIn kind./type op's cook function available for
     ///        to invoke directly without execOp. This is to allow for
     ///        privateData to be locally overriden in a way that's not directly
@@ -232,6 +275,10 @@ private:
         std::string* opName,
         const std::map<TfToken, std::string>& reg);
 
+    static OpDirectExecFnc _FindOpDirectExecFnc(const std::string& opName);
+
+    static void _InvalidateDispatchCaches();
+
 };
 
 /// \def USDKATANA_USDIN_PLUGIN_DECLARE(T)
@@ -33,12 +33,10 @@
 #include <utility>
 
 #include <pxr/base/gf/interval.h>
+#include <pxr/base/tf/smallVector.h>
 #include <pxr/pxr.h>
 #include <pxr/usd/usdGeom/xform.h>
 
-#include <pystring/pystring.h>
-#include <FnGeolib/util/Path.h>
-
 #include "usdKatana/utils.h"
 
 namespace
@@ -90,10 +88,9 @@ UsdKatanaUsdInPrivateData::UsdKatanaUsdInPrivateData(const UsdPrim& prim,
     // already reported as a katana error from usdIn.cpp
     if (!prim)
     {
+        _motionSampleTimes = std::make_shared<const _MotionSampleTimes>();
         return;
     }
-    
-    _outputTargets = _usdInArgs->GetOutputTargets();
 
     // XXX: manually track instance and prototype path for possible
     //      relationship re-retargeting. This approach does not yet
@@ -142,10 +139,7 @@ UsdKatanaUsdInPrivateData::UsdKatanaUsdInPrivateData(const UsdPrim& prim,
     // Apply session overrides for motion.
     //
 
-    const std::string primPath = prim.GetPrimPath().GetString();
-    const std::string isolatePath = usdInArgs->GetIsolatePath();
-    const std::string sessionPath = usdInArgs->GetSessionLocationPath();
-    FnKat::GroupAttribute sessionAttr = usdInArgs->GetSessionAttr();
+    const std::string& isolatePath = usdInArgs->GetIsolatePath();
 
     // XXX: If an isolatePath has been specified, it means the UsdIn is
     // probably loading USD contents below the USD root. This can prevent
@@ -156,21 +150,27 @@ UsdKatanaUsdInPrivateData::UsdKatanaUsdInPrivateData(const UsdPrim& prim,
     // we don't have any parentData, we'll need to check if there are overrides
     // for the prim and any of its parents.
     //
-    std::vector<std::string> pathsToCheck;
-    if (!parentData and !isolatePath.empty() and
-        pystring::startswith(primPath, isolatePath+"/"))
-    {
-        auto parentLocs = Foundry::Katana::Util::Path::GetLocationStackStringView(primPath);
-        std::reverse(std::begin(parentLocs), std::end(parentLocs));
-        pathsToCheck.reserve(parentLocs.size());
-        for (const auto& parentLoc : parentLocs)
+    // The overrides are indexed by prim path on the usdInArgs, so each path
+    // to check costs a single hash lookup. Paths without overrides are kept
+    // as null entries as the motion sample times fallback below depends on
+    // how many were checked.
+    //
+    typedef UsdKatanaUsdInArgs::SessionOverride SessionOverride;
+    TfSmallVector<const SessionOverride*, 1> overridesToCheck;
+    const SdfPath primPath = prim.GetPrimPath();
+    if (!parentData and !isolatePath.empty() and primPath.HasPrefix(SdfPath(isolatePath)) and
+        primPath.GetString().size() > isolatePath.size())
+    {
+        const SdfPathVector parentPaths = primPath.GetPrefixes();
+        overridesToCheck.reserve(parentPaths.size());
+        for (auto it = parentPaths.rbegin(); it != parentPaths.rend(); ++it)
         {
-            pathsToCheck.push_back(FnKat::DelimiterEncode(sessionPath + std::string{parentLoc}));
+            overridesToCheck.push_back(usdInArgs->GetSessionOverride(*it));
         }
     }
     else
     {
-        pathsToCheck.push_back(FnKat::DelimiterEncode(sessionPath + primPath));
+        overridesToCheck.push_back(usdInArgs->GetSessionOverride(primPath));
     }
 
     //
@@ -179,102 +179,86 @@ UsdKatanaUsdInPrivateData::UsdKatanaUsdInPrivateData(const UsdPrim& prim,
     // usdInArgs value.
     //
 
-    bool overrideFound;
-
-    const double startTime = usdInArgs->GetStage()->GetStartTimeCode();
-    const double tcps = usdInArgs->GetStage()->GetTimeCodesPerSecond();
-    const double fps = usdInArgs->GetStage()->GetFramesPerSecond();
+    const UsdStageRefPtr& stage = usdInArgs->GetStage();
+    const double startTime = stage->GetStartTimeCode();
+    const double tcps = stage->GetTimeCodesPerSecond();
+    const double fps = stage->GetFramesPerSecond();
     const double timeScaleRatio = tcps / fps;
 
-    // Current time.
-    //
-    overrideFound = false;
-    for (size_t i = 0; i < pathsToCheck.size(); ++i)
+    const SessionOverride* currentTimeOverride = nullptr;
+    const SessionOverride* shutterOpenOverride = nullptr;
+    const SessionOverride* shutterCloseOverride = nullptr;
+    for (const SessionOverride* sessionOverride : overridesToCheck)
     {
-        FnKat::FloatAttribute currentTimeAttr =
-            sessionAttr.getChildByName(
-                "overrides."+pathsToCheck[i]+".currentTime");
-        if (currentTimeAttr.isValid())
+        if (!sessionOverride)
         {
-            _currentTime = currentTimeAttr.getValue();
-            overrideFound = true;
-            break;
+            continue;
         }
-    }
-    if (!overrideFound)
-    {
-        if (parentData)
+        if (!currentTimeOverride && sessionOverride->hasCurrentTime)
         {
-            _currentTime = parentData->GetCurrentTime();
+            currentTimeOverride = sessionOverride;
         }
-        else
+        if (!shutterOpenOverride && sessionOverride->hasShutterOpen)
         {
-            _currentTime = usdInArgs->GetCurrentTime();
-
-            // Apply time scaling.
-            //
-            _currentTime =
-                startTime + ((_currentTime - startTime) * timeScaleRatio);
+            shutterOpenOverride = sessionOverride;
+        }
+        if (!shutterCloseOverride && sessionOverride->hasShutterClose)
+        {
+            shutterCloseOverride = sessionOverride;
         }
     }
 
+    // Current time.
+    //
+    if (currentTimeOverride)
+    {
+        _currentTime = currentTimeOverride->currentTime;
+    }
+    else if (parentData)
+    {
+        _currentTime = parentData->GetCurrentTime();
+    }
+    else
+    {
+        _currentTime = usdInArgs->GetCurrentTime();
+
+        // Apply time scaling.
+        //
+        _currentTime = startTime + ((_currentTime - startTime) * timeScaleRatio);
+    }
+
     // Shutter open.
     //
-    overrideFound = false;
-    for (size_t i = 0; i < pathsToCheck.size(); ++i)
+    if (shutterOpenOverride)
     {
-        FnKat::FloatAttribute shutterOpenAttr =
-                sessionAttr.getChildByName(
-                    "overrides."+pathsToCheck[i]+".shutterOpen");
-        if (shutterOpenAttr.isValid())
-        {
-            _shutterOpen = shutterOpenAttr.getValue();
-            overrideFound = true;
-            break;
-        }
+        _shutterOpen = shutterOpenOverride->shutterOpen;
     }
-    if (!overrideFound)
+    else if (parentData)
     {
-        if (parentData)
-        {
-            _shutterOpen = parentData->GetShutterOpen();
-        }
-        else
-        {
-            _shutterOpen = usdInArgs->GetShutterOpen();
-        }
+        _shutterOpen = parentData->GetShutterOpen();
+    }
+    else
+    {
+        _shutterOpen = usdInArgs->GetShutterOpen();
     }
 
     // Shutter close.
     //
-    overrideFound = false;
-    for (size_t i = 0; i < pathsToCheck.size(); ++i)
+    if (shutterCloseOverride)
     {
-        FnKat::FloatAttribute shutterCloseAttr =
-                sessionAttr.getChildByName(
-                    "overrides."+pathsToCheck[i]+".shutterClose");
-        if (shutterCloseAttr.isValid())
-        {
-            _shutterClose = shutterCloseAttr.getValue();
-            overrideFound = true;
-            break;
-        }
+        _shutterClose = shutterCloseOverride->shutterClose;
     }
-    if (!overrideFound)
+    else if (parentData)
     {
-        if (parentData)
-        {
-            _shutterClose = parentData->GetShutterClose();
-        }
-        else
-        {
-            _shutterClose = usdInArgs->GetShutterClose();
+        _shutterClose = parentData->GetShutterClose();
+    }
+    else
+    {
+        _shutterClose = usdInArgs->GetShutterClose();
 
-            // Apply time scaling.
-            //
-            _shutterClose =
-                _shutterOpen + ((_shutterClose - _shutterOpen) * timeScaleRatio);
-        }
+        // Apply time scaling.
+        //
+        _shutterClose = _shutterOpen + ((_shutterClose - _shutterOpen) * timeScaleRatio);
     }
 
     // Motion sample times.
@@ -283,10 +267,15 @@ UsdKatanaUsdInPrivateData::UsdKatanaUsdInPrivateData(const UsdPrim& prim,
     // they can vary per attribute, so store both the overridden and the
     // fallback motion sample times for use inside GetMotionSampleTimes.
     //
+    // Most locations resolve to exactly the times of their parent, in which
+    // case the parent's times are shared rather than copied.
+    //
+    std::vector<double> motionSampleTimesOverride;
+    bool inheritsParentOverride = false;
     bool useDefaultMotionSamples = false;
     if (!prim.IsPseudoRoot())
     {
-        TfToken useDefaultMotionSamplesToken("katana:useDefaultMotionSamples");
+        static const TfToken useDefaultMotionSamplesToken("katana:useDefaultMotionSamples");
         UsdAttribute useDefaultMotionSamplesUsdAttr = 
             prim.GetAttribute(useDefaultMotionSamplesToken);
         if (useDefaultMotionSamplesUsdAttr)
@@ -298,115 +287,113 @@ UsdKatanaUsdInPrivateData::UsdKatanaUsdInPrivateData(const UsdPrim& prim,
             useDefaultMotionSamplesUsdAttr.Get(&useDefaultMotionSamples);
             if (useDefaultMotionSamples)
             {
-                _motionSampleTimesOverride = usdInArgs->GetMotionSampleTimes();
+                motionSampleTimesOverride = usdInArgs->GetMotionSampleTimes();
             }
         }
     }
 
-    for (size_t i = 0; i < pathsToCheck.size(); ++i)
+    for (const SessionOverride* sessionOverride : overridesToCheck)
     {
-        FnKat::Attribute motionSampleTimesAttr =
-                sessionAttr.getChildByName(
-                    "overrides."+pathsToCheck[i]+".motionSampleTimes");
-        if (motionSampleTimesAttr.isValid())
+        const SessionOverride::MotionSampleTimesOverride motionOverride =
+            sessionOverride ? sessionOverride->motionSampleTimesOverride
+                            : SessionOverride::MotionSampleTimesNone;
+        if (motionOverride == SessionOverride::MotionSampleTimesDefaults)
         {
             // Interpret an IntAttribute as "use usdInArgs defaults"
             //
-            if (motionSampleTimesAttr.getType() == kFnKatAttributeTypeInt)
-            {
-                _motionSampleTimesOverride = usdInArgs->GetMotionSampleTimes();
-                break;
-            }
+            motionSampleTimesOverride = usdInArgs->GetMotionSampleTimes();
+            break;
+        }
+        if (motionOverride == SessionOverride::MotionSampleTimesExplicit)
+        {
             // Interpret a FloatAttribute as an explicit value override
             //
-            if (motionSampleTimesAttr.getType() == kFnKatAttributeTypeFloat)
+            if (useDefaultMotionSamples)
             {
-                FnAttribute::FloatAttribute attr(motionSampleTimesAttr);
-                const auto& sampleTimes = attr.getNearestSample(0.0f);;
-                if (!sampleTimes.empty())
-                {
-                    if (useDefaultMotionSamples)
-                    {
-                        // Clear out default samples before adding overrides
-                        _motionSampleTimesOverride.clear();
-                    }
-                    for (float sampleTime : sampleTimes)
-                        _motionSampleTimesOverride.push_back(
-                            (double)sampleTime);
-                    break;
-                }
+                // Clear out default samples before adding overrides
+                motionSampleTimesOverride.clear();
             }
+            motionSampleTimesOverride.insert(motionSampleTimesOverride.end(),
+                                             sessionOverride->motionSampleTimes.begin(),
+                                             sessionOverride->motionSampleTimes.end());
+            break;
         }
-        else if (parentData && !useDefaultMotionSamples)
+        if (motionOverride == SessionOverride::MotionSampleTimesNone && parentData &&
+            !useDefaultMotionSamples)
         {
-            _motionSampleTimesOverride =
-                    parentData->_motionSampleTimesOverride;
+            inheritsParentOverride = true;
         }
     }
     if (parentData)
     {
-        _motionSampleTimesFallback = parentData->GetMotionSampleTimes();
+        const _MotionSampleTimes& parentTimes = *parentData->_motionSampleTimes;
+        const std::vector<double>& overrideTimes =
+            inheritsParentOverride ? parentTimes.overrideTimes : motionSampleTimesOverride;
+        const std::vector<double>& fallbackTimes = parentData->_GetDefaultMotionSampleTimes();
+        if (overrideTimes == parentTimes.overrideTimes &&
+            fallbackTimes == parentTimes.fallbackTimes)
+        {
+            _motionSampleTimes = parentData->_motionSampleTimes;
+        }
+        else
+        {
+            _motionSampleTimes =
+                std::make_shared<const _MotionSampleTimes>(
+                    _MotionSampleTimes{overrideTimes, fallbackTimes});
+        }
     }
     else
     {
-        _motionSampleTimesFallback = usdInArgs->GetMotionSampleTimes();
+        std::vector<double> motionSampleTimesFallback = usdInArgs->GetMotionSampleTimes();
 
         // Apply time scaling.
         //
-        if (_motionSampleTimesFallback.size() > 0)
+        if (motionSampleTimesFallback.size() > 0)
         {
-            const double firstSample = _motionSampleTimesFallback[0];
-            for (size_t i = 0; i < _motionSampleTimesFallback.size(); ++i)
+            const double firstSample = motionSampleTimesFallback[0];
+            for (size_t i = 0; i < motionSampleTimesFallback.size(); ++i)
             {
-                _motionSampleTimesFallback[i] =
-                    firstSample + ((_motionSampleTimesFallback[i] - firstSample) *
+                motionSampleTimesFallback[i] =
+                    firstSample + ((motionSampleTimesFallback[i] - firstSample) *
                                    timeScaleRatio);
             }
         }
+
+        _motionSampleTimes = std::make_shared<const _MotionSampleTimes>(_MotionSampleTimes{
+            std::move(motionSampleTimesOverride), std::move(motionSampleTimesFallback)});
     }
 
 
     if (parentData)
     {
-        _collectionQueryCache = parentData->_collectionQueryCache;
-        _bindingsCache = parentData->_bindingsCache;
-
         _instancePrototypeMapping = parentData->_instancePrototypeMapping;
     }
 
-    if (!_collectionQueryCache)
-    {
-        _collectionQueryCache.reset(
-                new UsdShadeMaterialBindingAPI::CollectionQueryCache);
-    }
-
-    TfTokenVector purposes = _usdInArgs->GetMaterialBindingPurposes();
-    if (std::find(purposes.begin(), purposes.end(), UsdShadeTokens->allPurpose) == purposes.end())
-    {
-        purposes.emplace_back(UsdShadeTokens->allPurpose);
-    }
-    for (const TfToken& purpose : purposes)
-    {
-        _bindingsCache[purpose].reset(new UsdShadeMaterialBindingAPI::BindingsCache);
-    }
-
     _evaluateUsdSkelBindings = _usdInArgs->GetEvaluateUsdSkelBindings();
 }
 
 bool UsdKatanaUsdInPrivateData::IsMotionBackward() const
 {
-    if (_motionSampleTimesOverride.size() > 0)
+    const std::vector<double>& motionSampleTimes = _motionSampleTimes->overrideTimes.size() > 0
+                                                       ? _motionSampleTimes->overrideTimes
+                                                       : _motionSampleTimes->fallbackTimes;
+    return (motionSampleTimes.size() > 1 &&
+        motionSampleTimes.front() > motionSampleTimes.back());
+}
+
+const std::vector<double>& UsdKatanaUsdInPrivateData::_GetDefaultMotionSampleTimes() const
+{
+    // Equivalent to GetMotionSampleTimes() without an attribute, without the copy.
+    static const std::vector<double> noMotion = {0.0};
+    if (_motionSampleTimes->fallbackTimes.size() < 2)
     {
-        return (_motionSampleTimesOverride.size() > 1 &&
-            _motionSampleTimesOverride.front() >
-            _motionSampleTimesOverride.back());
+        return noMotion;
     }
-    else
+    if (_motionSampleTimes->overrideTimes.size() > 0)
     {
-        return (_motionSampleTimesFallback.size() > 1 &&
-            _motionSampleTimesFallback.front() >
-            _motionSampleTimesFallback.back());
+        return _motionSampleTimes->overrideTimes;
     }
+    return _motionSampleTimes->fallbackTimes;
 }
 
 std::vector<UsdKatanaUsdInPrivateData::UsdKatanaTimePair>
@@ -433,19 +420,19 @@ const std::vector<double> UsdKatanaUsdInPrivateData::GetSkelMotionSampleTimes(
     static std::vector<double> noMotion = {0.0};
     // If the UsdIn node does not explicitly set a fallback motion sample setting,
     // return no motion, since it is not requested.
-    if (_motionSampleTimesFallback.size() < 2)
+    if (_motionSampleTimes->fallbackTimes.size() < 2)
     {
         return noMotion;
     }
     // If an override was explicitly specified for this prim, return it.
-    if (_motionSampleTimesOverride.size() > 0)
+    if (_motionSampleTimes->overrideTimes.size() > 0)
     {
-        return _motionSampleTimesOverride;
+        return _motionSampleTimes->overrideTimes;
     }
     // Early exit if we don't have a valid UsdSkel Animation Query.
     if (!skelAnimQuery)
     {
-        return _motionSampleTimesFallback;
+        return _motionSampleTimes->fallbackTimes;
     }
     // Store whether the joint of blend samples are actually animated.
     bool hasJointTransformSamples = skelAnimQuery.JointTransformsMightBeTimeVarying();
@@ -477,15 +464,15 @@ const std::vector<double> UsdKatanaUsdInPrivateData::GetSkelMotionSampleTimes(
             GfInterval(shutterStartTime, shutterCloseTime), &blendShapeMotionSampleTimes))
     {
         blendShapeMotionSampleTimes.insert(blendShapeMotionSampleTimes.begin(),
-                                           _motionSampleTimesFallback.begin(),
-                                           _motionSampleTimesFallback.end());
+                                           _motionSampleTimes->fallbackTimes.begin(),
+                                           _motionSampleTimes->fallbackTimes.end());
     }
     if (!skelAnimQuery.GetJointTransformTimeSamplesInInterval(
             GfInterval(shutterStartTime, shutterCloseTime), &jointTransformMotionSampleTimes))
     {
         jointTransformMotionSampleTimes.insert(jointTransformMotionSampleTimes.begin(),
-                                               _motionSampleTimesFallback.begin(),
-                                               _motionSampleTimesFallback.end());
+                                               _motionSampleTimes->fallbackTimes.begin(),
+                                               _motionSampleTimes->fallbackTimes.end());
     }
     std::vector<double> blendShapeTimes, jointTransformTimes;
     skelAnimQuery.GetBlendShapeWeightTimeSamples(&blendShapeTimes);
@@ -581,16 +568,16 @@ const std::vector<double> UsdKatanaUsdInPrivateData::GetMotionSampleTimes(
     static std::vector<double> noMotion = {0.0};
 
     if ((attr && !UsdKatanaUtils::IsAttributeVarying(attr, _currentTime)) ||
-        _motionSampleTimesFallback.size() < 2)
+        _motionSampleTimes->fallbackTimes.size() < 2)
     {
         return noMotion;
     }
 
     // If an override was explicitly specified for this prim, return it.
     //
-    if (_motionSampleTimesOverride.size() > 0)
+    if (_motionSampleTimes->overrideTimes.size() > 0)
     {
-        return _motionSampleTimesOverride;
+        return _motionSampleTimes->overrideTimes;
     }
 
     //
@@ -602,7 +589,7 @@ const std::vector<double> UsdKatanaUsdInPrivateData::GetMotionSampleTimes(
     //
     if (!attr)
     {
-        return _motionSampleTimesFallback;
+        return _motionSampleTimes->fallbackTimes;
     }
 
     // Allowable error in sample time comparison.
@@ -628,7 +615,7 @@ const std::vector<double> UsdKatanaUsdInPrivateData::GetMotionSampleTimes(
     if (!attr.GetTimeSamplesInInterval(
             GfInterval(shutterStartTime, shutterCloseTime), &result))
     {
-        return _motionSampleTimesFallback;
+        return _motionSampleTimes->fallbackTimes;
     }
 
     bool foundSamplesInInterval = !result.empty();
@@ -762,15 +749,13 @@ FnAttribute::GroupAttribute UsdKatanaUsdInPrivateData::updateExtensionOpArgs(
 UsdShadeMaterialBindingAPI::CollectionQueryCache*
 UsdKatanaUsdInPrivateData::GetCollectionQueryCache() const
 {
-    return _collectionQueryCache.get();
-   
+    return _usdInArgs->GetCollectionQueryCache();
 }
 
 UsdShadeMaterialBindingAPI::BindingsCache* UsdKatanaUsdInPrivateData::GetBindingsCache(
     const TfToken& purpose) const
 {
-    auto purposeBindings = _bindingsCache.find(purpose);
-    return purposeBindings != _bindingsCache.end() ? purposeBindings->second.get() : nullptr;
+    return _usdInArgs->GetBindingsCache(purpose);
 }
 
 UsdKatanaUsdInPrivateData* UsdKatanaUsdInPrivateData::GetPrivateData(
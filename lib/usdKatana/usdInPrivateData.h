@@ -32,6 +32,7 @@
 
 #include <map>
 #include <memory>
+#include <vector>
 
 #include <pxr/pxr.h>
 #include <pxr/usd/usd/prim.h>
@@ -99,11 +100,12 @@ public:
 
     bool hasOutputTarget(const std::string& renderer) const
     {
-        return _outputTargets.find(renderer) != _outputTargets.end();
+        const std::set<std::string>& outputTargets = _usdInArgs->GetOutputTargets();
+        return outputTargets.find(renderer) != outputTargets.end();
     }
 
     const std::set<std::string>& GetOutputTargets(std::string renderer) const {
-        return _outputTargets;
+        return _usdInArgs->GetOutputTargets();
     }
 
     /// \brief Return true if motion blur is backward.
@@ -180,7 +182,8 @@ public:
             FnAttribute::GroupAttribute opArgs) const;
 
     /// \brief Access to shared caches relevant to efficient binding of materials across the
-    ///        hierarchy.
+    ///        hierarchy. These are owned by the UsdKatanaUsdInArgs so that they are shared by
+    ///        every location rather than rebuilt for each one.
     UsdShadeMaterialBindingAPI::CollectionQueryCache* GetCollectionQueryCache() const;
     UsdShadeMaterialBindingAPI::BindingsCache* GetBindingsCache(
         const TfToken& purpose = UsdShadeTokens->allPurpose) const;
@@ -199,6 +202,18 @@ public:
     USDKATANA_API const FnKat::GroupAttribute& getInstancePrototypeMapping() const;
 
 private:
+    /// \brief Resolved motion sample times of a location. These are immutable once built, so
+    ///        children which resolve to the same times as their parent share its instance
+    ///        rather than copying the vectors.
+    struct _MotionSampleTimes
+    {
+        std::vector<double> overrideTimes;
+        std::vector<double> fallbackTimes;
+    };
+    typedef std::shared_ptr<const _MotionSampleTimes> _MotionSampleTimesConstPtr;
+
+    /// Returns the motion sample times used when no attribute is given.
+    const std::vector<double>& _GetDefaultMotionSampleTimes() const;
 
     UsdPrim _prim;
 
@@ -211,23 +226,12 @@ private:
     double _shutterOpen;
     double _shutterClose;
 
-    std::vector<double> _motionSampleTimesOverride;
-    std::vector<double> _motionSampleTimesFallback;
+    _MotionSampleTimesConstPtr _motionSampleTimes;
 
-    std::set<std::string> _outputTargets;
-    
     mutable FnAttribute::GroupBuilder * _extGb;
 
     FnAttribute::GroupAttribute _instancePrototypeMapping;
 
-    typedef std::shared_ptr<UsdShadeMaterialBindingAPI::CollectionQueryCache>
-            _CollectionQueryCachePtr;
-    typedef std::shared_ptr<UsdShadeMaterialBindingAPI::BindingsCache> _BindingsCachePtr;
-    typedef std::map<TfToken, _BindingsCachePtr> _PurposeBasedBindingsCache;
-
-    _CollectionQueryCachePtr _collectionQueryCache;
-    _PurposeBasedBindingsCache _bindingsCache;
-
     bool _evaluateUsdSkelBindings{true};
 };
 
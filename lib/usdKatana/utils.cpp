@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <cmath>
 #include <map>
+#include <numeric>
 #include <sstream>
 #include <unordered_map>
 
@@ -43,6 +44,9 @@
 #include <pxr/base/gf/vec3f.h>
 #include <pxr/base/gf/vec3h.h>
 #include <pxr/base/tf/getenv.h>
+#include <pxr/base/tf/hash.h>
+#include <pxr/base/tf/registryManager.h>
+#include <pxr/base/tf/smallVector.h>
 #include <pxr/base/vt/array.h>
 #include <pxr/base/vt/value.h>
 #include <pxr/base/work/loops.h>
@@ -79,6 +83,8 @@
 #include <boost/filesystem.hpp>
 #include <boost/regex.hpp>
 
+#include <tbb/concurrent_unordered_map.h>
+
 #include "vtKatana/array.h"
 #include "vtKatana/value.h"
 
@@ -86,6 +92,9 @@
 #include "usdKatana/blindDataObject.h"
 #include "usdKatana/childMaterialAPI.h"
 #include "usdKatana/debugCodes.h"
+#include "usdKatana/prototypeMappingCache.h"
+#include "usdKatana/skinningCache.h"
+#include "usdKatana/valueConverterRegistry.h"
 
 FnLogSetup("UsdKatanaUtils");
 
@@ -175,11 +184,13 @@ void ApplyJointAnimation(const UsdSkelSkinningQuery& skinningQuery,
                          const UsdSkelSkeletonQuery& skelQuery,
                          const double time,
                          VtVec3fArray& points,
-                         const UsdKatanaUsdInPrivateData& data)
+                         const UsdKatanaUsdInPrivateData& data,
+                         UsdKatanaSkinningCache& skinningCache)
 {
-    // Get the skinning transform from the skeleton.
+    // Get the skinning transform from the skeleton. These are shared by every
+    // mesh bound to the same skeleton, so fetch them through the cache.
     VtMatrix4dArray skinningXforms;
-    skelQuery.ComputeSkinningTransforms(&skinningXforms, time);
+    skinningCache.ComputeSkinningTransforms(skelQuery, time, &skinningXforms);
     // Get the prim's points first and then skin them.
     skinningQuery.ComputeSkinnedPoints(skinningXforms, &points, time);
 
@@ -298,6 +309,20 @@ void UsdKatanaUtils::ConvertNumVertsToStartVerts(const std::vector<int>& numVert
     }
 }
 
+void UsdKatanaUtils::ConvertNumVertsToStartVerts(const VtIntArray& numVertsArray,
+                                                 VtIntArray* startVertsArray)
+{
+    const size_t numFaces = numVertsArray.size();
+    startVertsArray->resize(numFaces + 1);
+    int* startVerts = startVertsArray->data();
+    const int* numVerts = numVertsArray.cdata();
+
+    // A plain exclusive scan over contiguous ints, which the compiler is free
+    // to vectorize.
+    std::exclusive_scan(numVerts, numVerts + numFaces, startVerts, 0);
+    startVerts[numFaces] = numFaces > 0 ? startVerts[numFaces - 1] + numVerts[numFaces - 1] : 0;
+}
+
 void UsdKatanaUtils::ConvertArrayToVector(const VtVec3fArray& a, std::vector<float>* r)
 {
     r->resize(a.size()*3);
@@ -312,246 +337,13 @@ void UsdKatanaUtils::ConvertArrayToVector(const VtVec3fArray& a, std::vector<flo
 
 FnKat::Attribute UsdKatanaUtils::ConvertVtValueToKatAttr(const VtValue& val, bool asShaderParam)
 {
-    if (val.IsHolding<bool>()) {
-        return FnKat::IntAttribute(int(val.UncheckedGet<bool>()));
-    }
-    if (val.IsHolding<int>()) {
-        return FnKat::IntAttribute(val.UncheckedGet<int>());
-    }
-    if (val.IsHolding<uint32_t>()) {
-        // Lossy translation of 32bit unsigned int to int
-        return FnKat::IntAttribute(static_cast<int>(val.UncheckedGet<uint32_t>()));
-    }
-    if (val.IsHolding<float>()) {
-        return FnKat::FloatAttribute(val.UncheckedGet<float>());
-    }
-    if (val.IsHolding<double>()) {
-        return FnKat::DoubleAttribute(val.UncheckedGet<double>());
-    }
-    if (val.IsHolding<std::string>()) {
-        if (val.UncheckedGet<std::string>() == "_NO_VALUE_") {
-            return FnKat::NullAttribute();
-        }
-        else {
-            return FnKat::StringAttribute(val.UncheckedGet<std::string>());
-        }
-    }
-    if (val.IsHolding<SdfAssetPath>()) {
-        const SdfAssetPath& assetPath(val.UncheckedGet<SdfAssetPath>());
-        return FnKat::StringAttribute(_ResolveAssetPath(assetPath));
-    }
-    if (val.IsHolding<TfToken>()) {
-        const TfToken &myVal = val.UncheckedGet<TfToken>();
-        return FnKat::StringAttribute(myVal.GetString());
-    }
-
-    // Compound types require special handling.  Because they do not
-    // correspond 1:1 to Fn attribute types, we must describe the
-    // type as a separate attribute.
-    FnKat::Attribute typeAttr;
-    FnKat::Attribute valueAttr;
-
-    if (val.IsHolding<VtArray<std::string> >()) {
-        const auto& array = val.UncheckedGet<VtArray<std::string> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        typeAttr = FnKat::StringAttribute(
-            TfStringPrintf("string [%zu]", array.size()));
-    }
-
-    else if (val.IsHolding<VtArray<TfToken> >()) {
-        const auto& array = val.UncheckedGet<VtArray<TfToken> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        typeAttr = FnKat::StringAttribute(
-            TfStringPrintf("string [%zu]", array.size()));
-    }
-
-    else if (val.IsHolding<VtArray<int> >()) {
-        const VtArray<int> array = val.UncheckedGet<VtArray<int> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        typeAttr = FnKat::StringAttribute(
-            TfStringPrintf("int [%zu]", array.size()));
-    }
-
-    else if (val.IsHolding<VtArray<unsigned> >()) {
-        // Lossy translation of array<unsigned> to array<int>
-        // No warning is printed as they obscure more important warnings
-        const VtArray<unsigned> array = val.Get<VtArray<unsigned> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        typeAttr = FnKat::StringAttribute(
-            TfStringPrintf("unsigned [%zu]", array.size()));
-    }
-
-    else if (val.IsHolding<VtArray<long> >()) {
-        // Lossy translation of array<long> to array<int>
-        // No warning is printed as they obscure more important warnings
-        const VtArray<long> array = val.Get<VtArray<long> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        typeAttr = FnKat::StringAttribute(
-            TfStringPrintf("long [%zu]", array.size()));
-    }
-
-    else if (val.IsHolding<VtArray<float> >()) {
-        const VtArray<float> array = val.UncheckedGet<VtArray<float> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        typeAttr = FnKat::StringAttribute(
-            TfStringPrintf("float [%zu]", array.size()));
-    }
-    else if (val.IsHolding<VtArray<double> >()) {
-        const VtArray<double> array = val.UncheckedGet<VtArray<double> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        typeAttr = FnKat::StringAttribute(
-            TfStringPrintf("double [%zu]", array.size()));
-    }
-
-    // XXX: Should matrices also be brought in as doubles?
-    // What implications does this have? xform.matrix is handled explicitly as
-    // a double, and apparently we don't use GfMatrix4f.
-    // Shader parameter floats might expect a float matrix?
-    if (val.IsHolding<VtArray<GfMatrix4d> >()) {
-        const VtArray<GfMatrix4d> rawVal = val.UncheckedGet<VtArray<GfMatrix4d> >();
-        std::vector<float> vec;
-        TF_FOR_ALL(mat, rawVal) {
-             for (int i=0; i < 4; ++i) {
-                 for (int j=0; j < 4; ++j) {
-                     vec.push_back( static_cast<float>((*mat)[i][j]) );
-                 }
-             }
-         }
-         FnKat::FloatBuilder builder(/* tupleSize = */ 16);
-         builder.set(vec);
-         valueAttr = builder.build();
-         typeAttr = FnKat::StringAttribute(
-             TfStringPrintf("matrix [%zu]", rawVal.size()));
-    }
-
-    // GfVec2f
-    else if (val.IsHolding<GfVec2f>()) {
-        const GfVec2f rawVal = val.UncheckedGet<GfVec2f>();
-        valueAttr = VtKatanaCopy(rawVal);
-        typeAttr = FnKat::StringAttribute("float [2]");
-    }
-
-    // GfVec2d
-    else if (val.IsHolding<GfVec2d>()) {
-        const GfVec2d rawVal = val.UncheckedGet<GfVec2d>();
-        valueAttr = VtKatanaCopy(rawVal);
-        typeAttr = FnKat::StringAttribute("double [2]");
-    }
-
-    // GfVec3f
-    else if (val.IsHolding<GfVec3f>()) {
-        const GfVec3f rawVal = val.UncheckedGet<GfVec3f>();
-        valueAttr = VtKatanaCopy(rawVal);
-        typeAttr = FnKat::StringAttribute("float [3]");
-    }
-
-    // GfVec3d
-    else if (val.IsHolding<GfVec3d>()) {
-        const GfVec3d rawVal = val.UncheckedGet<GfVec3d>();
-        valueAttr = VtKatanaCopy(rawVal);
-        typeAttr = FnKat::StringAttribute("double [3]");
-    }
-
-    // GfVec4f
-    else if (val.IsHolding<GfVec4f>()) {
-        const GfVec4f rawVal = val.UncheckedGet<GfVec4f>();
-        valueAttr = VtKatanaCopy(rawVal);
-        typeAttr = FnKat::StringAttribute("float [4]");
-    }
-
-    // GfVec4d
-    else if (val.IsHolding<GfVec4d>()) {
-        const GfVec4d rawVal = val.UncheckedGet<GfVec4d>();
-        valueAttr = VtKatanaCopy(rawVal);
-        typeAttr = FnKat::StringAttribute("double [4]");
-    }
-
-    // GfMatrix4d
-    // XXX: Should matrices also be brought in as doubles?
-    // What implications does this have? xform.matrix is handled explicitly as
-    // a double, and apparently we don't use GfMatrix4f.
-    // Shader parameter floats might expect a float matrix?
-    else if (val.IsHolding<GfMatrix4d>()) {
-        const GfMatrix4d rawVal = val.UncheckedGet<GfMatrix4d>();
-        FnKat::FloatBuilder builder(/* tupleSize = */ 16);
-        std::vector<float> vec;
-        vec.resize(16);
-        for (int i=0; i < 4; ++i) {
-            for (int j=0; j < 4; ++j) {
-                vec[i*4+j] = static_cast<float>(rawVal[i][j]);
-            }
-        }
-        builder.set(vec);
-        typeAttr = FnKat::StringAttribute("matrix [1]");
-        valueAttr = builder.build();
-    }
-
-    // TODO: support complex types such as primvars
-    // VtArray<GfVec4f>
-    else if (val.IsHolding<VtArray<GfVec4f> >()) {
-        const VtArray<GfVec4f> array = val.UncheckedGet<VtArray<GfVec4f> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        // NOTE: needs typeAttr set?
-    }
-
-    // VtArray<GfVec3f>
-    else if (val.IsHolding<VtArray<GfVec3f> >()) {
-        const VtArray<GfVec3f> array = val.UncheckedGet<VtArray<GfVec3f> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        // NOTE: needs typeAttr set?
-    }
-
-    // VtArray<GfVec2f>
-    else if (val.IsHolding<VtArray<GfVec2f> >()) {
-        const VtArray<GfVec2f> array = val.UncheckedGet<VtArray<GfVec2f> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        // NOTE: needs typeAttr set?
-    }
-
-    // VtArray<GfVec4d>
-    else if (val.IsHolding<VtArray<GfVec4d> >()) {
-        const VtArray<GfVec4d> array = val.UncheckedGet<VtArray<GfVec4d> >();
-	valueAttr = VtKatanaMapOrCopy(array);
-        // NOTE: needs typeAttr set?
-    }
-
-    // VtArray<GfVec3d>
-    else if (val.IsHolding<VtArray<GfVec3d> >()) {
-        const VtArray<GfVec3d> array = val.UncheckedGet<VtArray<GfVec3d> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        // NOTE: needs typeAttr set?
-    }
-
-    // VtArray<GfVec2d>
-    else if (val.IsHolding<VtArray<GfVec2d> >()) {
-        const VtArray<GfVec2d> array = val.UncheckedGet<VtArray<GfVec2d> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        // NOTE: needs typeAttr set?
-    }
-
-    // VtArray<SdfAssetPath>
-    else if (val.IsHolding<VtArray<SdfAssetPath> >()) {
-        // This will replicate the previous behavior:
-        // if (asShaderParam) return valueAttr; asShaderParam = false;
-        const VtArray<SdfAssetPath> &array = val.UncheckedGet<VtArray<SdfAssetPath> >();
-        valueAttr = VtKatanaMapOrCopy(array);
-        typeAttr = FnKat::StringAttribute(
-            TfStringPrintf("string [%zu]", array.size()));
-    }
-
-    // If being used as a shader param, the type will be provided elsewhere,
-    // so simply return the value attribute as-is.
-    if (asShaderParam) {
-        return valueAttr;
-    }
-    // Otherwise, return the type & value in a group.
-    if (typeAttr.isValid() && valueAttr.isValid()) {
-        FnKat::GroupBuilder groupBuilder;
-        groupBuilder.set("type", typeAttr);
-        groupBuilder.set("value", valueAttr);
-        return groupBuilder.build();
+    const UsdKatanaValueConverterRegistry::AttrConverter* converter =
+        UsdKatanaValueConverterRegistry::GetInstance().GetAttrConverter(val.GetTypeid());
+    if (!converter)
+    {
+        return FnKat::Attribute();
     }
-    return FnKat::Attribute();
+    return (*converter)(val, asShaderParam);
 }
 
 FnKat::Attribute UsdKatanaUtils::ConvertRelTargetsToKatAttr(const UsdRelationship& rel,
@@ -688,33 +480,229 @@ _KTypeAndSizeFromUsdVec4(TfToken const &roleName,
     return true;
 }
 
-static bool
-_KTypeAndSizeFromUsdVec2(TfToken const &roleName,
-                         FnKat::Attribute *inputTypeAttr,
-                         FnKat::Attribute *elementSizeAttr)
+namespace {
+
+// Compound types require special handling.  Because they do not
+// correspond 1:1 to Fn attribute types, we must describe the
+// type as a separate attribute.
+FnKat::Attribute _ValueAndTypeAttr(const FnKat::Attribute& valueAttr,
+                                   const FnKat::Attribute& typeAttr,
+                                   bool asShaderParam)
 {
-    if (roleName.IsEmpty()) {
-        // Deserves explanation: there is no type in prman
-        // (or apparently, katana) that represents
-        // "a 2-vector with no additional behavior/meaning.
-        // UVs fall into this category.  In our pipeline,
-        // we have chosen to represent this as float[2] to
-        // renderers.
-        *inputTypeAttr = FnKat::StringAttribute("float");
-        *elementSizeAttr = FnKat::IntAttribute(2);
-    } else {
-        return false;
+    // If being used as a shader param, the type will be provided elsewhere,
+    // so simply return the value attribute as-is.
+    if (asShaderParam) {
+        return valueAttr;
     }
-    return true;
+    // Otherwise, return the type & value in a group.
+    if (typeAttr.isValid() && valueAttr.isValid()) {
+        FnKat::GroupBuilder groupBuilder;
+        groupBuilder.set("type", typeAttr);
+        groupBuilder.set("value", valueAttr);
+        return groupBuilder.build();
+    }
+    return FnKat::Attribute();
 }
 
-void UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr(const VtValue& val,
-                                                       int elementSize,
-                                                       const TfToken& roleName,
-                                                       FnKat::Attribute* valueAttr,
-                                                       FnKat::Attribute* inputTypeAttr,
-                                                       FnKat::Attribute* elementSizeAttr)
+// XXX: Should matrices also be brought in as doubles?
+// What implications does this have? xform.matrix is handled explicitly as
+// a double, and apparently we don't use GfMatrix4f.
+// Shader parameter floats might expect a float matrix?
+FnKat::FloatAttribute _ConvertMatrices(const GfMatrix4d* matrices, size_t numMatrices)
+{
+    std::vector<float> vec(numMatrices * 16);
+    for (size_t m = 0; m < numMatrices; ++m) {
+        for (int i=0; i < 4; ++i) {
+            for (int j=0; j < 4; ++j) {
+                vec[m*16+i*4+j] = static_cast<float>(matrices[m][i][j]);
+            }
+        }
+    }
+    FnKat::FloatBuilder builder(/* tupleSize = */ 16);
+    builder.set(vec);
+    return builder.build();
+}
+
+template <typename T>
+FnKat::Attribute _CopyToKatAttr(const T& value)
+{
+    return VtKatanaCopy(value);
+}
+
+template <typename T>
+FnKat::Attribute _CopyToKatAttr(const VtArray<T>& value)
+{
+    return VtKatanaMapOrCopy(value);
+}
+
+// Arrays converted with their type name and size, e.g. "int [3]".
+template <typename T>
+void _RegisterArrayAttrConverter(UsdKatanaValueConverterRegistry& registry,
+                                 const char* typeName)
 {
+    registry.RegisterAttrConverter<VtArray<T>>(
+        [typeName](const VtValue& val, bool asShaderParam) -> FnKat::Attribute {
+            const VtArray<T>& array = val.UncheckedGet<VtArray<T>>();
+            return _ValueAndTypeAttr(
+                VtKatanaMapOrCopy(array),
+                FnKat::StringAttribute(TfStringPrintf("%s [%zu]", typeName, array.size())),
+                asShaderParam);
+        });
+}
+
+// Values converted with a fixed type name, e.g. "float [3]".
+template <typename T>
+void _RegisterTypedAttrConverter(UsdKatanaValueConverterRegistry& registry,
+                                 const char* typeName)
+{
+    registry.RegisterAttrConverter<T>(
+        [typeName](const VtValue& val, bool asShaderParam) -> FnKat::Attribute {
+            return _ValueAndTypeAttr(_CopyToKatAttr(val.UncheckedGet<T>()),
+                                     FnKat::StringAttribute(typeName), asShaderParam);
+        });
+}
+
+// TODO: support complex types such as primvars
+// These are only converted as shader parameters, as they have no type
+// attribute.
+template <typename T>
+void _RegisterUntypedAttrConverter(UsdKatanaValueConverterRegistry& registry)
+{
+    registry.RegisterAttrConverter<T>(
+        [](const VtValue& val, bool asShaderParam) -> FnKat::Attribute {
+            return _ValueAndTypeAttr(_CopyToKatAttr(val.UncheckedGet<T>()), FnKat::Attribute(),
+                                     asShaderParam);
+        });
+}
+
+// Primvar arrays whose input type doesn't depend on their role.
+template <typename T>
+void _RegisterArrayGeomAttrConverter(UsdKatanaValueConverterRegistry& registry,
+                                     const char* inputType)
+{
+    registry.RegisterCustomGeomAttrConverter<VtArray<T>>(
+        [inputType](const VtValue& val,
+                    int elementSize,
+                    const TfToken& roleName,
+                    FnKat::Attribute* valueAttr,
+                    FnKat::Attribute* inputTypeAttr,
+                    FnKat::Attribute* elementSizeAttr) {
+            *valueAttr = VtKatanaMapOrCopy(val.UncheckedGet<VtArray<T>>());
+            *inputTypeAttr = FnKat::StringAttribute(inputType);
+            if (elementSize > 1) {
+                *elementSizeAttr = FnKat::IntAttribute(elementSize);
+            }
+        });
+}
+
+typedef bool (*_KTypeAndSizeFn)(TfToken const&,
+                                const char*,
+                                FnKat::Attribute*,
+                                FnKat::Attribute*);
+
+// Primvars whose input type and element size are derived from their role
+// by \p kTypeAndSize. Values with unsupported roles are left unconverted.
+template <typename T>
+void _RegisterVecGeomAttrConverter(UsdKatanaValueConverterRegistry& registry,
+                                   _KTypeAndSizeFn kTypeAndSize,
+                                   const char* typeStr)
+{
+    registry.RegisterCustomGeomAttrConverter<T>(
+        [kTypeAndSize, typeStr](const VtValue& val,
+                                int elementSize,
+                                const TfToken& roleName,
+                                FnKat::Attribute* valueAttr,
+                                FnKat::Attribute* inputTypeAttr,
+                                FnKat::Attribute* elementSizeAttr) {
+            if (kTypeAndSize(roleName, typeStr, inputTypeAttr, elementSizeAttr)) {
+                *valueAttr = _CopyToKatAttr(val.UncheckedGet<T>());
+            }
+        });
+}
+
+} // anon namespace
+
+TF_REGISTRY_FUNCTION(UsdKatanaValueConverterRegistry)
+{
+    UsdKatanaValueConverterRegistry& registry = UsdKatanaValueConverterRegistry::GetInstance();
+
+    //
+    // UsdKatanaUtils::ConvertVtValueToKatAttr
+    //
+
+    registry.RegisterAttrConverter<bool>([](const VtValue& val, bool) -> FnKat::Attribute {
+        return FnKat::IntAttribute(int(val.UncheckedGet<bool>()));
+    });
+    registry.RegisterAttrConverter<int>([](const VtValue& val, bool) -> FnKat::Attribute {
+        return FnKat::IntAttribute(val.UncheckedGet<int>());
+    });
+    registry.RegisterAttrConverter<uint32_t>([](const VtValue& val, bool) -> FnKat::Attribute {
+        // Lossy translation of 32bit unsigned int to int
+        return FnKat::IntAttribute(static_cast<int>(val.UncheckedGet<uint32_t>()));
+    });
+    registry.RegisterAttrConverter<float>([](const VtValue& val, bool) -> FnKat::Attribute {
+        return FnKat::FloatAttribute(val.UncheckedGet<float>());
+    });
+    registry.RegisterAttrConverter<double>([](const VtValue& val, bool) -> FnKat::Attribute {
+        return FnKat::DoubleAttribute(val.UncheckedGet<double>());
+    });
+    registry.RegisterAttrConverter<std::string>(
+        [](const VtValue& val, bool) -> FnKat::Attribute {
+            if (val.UncheckedGet<std::string>() == "_NO_VALUE_") {
+                return FnKat::NullAttribute();
+            }
+            return FnKat::StringAttribute(val.UncheckedGet<std::string>());
+        });
+    registry.RegisterAttrConverter<SdfAssetPath>(
+        [](const VtValue& val, bool) -> FnKat::Attribute {
+            return FnKat::StringAttribute(_ResolveAssetPath(val.UncheckedGet<SdfAssetPath>()));
+        });
+    registry.RegisterAttrConverter<TfToken>([](const VtValue& val, bool) -> FnKat::Attribute {
+        return FnKat::StringAttribute(val.UncheckedGet<TfToken>().GetString());
+    });
+
+    _RegisterArrayAttrConverter<std::string>(registry, "string");
+    _RegisterArrayAttrConverter<TfToken>(registry, "string");
+    _RegisterArrayAttrConverter<int>(registry, "int");
+    // Lossy translation of array<unsigned> and array<long> to array<int>
+    // No warning is printed as they obscure more important warnings
+    _RegisterArrayAttrConverter<unsigned>(registry, "unsigned");
+    _RegisterArrayAttrConverter<long>(registry, "long");
+    _RegisterArrayAttrConverter<float>(registry, "float");
+    _RegisterArrayAttrConverter<double>(registry, "double");
+    _RegisterArrayAttrConverter<SdfAssetPath>(registry, "string");
+
+    registry.RegisterAttrConverter<VtArray<GfMatrix4d>>(
+        [](const VtValue& val, bool asShaderParam) -> FnKat::Attribute {
+            const VtArray<GfMatrix4d>& array = val.UncheckedGet<VtArray<GfMatrix4d>>();
+            return _ValueAndTypeAttr(
+                _ConvertMatrices(array.cdata(), array.size()),
+                FnKat::StringAttribute(TfStringPrintf("matrix [%zu]", array.size())),
+                asShaderParam);
+        });
+    registry.RegisterAttrConverter<GfMatrix4d>(
+        [](const VtValue& val, bool asShaderParam) -> FnKat::Attribute {
+            return _ValueAndTypeAttr(_ConvertMatrices(&val.UncheckedGet<GfMatrix4d>(), 1),
+                                     FnKat::StringAttribute("matrix [1]"), asShaderParam);
+        });
+
+    _RegisterTypedAttrConverter<GfVec2f>(registry, "float [2]");
+    _RegisterTypedAttrConverter<GfVec2d>(registry, "double [2]");
+    _RegisterTypedAttrConverter<GfVec3f>(registry, "float [3]");
+    _RegisterTypedAttrConverter<GfVec3d>(registry, "double [3]");
+    _RegisterTypedAttrConverter<GfVec4f>(registry, "float [4]");
+    _RegisterTypedAttrConverter<GfVec4d>(registry, "double [4]");
+
+    _RegisterUntypedAttrConverter<VtArray<GfVec4f>>(registry);
+    _RegisterUntypedAttrConverter<VtArray<GfVec3f>>(registry);
+    _RegisterUntypedAttrConverter<VtArray<GfVec2f>>(registry);
+    _RegisterUntypedAttrConverter<VtArray<GfVec4d>>(registry);
+    _RegisterUntypedAttrConverter<VtArray<GfVec3d>>(registry);
+    _RegisterUntypedAttrConverter<VtArray<GfVec2d>>(registry);
+
+    //
+    // UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr
+    //
     // The following encoding is taken from Katana's
     // "LOCATIONS AND ATTRIBUTES" doc, which says this about
     // the "geometry.arbitrary.xxx" attributes:
@@ -730,268 +718,104 @@ void UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr(const VtValue& val,
     // TODO:
     // half4, color4, vector4, point4, matrix9
 
-    if (val.IsHolding<float>()) {
-        *valueAttr =  FnKat::FloatAttribute(val.Get<float>());
-        *inputTypeAttr = FnKat::StringAttribute("float");
-        *elementSizeAttr = FnKat::IntAttribute(elementSize);
-        // Leave elementSize empty.
-        return;
-    }
-    if (val.IsHolding<double>()) {
-        // XXX(USD) Kat says it supports double here -- should we preserve
-        // double-ness?
-        *valueAttr =
-            FnKat::DoubleAttribute(val.Get<double>());
-        *inputTypeAttr = FnKat::StringAttribute("double");
-        // Leave elementSize empty.
-        return;
-    }
-    if (val.IsHolding<int>()) {
-        *valueAttr = FnKat::IntAttribute(val.Get<int>());
-        *inputTypeAttr = FnKat::StringAttribute("int");
-        // Leave elementSize empty.
-        return;
-    }
-    if (val.IsHolding<std::string>()) {
-        // TODO: support NO_VALUE here?
-        // *valueAttr = FnKat::NullAttribute();
-        // *inputTypeAttr = FnKat::NullAttribute();
-        *valueAttr = FnKat::StringAttribute(val.Get<std::string>());
-        *inputTypeAttr = FnKat::StringAttribute("string");
-        // Leave elementSize empty.
-        return;
-    }
-    if (val.IsHolding<GfVec2f>()) {
-        if (_KTypeAndSizeFromUsdVec2(roleName, "float",
-                                     inputTypeAttr, elementSizeAttr)){
-            const GfVec2f rawVal = val.Get<GfVec2f>();
-            *valueAttr = VtKatanaCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<GfVec2d>()) {
-        if (_KTypeAndSizeFromUsdVec2(roleName, "double",
-                                     inputTypeAttr, elementSizeAttr)){
-            const GfVec2d rawVal = val.Get<GfVec2d>();
-            *valueAttr = VtKatanaCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<GfVec3f>()) {
-        if (_KTypeAndSizeFromUsdVec3(roleName, "float",
-                                     inputTypeAttr, elementSizeAttr)){
-            const GfVec3f rawVal = val.Get<GfVec3f>();
-            *valueAttr = VtKatanaCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<GfVec4f>()) {
-        if (_KTypeAndSizeFromUsdVec4(roleName, "float",
-                                     inputTypeAttr, elementSizeAttr)){
-            const GfVec4f rawVal = val.Get<GfVec4f>();
-            *valueAttr = VtKatanaCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<GfVec2f>()) {
-        if (_KTypeAndSizeFromUsdVec2(roleName, inputTypeAttr, elementSizeAttr)){
-            const GfVec2f rawVal = val.Get<GfVec2f>();
-            *valueAttr = VtKatanaCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<GfVec3d>()) {
-        if (_KTypeAndSizeFromUsdVec3(roleName, "double",
-                                     inputTypeAttr, elementSizeAttr)){
-            const GfVec3d rawVal = val.Get<GfVec3d>();
-            *valueAttr = VtKatanaCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<GfVec4d>()) {
-        if (_KTypeAndSizeFromUsdVec4(roleName, "double",
-                                     inputTypeAttr, elementSizeAttr)){
-            const GfVec4d rawVal = val.Get<GfVec4d>();
-            *valueAttr = VtKatanaCopy(rawVal);
-        }
-        return;
-    }
-    // XXX: Should matrices also be brought in as doubles?
-    // What implications does this have? xform.matrix is handled explicitly as
-    // a double, and apparently we don't use GfMatrix4f.
-    // Shader parameter floats might expect a float matrix?
-    if (val.IsHolding<GfMatrix4d>()) {
-        const GfMatrix4d rawVal = val.Get<GfMatrix4d>();
-        FnKat::FloatBuilder builder(/* tupleSize = */ 16);
-        std::vector<float> vec;
-        vec.resize(16);
-        for (int i=0; i < 4; ++i) {
-            for (int j=0; j < 4; ++j) {
-                vec[i*4+j] = static_cast<float>(rawVal[i][j]);
-            }
-        }
-        builder.set(vec);
-        *valueAttr = builder.build();
-        *inputTypeAttr = FnKat::StringAttribute("matrix16");
-        // Leave elementSize empty.
-        return;
-    }
-
-    if (val.IsHolding<VtArray<GfHalf> >()) {
-        if (_KTypeAndSizeFromUsdVec3(roleName, "float",
-                                     inputTypeAttr, elementSizeAttr)){
-            const VtArray<GfHalf> rawVal = val.Get<VtArray<GfHalf> >();
-            *valueAttr = VtKatanaMapOrCopy(rawVal);
-        }
-        return;
-    }
-
-    if (val.IsHolding<VtFloatArray>()) {
-        const VtFloatArray rawVal = val.Get<VtFloatArray>();
-        *valueAttr = VtKatanaMapOrCopy(rawVal);
-        *inputTypeAttr = FnKat::StringAttribute("float");
-        if (elementSize > 1) {
-            *elementSizeAttr = FnKat::IntAttribute(elementSize);
-        }
-        return;
-    }
-    if (val.IsHolding<VtDoubleArray>()) {
-        const VtDoubleArray rawVal = val.Get<VtDoubleArray>();
-        *valueAttr = VtKatanaMapOrCopy(rawVal);
-        *inputTypeAttr = FnKat::StringAttribute("double");
-        if (elementSize > 1) {
+    registry.RegisterCustomGeomAttrConverter<float>(
+        [](const VtValue& val, int elementSize, const TfToken&, FnKat::Attribute* valueAttr,
+           FnKat::Attribute* inputTypeAttr, FnKat::Attribute* elementSizeAttr) {
+            *valueAttr = FnKat::FloatAttribute(val.UncheckedGet<float>());
+            *inputTypeAttr = FnKat::StringAttribute("float");
             *elementSizeAttr = FnKat::IntAttribute(elementSize);
-        }
-        return;
-    }
-    // XXX: Should matrices also be brought in as doubles?
-    // What implications does this have? xform.matrix is handled explicitly as
-    // a double, and apparently we don't use GfMatrix4f.
-    // Shader parameter floats might expect a float matrix?
-    if (val.IsHolding<VtArray<GfMatrix4d> >()) {
-        const VtArray<GfMatrix4d> rawVal = val.Get<VtArray<GfMatrix4d> >();
-        std::vector<float> vec;
-        TF_FOR_ALL(mat, rawVal) {
-            for (int i=0; i < 4; ++i) {
-                for (int j=0; j < 4; ++j) {
-                    vec.push_back( static_cast<float>((*mat)[i][j]) );
-                }
+        });
+    registry.RegisterCustomGeomAttrConverter<double>(
+        [](const VtValue& val, int, const TfToken&, FnKat::Attribute* valueAttr,
+           FnKat::Attribute* inputTypeAttr, FnKat::Attribute*) {
+            // XXX(USD) Kat says it supports double here -- should we preserve
+            // double-ness?
+            *valueAttr = FnKat::DoubleAttribute(val.UncheckedGet<double>());
+            *inputTypeAttr = FnKat::StringAttribute("double");
+            // Leave elementSize empty.
+        });
+    registry.RegisterCustomGeomAttrConverter<int>(
+        [](const VtValue& val, int, const TfToken&, FnKat::Attribute* valueAttr,
+           FnKat::Attribute* inputTypeAttr, FnKat::Attribute*) {
+            *valueAttr = FnKat::IntAttribute(val.UncheckedGet<int>());
+            *inputTypeAttr = FnKat::StringAttribute("int");
+            // Leave elementSize empty.
+        });
+    registry.RegisterCustomGeomAttrConverter<std::string>(
+        [](const VtValue& val, int, const TfToken&, FnKat::Attribute* valueAttr,
+           FnKat::Attribute* inputTypeAttr, FnKat::Attribute*) {
+            // TODO: support NO_VALUE here?
+            *valueAttr = FnKat::StringAttribute(val.UncheckedGet<std::string>());
+            *inputTypeAttr = FnKat::StringAttribute("string");
+            // Leave elementSize empty.
+        });
+    registry.RegisterCustomGeomAttrConverter<TfToken>(
+        [](const VtValue& val, int, const TfToken&, FnKat::Attribute* valueAttr,
+           FnKat::Attribute* inputTypeAttr, FnKat::Attribute*) {
+            *valueAttr = FnKat::StringAttribute(val.UncheckedGet<TfToken>().GetString());
+            *inputTypeAttr = FnKat::StringAttribute("string");
+        });
+    registry.RegisterCustomGeomAttrConverter<GfMatrix4d>(
+        [](const VtValue& val, int, const TfToken&, FnKat::Attribute* valueAttr,
+           FnKat::Attribute* inputTypeAttr, FnKat::Attribute*) {
+            *valueAttr = _ConvertMatrices(&val.UncheckedGet<GfMatrix4d>(), 1);
+            *inputTypeAttr = FnKat::StringAttribute("matrix16");
+            // Leave elementSize empty.
+        });
+    registry.RegisterCustomGeomAttrConverter<VtArray<GfMatrix4d>>(
+        [](const VtValue& val, int elementSize, const TfToken&, FnKat::Attribute* valueAttr,
+           FnKat::Attribute* inputTypeAttr, FnKat::Attribute* elementSizeAttr) {
+            const VtArray<GfMatrix4d>& array = val.UncheckedGet<VtArray<GfMatrix4d>>();
+            *valueAttr = _ConvertMatrices(array.cdata(), array.size());
+            *inputTypeAttr = FnKat::StringAttribute("matrix16");
+            if (elementSize > 1) {
+                *elementSizeAttr = FnKat::IntAttribute(elementSize);
             }
-        }
-        FnKat::FloatBuilder builder(/* tupleSize = */ 16);
-        builder.set(vec);
-        *valueAttr = builder.build();
-        *inputTypeAttr = FnKat::StringAttribute("matrix16");
-        if (elementSize > 1) {
-            *elementSizeAttr = FnKat::IntAttribute(elementSize);
-        }
-        return;
-    }
-    if (val.IsHolding<VtArray<GfVec2f> >()) {
-        if (_KTypeAndSizeFromUsdVec2(roleName, "float",
-                                     inputTypeAttr, elementSizeAttr)){
-            const VtArray<GfVec2f> rawVal = val.Get<VtArray<GfVec2f> >();
-            *valueAttr = VtKatanaMapOrCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<VtArray<GfVec2d> >()) {
-        if (_KTypeAndSizeFromUsdVec2(roleName, "double",
-                                     inputTypeAttr, elementSizeAttr)){
-            const VtArray<GfVec2d> rawVal = val.Get<VtArray<GfVec2d> >();
-            *valueAttr = VtKatanaMapOrCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<VtArray<GfVec3h> >()) {
-        if (_KTypeAndSizeFromUsdVec3(roleName, "float",
-                                     inputTypeAttr, elementSizeAttr)){
-            const VtArray<GfVec3h> rawVal = val.Get<VtArray<GfVec3h> >();
-            *valueAttr = VtKatanaMapOrCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<VtArray<GfVec3f> >()) {
-        if (_KTypeAndSizeFromUsdVec3(roleName, "float",
-                                     inputTypeAttr, elementSizeAttr)){
-            const VtArray<GfVec3f> rawVal = val.Get<VtArray<GfVec3f> >();
-            *valueAttr = VtKatanaMapOrCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<VtArray<GfVec3d> >()) {
-        if (_KTypeAndSizeFromUsdVec3(roleName, "double",
-                                     inputTypeAttr, elementSizeAttr)){
-            const VtArray<GfVec3d> rawVal = val.Get<VtArray<GfVec3d> >();
-            *valueAttr = VtKatanaMapOrCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<VtArray<GfVec4f> >()) {
-        if (_KTypeAndSizeFromUsdVec4(roleName, "float",
-                                     inputTypeAttr, elementSizeAttr)){
-            const VtArray<GfVec4f> rawVal = val.Get<VtArray<GfVec4f> >();
-            *valueAttr = VtKatanaMapOrCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<VtArray<GfVec4d> >()) {
-        if (_KTypeAndSizeFromUsdVec4(roleName, "double",
-                                     inputTypeAttr, elementSizeAttr)){
-            const VtArray<GfVec4d> rawVal = val.Get<VtArray<GfVec4d> >();
-            *valueAttr = VtKatanaMapOrCopy(rawVal);
-        }
-        return;
-    }
-    if (val.IsHolding<VtArray<int> >()) {
-        const VtArray<int> rawVal = val.Get<VtArray<int> >();
-        *valueAttr = VtKatanaMapOrCopy(rawVal);
-        *inputTypeAttr = FnKat::StringAttribute("int");
-        if (elementSize > 1) {
-            *elementSizeAttr = FnKat::IntAttribute(elementSize);
-        }
-        return;
-    }
-    if (val.IsHolding<VtArray<unsigned> >()) {
-        // Lossy translation of array<unsigned> to array<int>
-        // No warning is printed as they obscure more important warnings
-        const VtArray<unsigned> rawVal = val.Get<VtArray<unsigned> >();
-        *valueAttr = VtKatanaMapOrCopy(rawVal);
-        *inputTypeAttr = FnKat::StringAttribute("unsigned");
-        if (elementSize > 1) {
-            *elementSizeAttr = FnKat::IntAttribute(elementSize);
-        }
-        return;
-    }
-    if (val.IsHolding<VtArray<long> >()) {
-        // Lossy translation of array<long> to array<int>
-        // No warning is printed as they obscure more important warnings
-        const VtArray<long> rawVal = val.Get<VtArray<long> >();
-        *valueAttr = VtKatanaMapOrCopy(rawVal);
-        *inputTypeAttr = FnKat::StringAttribute("long");
-        if (elementSize > 1) {
-            *elementSizeAttr = FnKat::IntAttribute(elementSize);
-        }
-        return;
-    }
-    if (val.IsHolding<VtArray<std::string> >()) {
-        const VtArray<std::string> rawVal = val.Get<VtArray<std::string> >();
-        *valueAttr = VtKatanaMapOrCopy(rawVal);
-        *inputTypeAttr = FnKat::StringAttribute("string");
-        if (elementSize > 1) {
-            *elementSizeAttr = FnKat::IntAttribute(elementSize);
-        }
-        return;
-    }
-    if (val.IsHolding<TfToken>())
+        });
+
+    _RegisterVecGeomAttrConverter<GfVec2f>(registry, _KTypeAndSizeFromUsdVec2, "float");
+    _RegisterVecGeomAttrConverter<GfVec2d>(registry, _KTypeAndSizeFromUsdVec2, "double");
+    _RegisterVecGeomAttrConverter<GfVec3f>(registry, _KTypeAndSizeFromUsdVec3, "float");
+    _RegisterVecGeomAttrConverter<GfVec3d>(registry, _KTypeAndSizeFromUsdVec3, "double");
+    _RegisterVecGeomAttrConverter<GfVec4f>(registry, _KTypeAndSizeFromUsdVec4, "float");
+    _RegisterVecGeomAttrConverter<GfVec4d>(registry, _KTypeAndSizeFromUsdVec4, "double");
+
+    _RegisterVecGeomAttrConverter<VtArray<GfHalf>>(registry, _KTypeAndSizeFromUsdVec3, "float");
+    _RegisterVecGeomAttrConverter<VtArray<GfVec2f>>(registry, _KTypeAndSizeFromUsdVec2, "float");
+    _RegisterVecGeomAttrConverter<VtArray<GfVec2d>>(registry, _KTypeAndSizeFromUsdVec2, "double");
+    _RegisterVecGeomAttrConverter<VtArray<GfVec3h>>(registry, _KTypeAndSizeFromUsdVec3, "float");
+    _RegisterVecGeomAttrConverter<VtArray<GfVec3f>>(registry, _KTypeAndSizeFromUsdVec3, "float");
+    _RegisterVecGeomAttrConverter<VtArray<GfVec3d>>(registry, _KTypeAndSizeFromUsdVec3, "double");
+    _RegisterVecGeomAttrConverter<VtArray<GfVec4f>>(registry, _KTypeAndSizeFromUsdVec4, "float");
+    _RegisterVecGeomAttrConverter<VtArray<GfVec4d>>(registry, _KTypeAndSizeFromUsdVec4, "double");
+
+    _RegisterArrayGeomAttrConverter<float>(registry, "float");
+    _RegisterArrayGeomAttrConverter<double>(registry, "double");
+    _RegisterArrayGeomAttrConverter<int>(registry, "int");
+    // Lossy translation of array<unsigned> and array<long> to array<int>
+    // No warning is printed as they obscure more important warnings
+    _RegisterArrayGeomAttrConverter<unsigned>(registry, "unsigned");
+    _RegisterArrayGeomAttrConverter<long>(registry, "long");
+    _RegisterArrayGeomAttrConverter<std::string>(registry, "string");
+}
+
+void UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr(const VtValue& val,
+                                                       int elementSize,
+                                                       const TfToken& roleName,
+                                                       FnKat::Attribute* valueAttr,
+                                                       FnKat::Attribute* inputTypeAttr,
+                                                       FnKat::Attribute* elementSizeAttr)
+{
+    const UsdKatanaValueConverterRegistry::CustomGeomAttrConverter* converter =
+        UsdKatanaValueConverterRegistry::GetInstance().GetCustomGeomAttrConverter(
+            val.GetTypeid());
+    if (!converter)
     {
-        *valueAttr = FnKat::StringAttribute(val.Get<TfToken>().GetString());
-        *inputTypeAttr = FnKat::StringAttribute("string");
+        TF_WARN("Unsupported primvar value type: %s",
+                ArchGetDemangled(val.GetTypeid()).c_str());
         return;
     }
-
-    TF_WARN("Unsupported primvar value type: %s",
-            ArchGetDemangled(val.GetTypeid()).c_str());
+    (*converter)(val, elementSize, roleName, valueAttr, inputTypeAttr, elementSizeAttr);
 }
 
 std::string UsdKatanaUtils::GenerateShadingNodeHandle(const UsdPrim& shadingNode)
@@ -1016,16 +840,9 @@ std::string UsdKatanaUtils::GenerateShadingNodeHandle(const UsdPrim& shadingNode
     return name;
 }
 
-void
-_FindCameraPaths_Traversal( const UsdPrim &prim, SdfPathVector *result )
+static Usd_PrimFlagsPredicate
+_GetCameraTraversalPredicate()
 {
-    // Recursively traverse model hierarchy for camera prims.
-    // Note 1: this requires that either prim types be lofted above
-    //         payloads for all model references, or that models be loaded.
-    // Note 2: Obviously, we will not find cameras embedded within models.
-    //         We have made this restriction consciously to reduce the
-    //         latency of camera-enumeration
-
     // If set, this allows for better traversal for global attributes (camera list and light lists)
     // by utilizing USD Prim children filters to check for prims in the model hierarchy only,
     // rather than the default Prim child traversal.
@@ -1036,7 +853,20 @@ _FindCameraPaths_Traversal( const UsdPrim &prim, SdfPathVector *result )
     {
         flags = flags && UsdPrimIsModel;
     }
-    TF_FOR_ALL(child, prim.GetFilteredChildren(flags)) {
+    return flags;
+}
+
+void
+_FindCameraPaths_Traversal( const UsdPrim &prim, SdfPathVector *result )
+{
+    // Recursively traverse model hierarchy for camera prims.
+    // Note 1: this requires that either prim types be lofted above
+    //         payloads for all model references, or that models be loaded.
+    // Note 2: Obviously, we will not find cameras embedded within models.
+    //         We have made this restriction consciously to reduce the
+    //         latency of camera-enumeration
+
+    TF_FOR_ALL(child, prim.GetFilteredChildren(_GetCameraTraversalPredicate())) {
         if (child->IsA<UsdGeomCamera>()) {
             result->push_back(child->GetPath());
         }
@@ -1051,6 +881,21 @@ SdfPathVector UsdKatanaUtils::FindCameraPaths(const UsdStageRefPtr& stage)
     return result;
 }
 
+void UsdKatanaUtils::FindCameraPaths(const UsdPrim& prim, SdfPathVector* result)
+{
+    // Matches a traversal from the pseudo-root, which filters the top-level
+    // prim like any other child.
+    if (!prim || !_GetCameraTraversalPredicate()(prim))
+    {
+        return;
+    }
+    if (prim.IsA<UsdGeomCamera>())
+    {
+        result->push_back(prim.GetPath());
+    }
+    _FindCameraPaths_Traversal(prim, result);
+}
+
 // This works like UsdLuxListAPI::ComputeLightList() except it tries to
 // maintain the order discovered during traversal.
 static void
@@ -1141,6 +986,12 @@ SdfPathVector UsdKatanaUtils::FindLightPaths(const UsdStageRefPtr& stage)
     return result;
 }
 
+void UsdKatanaUtils::FindLightPaths(const UsdPrim& prim, SdfPathVector* result)
+{
+    std::set<SdfPath, SdfPath::FastLessThan> seen;
+    _Traverse(prim, UsdLuxListAPI::ComputeModeConsultModelHierarchyCache, seen, result);
+}
+
 std::string UsdKatanaUtils::ConvertUsdPathToKatLocation(const SdfPath& path,
                                                         const std::string& isolatePathString,
                                                         const std::string& rootPathString,
@@ -1558,65 +1409,60 @@ static const std::unordered_map<std::string, std::string> s_rendererToContextNam
 static const std::unordered_map<std::string, std::string> s_contextNameToRenderer{{"ri", "prman"},
                                                                                   {"dl", "nsi"}};
 
-void UsdKatanaUtils::ShaderToAttrsBySdr(const UsdPrim& prim,
-                                        const std::string& shaderName,
-                                        const UsdTimeCode& currentTimeCode,
-                                        FnAttribute::GroupBuilder& attrs)
+namespace
 {
-    std::vector<std::string> idSplit = TfStringSplit(shaderName, ":");
-    if (idSplit.size() != 2)
-    {
-        return;
-    }
-
-    std::string shaderPrefix = idSplit[0];
-    const std::string& shaderId = idSplit[1];
+// For each Sdr input of a shader node, the attribute names it may be authored as on a prim, in
+// order of preference, along with the Katana parameter name it is read into.
+struct _SdrInputNameTableEntry
+{
+    std::string implementationName;
+    TfSmallVector<TfToken, 4> candidateNames;
+};
+typedef std::vector<_SdrInputNameTableEntry> _SdrInputNameTable;
 
-    SdrShaderNodeConstPtr sdrNode = GetShaderNodeFromShaderId(shaderName);
+_SdrInputNameTable _BuildSdrInputNameTable(const SdrShaderNode& sdrNode,
+                                           const std::string& shaderPrefix)
+{
+    _SdrInputNameTable table;
+    const std::string& shaderContext = sdrNode.GetContext().GetString();
 
-    if (!sdrNode)
+    // Build a common renderer-specific namespace prefix for the attribute.
+    std::string entryPrefix = shaderPrefix + ":";
+    if (!shaderContext.empty())
     {
-        FnLogWarn("No Sdr shader found for " << shaderId);
-        return;
+        entryPrefix += shaderContext + ":";
     }
 
-    UsdKatanaAttrMap shaderBuilder;
-    shaderBuilder.SetUSDTimeCode(currentTimeCode);
-    const std::string& shaderContext = sdrNode->GetContext().GetString();
-
-    for (const auto& inputNameToken : sdrNode->GetInputNames())
+    const NdrTokenVec& inputNames = sdrNode.GetInputNames();
+    table.reserve(inputNames.size());
+    for (const auto& inputNameToken : inputNames)
     {
+        // Use implementation name instead of input name for Katana attributes
+        // for cases like color vs lightColor
+        const SdrShaderProperty* input = sdrNode.GetShaderInput(inputNameToken);
+        if (!input)
+        {
+            continue;
+        }
+
         // This block is for building up a vector of potential attribute names
-        // (potentialUsdAttributeNames) inside the usd prim being read. Katana supports having
+        // (candidateNames) inside the usd prim being read. Katana supports having
         // multiple light shaders with differing values for the same attribute on the same
         // location. In USD, the  `inputs:color` attribute would set the color for any applied
         // renderer light schemas but we allow these attributes to be namespaced, so
         // `inputs:ri:light:color` would set the color just for a prman light inside Katana
         // at the light location, while leaving the basic USD Lux light color to be set by
         // `inputs:color`.
-        std::vector<std::string> potentialUsdAttributeNames;
+        _SdrInputNameTableEntry entry;
+        entry.implementationName = input->GetImplementationName();
         const std::string& inputName = inputNameToken.GetString();
-        potentialUsdAttributeNames.reserve(4);
-
-        const auto& rendererNameMappingIt = s_rendererToContextName.find(shaderPrefix);
-        shaderPrefix = rendererNameMappingIt != s_rendererToContextName.end()
-                           ? rendererNameMappingIt->second
-                           : shaderPrefix;
-
-        // Build a common renderer-specific namespace prefix for the attribute.
-        std::string entryPrefix = shaderPrefix + ":";
-        if (!shaderContext.empty())
-        {
-            entryPrefix += shaderContext + ":";
-        }
 
         // Here, for a prman light shader we would expect `entryPrefix` to be `ri:light:`.
         // If this prefix is not already applied as a potential attribute name, add it first
         // as this is the attribute we want to prioritise for reading the imported value.
         if (inputName.rfind(entryPrefix, 0) != 0)
         {
-            potentialUsdAttributeNames.insert(potentialUsdAttributeNames.begin(),
-                                              entryPrefix + inputName);
+            entry.candidateNames.emplace_back(entryPrefix + inputName);
         }
         // If this prefix is not already applied as a potential attribute name, including,
         // the "inputs:" prefix, add it.
@@ -1626,40 +1472,93 @@ void UsdKatanaUtils::ShaderToAttrsBySdr(const UsdPrim& prim,
             // prefix if it is already a part of the inputName already.
             if (inputName.rfind(entryPrefix, 0) != 0)
             {
-                potentialUsdAttributeNames.emplace_back("inputs:" + entryPrefix + inputName);
+                entry.candidateNames.emplace_back("inputs:" + entryPrefix + inputName);
             }
             else
             {
-                potentialUsdAttributeNames.emplace_back("inputs:" + inputName);
+                entry.candidateNames.emplace_back("inputs:" + inputName);
             }
         }
         // The last attributes we would want to import from are the basic non-namespaced
         // versions.
-        potentialUsdAttributeNames.emplace_back("inputs:" + inputName);
-        potentialUsdAttributeNames.emplace_back(inputName);
+        entry.candidateNames.emplace_back("inputs:" + inputName);
+        entry.candidateNames.push_back(inputNameToken);
 
-        std::string usdAttributeName;
-        for (const std::string& potentialUsdAttributeName : potentialUsdAttributeNames)
-        {
-            if (prim.HasAttribute(TfToken(potentialUsdAttributeName)))
-            {
-                usdAttributeName = potentialUsdAttributeName;
-                break;
-            }
-        }
+        table.push_back(std::move(entry));
+    }
+    return table;
+}
+
+// Returns the input name table of \p sdrNode for \p shaderPrefix, building it on first use.
+// Tables are never erased as Sdr nodes live for the duration of the session, so the returned
+// reference stays valid.
+const _SdrInputNameTable& _GetSdrInputNameTable(const SdrShaderNode& sdrNode,
+                                                const std::string& shaderPrefix)
+{
+    typedef std::pair<const SdrShaderNode*, std::string> _Key;
+    static tbb::concurrent_unordered_map<_Key, _SdrInputNameTable, TfHash> tables;
+
+    const _Key key(&sdrNode, shaderPrefix);
+    auto it = tables.find(key);
+    if (it == tables.end())
+    {
+        it = tables.emplace(key, _BuildSdrInputNameTable(sdrNode, shaderPrefix)).first;
+    }
+    return it->second;
+}
+}  // namespace
+
+void UsdKatanaUtils::ShaderToAttrsBySdr(const UsdPrim& prim,
+                                        const std::string& shaderName,
+                                        const UsdTimeCode& currentTimeCode,
+                                        FnAttribute::GroupBuilder& attrs)
+{
+    std::vector<std::string> idSplit = TfStringSplit(shaderName, ":");
+    if (idSplit.size() != 2)
+    {
+        return;
+    }
+
+    std::string shaderPrefix = idSplit[0];
+    const std::string& shaderId = idSplit[1];
+
+    SdrShaderNodeConstPtr sdrNode = GetShaderNodeFromShaderId(shaderName);
+
+    if (!sdrNode)
+    {
+        FnLogWarn("No Sdr shader found for " << shaderId);
+        return;
+    }
+
+    UsdKatanaAttrMap shaderBuilder;
+    shaderBuilder.SetUSDTimeCode(currentTimeCode);
+    const std::string& shaderContext = sdrNode->GetContext().GetString();
+
+    const auto& rendererNameMappingIt = s_rendererToContextName.find(shaderPrefix);
+    shaderPrefix = rendererNameMappingIt != s_rendererToContextName.end()
+                       ? rendererNameMappingIt->second
+                       : shaderPrefix;
 
-        if (!usdAttributeName.empty())
+    // Gather the prim's property names once, so that resolving each input's candidate names
+    // is a set lookup rather than a prim query per candidate.
+    const TfTokenVector propertyNames = prim.GetPropertyNames();
+    const std::unordered_set<TfToken, TfToken::HashFunctor> propertyNameSet(
+        propertyNames.begin(), propertyNames.end());
+
+    for (const _SdrInputNameTableEntry& entry : _GetSdrInputNameTable(*sdrNode, shaderPrefix))
+    {
+        for (const TfToken& candidateName : entry.candidateNames)
         {
-            // Use implementation name instead of input name for Katana attributes
-            // for cases like color vs lightColor
-            const SdrShaderProperty* input = sdrNode->GetShaderInput(inputNameToken);
-            if (!input)
+            if (propertyNameSet.count(candidateName) == 0)
             {
                 continue;
             }
-
-            shaderBuilder.Set(input->GetImplementationName(),
-                              prim.GetAttribute(TfToken(usdAttributeName)));
+            // The name may belong to a relationship rather than an attribute.
+            if (UsdAttribute attr = prim.GetAttribute(candidateName))
+            {
+                shaderBuilder.Set(entry.implementationName, attr);
+                break;
+            }
         }
     }
 
@@ -1750,6 +1649,59 @@ SdrShaderNodeConstPtr UsdKatanaUtils::GetShaderNodeFromShaderId(const std::strin
     return sdrNode;
 }
 
+TfToken UsdKatanaUtils::GetShaderContextFromShaderId(const std::string& shaderName)
+{
+    // Sdr nodes are discovered once per session, so the context of a given id never changes.
+    // Unresolved ids are cached too (as an empty token) to avoid warning for them repeatedly.
+    static tbb::concurrent_unordered_map<std::string, TfToken, TfHash> contextCache;
+
+    const auto it = contextCache.find(shaderName);
+    if (it != contextCache.end())
+    {
+        return it->second;
+    }
+
+    TfToken context;
+    if (SdrShaderNodeConstPtr sdrNode = GetShaderNodeFromShaderId(shaderName))
+    {
+        context = sdrNode->GetContext();
+    }
+    contextCache.emplace(shaderName, context);
+    return context;
+}
+
+bool UsdKatanaUtils::IsLightFilter(const UsdPrim& prim, const UsdTimeCode& currentTimeCode)
+{
+    // Light filters and prims with a light API schema are always checked. Any other prim can
+    // only have shader ids through authored attributes, so only check those authoring one;
+    // comparing authored property names is much cheaper than reading every attribute, and
+    // skips the vast majority of a scene.
+    if (!prim.IsA<UsdLuxLightFilter>() && !prim.HasAPI<UsdLuxLightAPI>() &&
+        !prim.HasAPI<UsdKatanaKatanaLightAPI>())
+    {
+        const TfTokenVector shaderIdNames =
+            prim.GetAuthoredPropertyNames([](const TfToken& name) {
+                return TfStringEndsWith(name.GetString(), "light:shaderId") ||
+                       TfStringEndsWith(name.GetString(), "lightFilter:shaderId") ||
+                       name == UsdKatanaTokens->katanaId;
+            });
+        if (shaderIdNames.empty())
+        {
+            return false;
+        }
+    }
+
+    static const TfToken lightFilterContext("lightFilter");
+    for (const std::string& shaderId : GetShaderIds(prim, currentTimeCode))
+    {
+        if (GetShaderContextFromShaderId(shaderId) == lightFilterContext)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool UsdKatanaUtils::IsAttributeVarying(const UsdAttribute& attr, double currentTime)
 {
     // XXX: Copied from UsdImagingDelegate::_TrackVariability.
@@ -1906,113 +1858,12 @@ FnKat::DoubleAttribute UsdKatanaUtils::ConvertBoundsToAttribute(
     return boundBuilder.build();
 }
 
-namespace
-{
-    typedef std::map<std::string, std::string> StringMap;
-    // A container that respects insertion order is needed; since the set is
-    // not expected to grow large, std::vector is used. USD appears to not be
-    // deterministic when generating the /__Prototype prims given the same
-    // stage. I.e a prim with a prototype could point to /__Prototype_1
-    // or /__Prototype_2 when reloading. This would cause issues as the order
-    // of the set is used to create the instance sources, and if that can
-    // change ordering because the comparison of /__Prototype_x changes, it
-    // changes the resultant hierarchy.
-    typedef std::vector<std::string> StringVec;
-    typedef std::map<std::string, StringVec> StringVecMap;
-
-    void _walkForPrototypes(const UsdPrim& prim,
-                            StringMap& prototypeToKey,
-                            StringVecMap& keyToPrototypes)
-    {
-        if (prim.IsInstance())
-        {
-            const UsdPrim prototype = prim.GetPrototype();
-
-            if (prototype.IsValid())
-            {
-                std::string prototypePath = prototype.GetPath().GetString();
-
-                if (prototypeToKey.find(prototypePath) == prototypeToKey.end())
-                {
-                    std::string assetName;
-                    UsdModelAPI(prim).GetAssetName(&assetName);
-                    if (assetName.empty())
-                    {
-                        assetName = "prototype";
-                    }
-
-                    std::ostringstream buffer;
-                    buffer << assetName << "/variants";
-
-                    UsdVariantSets variantSets = prim.GetVariantSets();
-
-                    std::vector<std::string> names;
-                    variantSets.GetNames(&names);
-                    TF_FOR_ALL(I, names)
-                    {
-                        const std::string & variantName = (*I);
-                        std::string variantValue =
-                                variantSets.GetVariantSet(
-                                        variantName).GetVariantSelection();
-                        buffer << "__" << variantName << "_" << variantValue;
-                    }
-
-                    std::string key = buffer.str();
-                    prototypeToKey[prototypePath] = key;
-                    if (std::find(keyToPrototypes[key].begin(),
-                                  keyToPrototypes[key].end(),
-                                  prototypePath) == keyToPrototypes[key].end())
-                    {
-                        keyToPrototypes[key].push_back(prototypePath);
-                    }
-                    // TODO, Warn when there are multiple prototypes with the
-                    //      same key.
-
-                    _walkForPrototypes(prototype, prototypeToKey, keyToPrototypes);
-                }
-            }
-        }
-
-
-        TF_FOR_ALL(childIter, prim.GetFilteredChildren(
-                UsdPrimIsDefined && UsdPrimIsActive && !UsdPrimIsAbstract))
-        {
-            const UsdPrim& child = *childIter;
-            _walkForPrototypes(child, prototypeToKey, keyToPrototypes);
-        }
-    }
-}
-
 FnKat::GroupAttribute UsdKatanaUtils::BuildInstancePrototypeMapping(const UsdStageRefPtr& stage,
                                                                     const SdfPath& rootPath)
 {
-    StringMap prototypeToKey;
-    StringVecMap keyToPrototypes;
-    _walkForPrototypes(stage->GetPrimAtPath(rootPath), prototypeToKey, keyToPrototypes);
-
-    FnKat::GroupBuilder gb;
-    TF_FOR_ALL(I, keyToPrototypes)
-    {
-        const std::string & key = (*I).first;
-        const StringVec& prototypes = (*I).second;
-
-        size_t i = 0;
-
-        TF_FOR_ALL(J, prototypes)
-        {
-            const std::string& prototype = (*J);
-
-            std::ostringstream buffer;
-
-            buffer << key << "/m" << i;
-            gb.set(FnKat::DelimiterEncode(prototype), FnKat::StringAttribute(buffer.str()));
-
-            ++i;
-        }
-    }
-
-
-    return gb.build();
+    // Uncached; UsdKatanaCache::GetInstancePrototypeMapping() memoizes the
+    // traversal for the lifetime of the stage.
+    return UsdKatanaPrototypeMappingCache(stage).GetMapping(rootPath);
 }
 
 FnKat::Attribute UsdKatanaUtils::ApplySkinningToPoints(const UsdGeomPointBased& points,
@@ -2042,8 +1893,13 @@ FnKat::Attribute UsdKatanaUtils::ApplySkinningToPoints(const UsdGeomPointBased&
     {
         return skinnedPointsAttr;
     }
-    UsdSkelCache skelCache;
-    skelCache.Populate(skelRoot, UsdTraverseInstanceProxies());
+    // The skinning cache lives on the UsdInArgs, so a SkelRoot is only
+    // traversed once regardless of how many meshes are bound beneath it.
+    UsdKatanaSkinningCache& skelCache = data.GetUsdInArgs()->GetSkinningCache();
+    if (!skelCache.Populate(skelRoot))
+    {
+        return skinnedPointsAttr;
+    }
 
     // Get skinning query
     const UsdSkelSkinningQuery skinningQuery = skelCache.GetSkinningQuery(prim);
@@ -2117,7 +1973,8 @@ FnKat::Attribute UsdKatanaUtils::ApplySkinningToPoints(const UsdGeomPointBased&
             if (std::find(jointXformMotionSamples.cbegin(), jointXformMotionSamples.cend(), time) !=
                 jointXformMotionSamples.cend())
             {
-                ApplyJointAnimation(skinningQuery, skelQuery, time, skinnedPoints, data);
+                ApplyJointAnimation(
+                    skinningQuery, skelQuery, time, skinnedPoints, data, skelCache);
             }
         }
         float correctedSampleTime =
@@ -2135,7 +1992,8 @@ FnKat::Attribute UsdKatanaUtils::ApplySkinningToPoints(const UsdGeomPointBased&
         }
         if (hasJointIndicesAttr)
         {
-            ApplyJointAnimation(skinningQuery, skelQuery, currentTime, skinnedPoints, data);
+            ApplyJointAnimation(
+                skinningQuery, skelQuery, currentTime, skinnedPoints, data, skelCache);
         }
         // Package the points in an attribute.
         if (!skinnedPoints.empty())
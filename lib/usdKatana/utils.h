@@ -69,6 +69,12 @@ struct UsdKatanaUtils
     USDKATANA_API static void ConvertNumVertsToStartVerts( const std::vector<int> &numVertsVec,
                                   std::vector<int> *startVertsVec );
 
+    /// Convert Pixar-style numVerts to Katana-style startVerts, writing the
+    /// result straight into \p startVertsArray so it can be handed to Katana
+    /// without further copies.
+    USDKATANA_API static void ConvertNumVertsToStartVerts(const VtIntArray& numVertsArray,
+                                                          VtIntArray* startVertsArray);
+
     USDKATANA_API static void ConvertArrayToVector(const VtVec3fArray &a, std::vector<float> *r);
 
     /// Convert a VtValue to a Katana attribute.
@@ -111,6 +117,14 @@ struct UsdKatanaUtils
     /// Discover published lights (without a full scene traversal).
     USDKATANA_API static SdfPathVector FindLightPaths( const UsdStageRefPtr& stage );
 
+    /// Append the cameras found by FindCameraPaths() at or below the top-level
+    /// prim \p prim to \p result.
+    USDKATANA_API static void FindCameraPaths(const UsdPrim& prim, SdfPathVector* result);
+
+    /// Append the lights found by FindLightPaths() at or below the top-level
+    /// prim \p prim to \p result, in discovery order.
+    USDKATANA_API static void FindLightPaths(const UsdPrim& prim, SdfPathVector* result);
+
     /// Convert the given SdfPath in the UsdStage to the corresponding
     /// katana location, given a scenegraph generator configuration.
     USDKATANA_API static std::string ConvertUsdPathToKatLocation(
@@ -201,6 +215,18 @@ struct UsdKatanaUtils
     USDKATANA_API static SdrShaderNodeConstPtr GetShaderNodeFromShaderId(
         const std::string& shaderName);
 
+    /// Returns the Sdr context (e.g. "light", "lightFilter") of the shader node for
+    /// \p shaderName, a "prefix:id" string as returned by GetShaderIds(). Results are
+    /// memoized, so repeated lookups of the same id do not query the Sdr registry again.
+    /// Returns an empty token if no shader node is found.
+    USDKATANA_API static TfToken GetShaderContextFromShaderId(const std::string& shaderName);
+
+    /// Returns true if \p prim is a light filter, i.e. one of its shader ids resolves to a
+    /// shader node in the "lightFilter" context. Prims that carry neither a light filter type
+    /// nor a light API schema are only checked if they author a shader id attribute.
+    USDKATANA_API static bool IsLightFilter(const UsdPrim& prim,
+                                            const UsdTimeCode& currentTimeCode);
+
     /// \}
 
     /// \name Bounds
@@ -217,6 +243,8 @@ struct UsdKatanaUtils
     /// Build and return, as a group attribute for convenience, a map
     /// from instances to prototypes.  Only traverses paths at and below
     /// the given rootPath.
+    ///
+    /// \sa UsdKatanaCache::GetInstancePrototypeMapping
     USDKATANA_API static FnKat::GroupAttribute BuildInstancePrototypeMapping(
         const UsdStageRefPtr& stage,
         const SdfPath& rootPath);
@@ -0,0 +1,72 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/valueConverterRegistry.h"
+
+#include <utility>
+
+#include <pxr/base/tf/instantiateSingleton.h>
+#include <pxr/base/tf/registryManager.h>
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+TF_INSTANTIATE_SINGLETON(UsdKatanaValueConverterRegistry);
+
+UsdKatanaValueConverterRegistry::UsdKatanaValueConverterRegistry()
+{
+    // Registry functions look the registry up through GetInstance(), so it
+    // has to be published before they run. Other threads could then see it
+    // partially populated, which is why UsdKatanaBootstrap() constructs it
+    // ahead of any cook.
+    TfSingleton<UsdKatanaValueConverterRegistry>::SetInstanceConstructed(*this);
+    TfRegistryManager::GetInstance().SubscribeTo<UsdKatanaValueConverterRegistry>();
+}
+
+bool UsdKatanaValueConverterRegistry::RegisterAttrConverter(const std::type_info& type,
+                                                            const AttrConverter& converter)
+{
+    return _attrConverters.insert(std::make_pair(std::type_index(type), converter)).second;
+}
+
+bool UsdKatanaValueConverterRegistry::RegisterCustomGeomAttrConverter(
+    const std::type_info& type,
+    const CustomGeomAttrConverter& converter)
+{
+    return _customGeomAttrConverters.insert(std::make_pair(std::type_index(type), converter))
+        .second;
+}
+
+const UsdKatanaValueConverterRegistry::AttrConverter*
+UsdKatanaValueConverterRegistry::GetAttrConverter(const std::type_info& type) const
+{
+    const auto it = _attrConverters.find(std::type_index(type));
+    return it != _attrConverters.end() ? &it->second : nullptr;
+}
+
+const UsdKatanaValueConverterRegistry::CustomGeomAttrConverter*
+UsdKatanaValueConverterRegistry::GetCustomGeomAttrConverter(const std::type_info& type) const
+{
+    const auto it = _customGeomAttrConverters.find(std::type_index(type));
+    return it != _customGeomAttrConverters.end() ? &it->second : nullptr;
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
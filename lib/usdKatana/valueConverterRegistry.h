@@ -0,0 +1,125 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef USDKATANA_VALUECONVERTERREGISTRY_H
+#define USDKATANA_VALUECONVERTERREGISTRY_H
+
+#include <functional>
+#include <typeindex>
+#include <typeinfo>
+
+#include <pxr/base/tf/singleton.h>
+#include <pxr/base/tf/token.h>
+#include <pxr/base/vt/value.h>
+#include <pxr/pxr.h>
+
+#include <FnAttribute/FnAttribute.h>
+
+#include <tbb/concurrent_unordered_map.h>
+
+#include "usdKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+/// \brief Registry of the converters from VtValues to Katana attributes,
+///        keyed by the type held by the value.
+///
+/// UsdKatanaUtils::ConvertVtValueToKatAttr() and
+/// UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr() dispatch through this
+/// registry, with a single lookup per value.
+///
+/// The converters for the built-in types are registered from
+/// TF_REGISTRY_FUNCTION(UsdKatanaValueConverterRegistry) blocks, which run
+/// when the registry is first used. UsdKatanaBootstrap() does so, before any
+/// concurrent lookups. Plugins can register converters for
+/// their own value types the same way, or by calling the Register methods
+/// directly. A converter can't be replaced once registered for a type.
+class UsdKatanaValueConverterRegistry : public TfSingleton<UsdKatanaValueConverterRegistry>
+{
+    friend class TfSingleton<UsdKatanaValueConverterRegistry>;
+
+    UsdKatanaValueConverterRegistry();
+
+public:
+    /// Converts a value, with the semantics of
+    /// UsdKatanaUtils::ConvertVtValueToKatAttr().
+    using AttrConverter =
+        std::function<FnAttribute::Attribute(const VtValue& value, bool asShaderParam)>;
+
+    /// Converts a primvar value, with the semantics of
+    /// UsdKatanaUtils::ConvertVtValueToKatCustomGeomAttr().
+    using CustomGeomAttrConverter = std::function<void(const VtValue& value,
+                                                       int elementSize,
+                                                       const TfToken& roleName,
+                                                       FnAttribute::Attribute* valueAttr,
+                                                       FnAttribute::Attribute* inputTypeAttr,
+                                                       FnAttribute::Attribute* elementSizeAttr)>;
+
+    USDKATANA_API static UsdKatanaValueConverterRegistry& GetInstance()
+    {
+        return TfSingleton<UsdKatanaValueConverterRegistry>::GetInstance();
+    }
+
+    /// \brief Register \p converter for values holding \p type. Returns false
+    ///        if a converter is already registered for that type.
+    USDKATANA_API bool RegisterAttrConverter(const std::type_info& type,
+                                             const AttrConverter& converter);
+
+    template <typename T>
+    bool RegisterAttrConverter(const AttrConverter& converter)
+    {
+        return RegisterAttrConverter(typeid(T), converter);
+    }
+
+    /// \brief Register \p converter for primvar values holding \p type.
+    ///        Returns false if a converter is already registered for that
+    ///        type.
+    USDKATANA_API bool RegisterCustomGeomAttrConverter(const std::type_info& type,
+                                                       const CustomGeomAttrConverter& converter);
+
+    template <typename T>
+    bool RegisterCustomGeomAttrConverter(const CustomGeomAttrConverter& converter)
+    {
+        return RegisterCustomGeomAttrConverter(typeid(T), converter);
+    }
+
+    /// \brief Return the converter for values holding \p type, or null if
+    ///        there is none.
+    USDKATANA_API const AttrConverter* GetAttrConverter(const std::type_info& type) const;
+
+    /// \brief Return the converter for primvar values holding \p type, or
+    ///        null if there is none.
+    USDKATANA_API const CustomGeomAttrConverter* GetCustomGeomAttrConverter(
+        const std::type_info& type) const;
+
+private:
+    // Insert-only, so that lookups never lock.
+    tbb::concurrent_unordered_map<std::type_index, AttrConverter> _attrConverters;
+    tbb::concurrent_unordered_map<std::type_index, CustomGeomAttrConverter>
+        _customGeomAttrConverters;
+};
+
+USDKATANA_API_TEMPLATE_CLASS(TfSingleton<UsdKatanaValueConverterRegistry>);
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // USDKATANA_VALUECONVERTERREGISTRY_H
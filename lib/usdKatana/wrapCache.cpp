@@ -39,6 +39,22 @@ using namespace boost::python;
 
 PXR_NAMESPACE_USING_DIRECTIVE
 
+static dict _GetStats(UsdKatanaCache& cache)
+{
+    const UsdKatanaCache::Stats stats = cache.GetStats();
+    dict result;
+    result["stages"] = stats.stages;
+    result["sessionLayers"] = stats.sessionLayers;
+    result["sessionLayerBytes"] = stats.sessionLayerBytes;
+    result["sessionLayerHits"] = stats.sessionLayerHits;
+    result["sessionLayerMisses"] = stats.sessionLayerMisses;
+    result["sessionLayerEvictions"] = stats.sessionLayerEvictions;
+    result["maxSessionLayers"] = stats.maxSessionLayers;
+    result["maxSessionLayerBytes"] = stats.maxSessionLayerBytes;
+    result["materialLibraryStages"] = stats.materialLibraryStages;
+    return result;
+}
+
 void wrapUsdKatanaCache() {
     typedef UsdKatanaCache This;
     SdfLayerRefPtr (This::*ThisFindSessionLayer)(const std::string& cacheKey)=
@@ -47,12 +63,18 @@ void wrapUsdKatanaCache() {
     SdfLayerRefPtr (This::*ThisFindOrCreateSessionLayer)(
         const std::string& sessionAttrXML, const std::string & rootLocation)=
             &This::FindOrCreateSessionLayer;
+
+    size_t (This::*ThisFlushStage)(const std::string& rootLayerIdentifier)=
+            &This::FlushStage;
     
-    class_<This>("Cache", no_init)
+    class_<This, boost::noncopyable>("Cache", no_init)
         .def("GetInstance", &UsdKatanaCache::GetInstance,
              return_value_policy<reference_existing_object>())
         .staticmethod("GetInstance")
         .def("FindSessionLayer", ThisFindSessionLayer)
-        .def("FindOrCreateSessionLayer", ThisFindOrCreateSessionLayer);
+        .def("FindOrCreateSessionLayer", ThisFindOrCreateSessionLayer)
+        .def("FlushStage", ThisFlushStage)
+        .def("GetStats", &_GetStats)
+        .def("SetSessionLayerLimits", &This::SetSessionLayerLimits);
         
 }
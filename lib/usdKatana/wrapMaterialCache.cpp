@@ -0,0 +1,55 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "usdKatana/materialCache.h"
+
+#include <boost/python.hpp>
+
+#include <FnAttribute/suite/FnAttributeSuite.h>  // UsdKatana import crashes without this include
+
+using namespace boost::python;
+
+PXR_NAMESPACE_USING_DIRECTIVE
+
+static dict _GetStats(UsdKatanaMaterialCache& cache)
+{
+    const UsdKatanaMaterialCache::Stats stats = cache.GetStats();
+    dict result;
+    result["hits"] = stats.hits;
+    result["misses"] = stats.misses;
+    result["evictions"] = stats.evictions;
+    result["entries"] = stats.entries;
+    result["bytes"] = stats.bytes;
+    result["maxBytes"] = stats.maxBytes;
+    return result;
+}
+
+void wrapUsdKatanaMaterialCache()
+{
+    typedef UsdKatanaMaterialCache This;
+
+    class_<This, boost::noncopyable>("MaterialCache", no_init)
+        .def("GetInstance", &This::GetInstance, return_value_policy<reference_existing_object>())
+        .staticmethod("GetInstance")
+        .def("Clear", &This::Clear)
+        .def("GetStats", &_GetStats);
+}
@@ -29,6 +29,10 @@
 //
 #include "vtKatana/array.h"
 
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
 #include <pxr/pxr.h>
 
 #include "vtKatana/internalFromVt.h"
@@ -52,6 +56,36 @@ template <typename AttrType>
 AttrType FailureAttr() {
     return AttrType();
 }
+
+/// Returns true if \p a and \p b hold bitwise identical elements. Arrays
+/// sharing the same storage are detected without touching the data.
+template <typename T>
+typename std::enable_if<std::is_trivially_copyable<T>::value, bool>::type
+AreSamplesIdentical(const VtArray<T>& a, const VtArray<T>& b) {
+    if (a.IsIdentical(b)) {
+        return true;
+    }
+    return a.size() == b.size() &&
+           std::memcmp(a.cdata(), b.cdata(), a.size() * sizeof(T)) == 0;
+}
+
+/// Element types that aren't trivially copyable (strings, paths, tokens)
+/// fall back to element-wise comparison.
+template <typename T>
+typename std::enable_if<!std::is_trivially_copyable<T>::value, bool>::type
+AreSamplesIdentical(const VtArray<T>& a, const VtArray<T>& b) {
+    return a == b;
+}
+
+/// Returns true if every sample in \p values is identical to the first, in
+/// which case the samples can be collapsed into a single static sample.
+template <typename T>
+bool IsStatic(const std::vector<VtArray<T>>& values) {
+    return std::all_of(values.begin() + 1, values.end(),
+                       [&values](const VtArray<T>& array) {
+                           return AreSamplesIdentical(values.front(), array);
+                       });
+}
 }
 
 template <typename T>
@@ -95,6 +129,13 @@ typename VtKatana_GetKatanaAttrType<T>::type VtKatanaMapOrCopy(
         TF_CODING_ERROR("'values' topology is varying.");
         return VtKatana_Internal::FailureAttr<AttrType>();
     }
+    // Readers request one sample per motion time even when the attribute
+    // holds fewer authored samples, so collapse identical samples into a
+    // single static sample.
+    if (values.size() > 1 && VtKatana_Internal::IsStatic(values)) {
+        return VtKatana_Internal::VtKatana_FromVtConversion<T>::MapInternal(
+            values.front());
+    }
     return VtKatana_Internal::VtKatana_FromVtConversion<T>::MapInternalMultiple(
         times, values);
 }
@@ -139,6 +180,10 @@ typename VtKatana_GetKatanaAttrType<T>::type VtKatanaCopy(
         TF_CODING_ERROR("'values' topology is varying.");
         return VtKatana_Internal::FailureAttr<AttrType>();
     }
+    if (values.size() > 1 && VtKatana_Internal::IsStatic(values)) {
+        return VtKatana_Internal::VtKatana_FromVtConversion<T>::Copy(
+            values.front());
+    }
     return VtKatana_Internal::VtKatana_FromVtConversion<T>::Copy(times, values);
 }
 
@@ -0,0 +1,261 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#include "vtKatana/internalConvert.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include <pxr/pxr.h>
+#include <pxr/base/arch/defines.h>
+
+#if defined(ARCH_CPU_INTEL)
+#define VTKATANA_SIMD_KERNELS
+#include <immintrin.h>
+#if defined(ARCH_COMPILER_MSVC)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// GCC and Clang only emit instructions for the ISAs a function is
+// explicitly compiled for; MSVC allows intrinsics anywhere.
+#if defined(ARCH_COMPILER_GCC) || defined(ARCH_COMPILER_CLANG)
+#define VTKATANA_TARGET(isa) __attribute__((target(isa)))
+#else
+#define VTKATANA_TARGET(isa)
+#endif
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace VtKatana_Internal {
+
+static_assert(sizeof(GfHalf) == sizeof(uint16_t),
+              "GfHalf must be stored as 16 bits for the F16C kernel.");
+static_assert(sizeof(bool) == sizeof(uint8_t),
+              "bool must be stored as a byte for the bool kernels.");
+
+namespace {
+
+struct CpuFeatures {
+    bool sse41{false};
+    bool avx2{false};
+    bool f16c{false};
+};
+
+#if defined(VTKATANA_SIMD_KERNELS)
+void Cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+#if defined(ARCH_COMPILER_MSVC)
+    int info[4];
+    __cpuidex(info, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<unsigned int>(info[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+uint64_t Xgetbv() {
+#if defined(ARCH_COMPILER_MSVC)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+CpuFeatures DetectCpuFeatures() {
+    CpuFeatures features;
+#if defined(VTKATANA_SIMD_KERNELS)
+    unsigned int regs[4];
+    Cpuid(0, 0, regs);
+    const unsigned int maxLeaf = regs[0];
+    if (maxLeaf < 1) {
+        return features;
+    }
+
+    Cpuid(1, 0, regs);
+    features.sse41 = (regs[2] & (1u << 19)) != 0;
+
+    // AVX registers are only usable if the OS saves them on context switch.
+    const bool osxsave = (regs[2] & (1u << 27)) != 0;
+    const bool avx = (regs[2] & (1u << 28)) != 0;
+    const bool avxEnabled = osxsave && avx && (Xgetbv() & 0x6) == 0x6;
+    features.f16c = avxEnabled && (regs[2] & (1u << 29)) != 0;
+
+    if (avxEnabled && maxLeaf >= 7) {
+        Cpuid(7, 0, regs);
+        features.avx2 = (regs[1] & (1u << 5)) != 0;
+    }
+#endif
+    return features;
+}
+
+const CpuFeatures& GetCpuFeatures() {
+    static const CpuFeatures features = DetectCpuFeatures();
+    return features;
+}
+
+typedef void (*HalfKernel)(const GfHalf*, float*, size_t);
+typedef void (*BoolKernel)(const bool*, int*, size_t);
+
+HalfKernel SelectHalfKernel() {
+    if (GetCpuFeatures().f16c) {
+        return VtKatana_ConvertHalfsF16C;
+    }
+    return VtKatana_ConvertScalarsFallback;
+}
+
+BoolKernel SelectBoolKernel() {
+    if (GetCpuFeatures().avx2) {
+        return VtKatana_ConvertBoolsAvx2;
+    }
+    if (GetCpuFeatures().sse41) {
+        return VtKatana_ConvertBoolsSse41;
+    }
+    return VtKatana_ConvertScalarsFallback;
+}
+}
+
+bool VtKatana_CpuSupportsF16C() {
+    return GetCpuFeatures().f16c;
+}
+
+bool VtKatana_CpuSupportsSse41() {
+    return GetCpuFeatures().sse41;
+}
+
+bool VtKatana_CpuSupportsAvx2() {
+    return GetCpuFeatures().avx2;
+}
+
+#if defined(VTKATANA_SIMD_KERNELS)
+VTKATANA_TARGET("avx,f16c")
+void VtKatana_ConvertHalfsF16C(const GfHalf* src, float* dst, size_t count) {
+    // F16C quiets signalling NaNs, whereas GfHalf preserves their payload.
+    // Blocks holding a half with all exponent bits set and the quiet bit
+    // clear (signalling NaNs, but also infinities) take the scalar path so
+    // that results stay bit-exact.
+    const __m128i exponentAndQuietMask = _mm_set1_epi16(0x7e00);
+    const __m128i signallingBits = _mm_set1_epi16(0x7c00);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i halfs =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        const __m128i signalling = _mm_cmpeq_epi16(
+            _mm_and_si128(halfs, exponentAndQuietMask), signallingBits);
+        if (_mm_movemask_epi8(signalling) != 0) {
+            VtKatana_ConvertScalarsFallback(src + i, dst + i, 8);
+            continue;
+        }
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(halfs));
+    }
+    VtKatana_ConvertScalarsFallback(src + i, dst + i, count - i);
+}
+
+VTKATANA_TARGET("sse4.1")
+void VtKatana_ConvertBoolsSse41(const bool* src, int* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i bytes =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i* out = reinterpret_cast<__m128i*>(dst + i);
+        _mm_storeu_si128(out, _mm_cvtepu8_epi32(bytes));
+        _mm_storeu_si128(out + 1, _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 4)));
+        _mm_storeu_si128(out + 2, _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+        _mm_storeu_si128(out + 3,
+                         _mm_cvtepu8_epi32(_mm_srli_si128(bytes, 12)));
+    }
+    VtKatana_ConvertScalarsFallback(src + i, dst + i, count - i);
+}
+
+VTKATANA_TARGET("avx2")
+void VtKatana_ConvertBoolsAvx2(const bool* src, int* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i bytes =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m256i* out = reinterpret_cast<__m256i*>(dst + i);
+        _mm256_storeu_si256(out, _mm256_cvtepu8_epi32(bytes));
+        _mm256_storeu_si256(out + 1,
+                            _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+    }
+    VtKatana_ConvertScalarsFallback(src + i, dst + i, count - i);
+}
+#else
+void VtKatana_ConvertHalfsF16C(const GfHalf* src, float* dst, size_t count) {
+    VtKatana_ConvertScalarsFallback(src, dst, count);
+}
+
+void VtKatana_ConvertBoolsSse41(const bool* src, int* dst, size_t count) {
+    VtKatana_ConvertScalarsFallback(src, dst, count);
+}
+
+void VtKatana_ConvertBoolsAvx2(const bool* src, int* dst, size_t count) {
+    VtKatana_ConvertScalarsFallback(src, dst, count);
+}
+#endif
+
+void VtKatana_ConvertScalars(const GfHalf* src, float* dst, size_t count) {
+    static const HalfKernel kernel = SelectHalfKernel();
+    kernel(src, dst, count);
+}
+
+void VtKatana_ConvertScalars(const bool* src, int* dst, size_t count) {
+    static const BoolKernel kernel = SelectBoolKernel();
+    kernel(src, dst, count);
+}
+
+void VtKatana_ConvertScalars(const unsigned int* src, int* dst,
+                             size_t count) {
+    if (count > 0) {
+        std::memcpy(dst, src, count * sizeof(int));
+    }
+}
+
+void VtKatana_ConvertScalarsFallback(const GfHalf* src, float* dst,
+                                     size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<float>(src[i]);
+    }
+}
+
+void VtKatana_ConvertScalarsFallback(const bool* src, int* dst,
+                                     size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<int>(src[i]);
+    }
+}
+
+void VtKatana_ConvertScalarsFallback(const unsigned int* src, int* dst,
+                                     size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<int>(src[i]);
+    }
+}
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
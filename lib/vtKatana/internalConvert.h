@@ -0,0 +1,97 @@
+// Copyright (c) 2024 The Foundry Visionmongers Ltd.
+//
+// Licensed under the Apache License, Version 2.0 (the "Apache License")
+// with the following modification; you may not use this file except in
+// compliance with the Apache License and the following modification to it:
+// Section 6. Trademarks. is deleted and replaced with:
+//
+// 6. Trademarks. This License does not grant permission to use the trade
+// names, trademarks, service marks, or product names of the Licensor
+// and its affiliates, except as required to comply with Section 4(c) of
+// the License and to reproduce the content of the NOTICE file.
+//
+// You may obtain a copy of the Apache License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the Apache License with the above modification is
+// distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+// KIND, either express or implied. See the Apache License for the specific
+// language governing permissions and limitations under the Apache License.
+//
+#ifndef VTKATANA_INTERNALCONVERT_H
+#define VTKATANA_INTERNALCONVERT_H
+
+#include <pxr/pxr.h>
+
+#include <algorithm>
+#include <cstddef>
+
+#include <pxr/base/gf/half.h>
+
+#include "vtKatana/api.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace VtKatana_Internal {
+
+/// Converts \p count scalars from \p src into \p dst, for numeric types
+/// whose Katana value type differs from their scalar type and that have no
+/// dedicated kernel below.
+template <typename SrcType, typename DstType>
+void VtKatana_ConvertScalars(const SrcType* src, DstType* dst, size_t count) {
+    std::copy(src, src + count, dst);
+}
+
+/// Converts \p count halfs from \p src into \p dst. Uses F16C when the
+/// running CPU supports it.
+VTKATANA_API void VtKatana_ConvertScalars(const GfHalf* src, float* dst,
+                                          size_t count);
+
+/// Converts \p count bools from \p src into \p dst. Uses AVX2 or SSE4.1
+/// when the running CPU supports it.
+VTKATANA_API void VtKatana_ConvertScalars(const bool* src, int* dst,
+                                          size_t count);
+
+/// Converts \p count unsigned ints from \p src into \p dst. Both types share
+/// their representation, so this is a plain copy of the bits.
+VTKATANA_API void VtKatana_ConvertScalars(const unsigned int* src, int* dst,
+                                          size_t count);
+
+/// Scalar reference implementations of the kernels above, used as fallback
+/// when no SIMD kernel is supported.
+/// @{
+VTKATANA_API void VtKatana_ConvertScalarsFallback(const GfHalf* src,
+                                                  float* dst, size_t count);
+VTKATANA_API void VtKatana_ConvertScalarsFallback(const bool* src, int* dst,
+                                                  size_t count);
+VTKATANA_API void VtKatana_ConvertScalarsFallback(const unsigned int* src,
+                                                  int* dst, size_t count);
+/// @}
+
+/// Whether the running CPU supports the instruction sets of the SIMD
+/// kernels below.
+/// @{
+VTKATANA_API bool VtKatana_CpuSupportsF16C();
+VTKATANA_API bool VtKatana_CpuSupportsSse41();
+VTKATANA_API bool VtKatana_CpuSupportsAvx2();
+/// @}
+
+/// The SIMD kernels VtKatana_ConvertScalars() selects from, exposed so that
+/// each can be tested on its own. Each must only be called when the running
+/// CPU supports its instruction set. On other architectures they fall back
+/// to the scalar kernels.
+/// @{
+VTKATANA_API void VtKatana_ConvertHalfsF16C(const GfHalf* src, float* dst,
+                                            size_t count);
+VTKATANA_API void VtKatana_ConvertBoolsSse41(const bool* src, int* dst,
+                                             size_t count);
+VTKATANA_API void VtKatana_ConvertBoolsAvx2(const bool* src, int* dst,
+                                            size_t count);
+/// @}
+}
+
+PXR_NAMESPACE_CLOSE_SCOPE
+
+#endif  // VTKATANA_INTERNALCONVERT_H
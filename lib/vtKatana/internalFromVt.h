@@ -38,6 +38,7 @@
 #include <pxr/base/tf/envSetting.h>
 #include <pxr/base/vt/array.h>
 
+#include "vtKatana/internalConvert.h"
 #include "vtKatana/internalTraits.h"
 
 PXR_NAMESPACE_OPEN_SCOPE
@@ -95,6 +96,25 @@ public:
     }
 };
 
+/// Katana attribute context owning a buffer of converted values, so that
+/// types requiring a conversion can be written straight into the storage
+/// of the attribute.
+template <typename ValueType>
+class VtKatana_ConvertedContext {
+    std::unique_ptr<ValueType[]> _data;
+
+public:
+    explicit VtKatana_ConvertedContext(size_t size)
+        : _data(new ValueType[size]) {}
+
+    ValueType* GetData() { return _data.get(); }
+
+    static void Free(void* self) {
+        auto context = static_cast<VtKatana_ConvertedContext*>(self);
+        delete context;
+    }
+};
+
 /// Convert an array of string holders to a vector of c-string pointers
 /// suitable for Katana injection
 template <typename StringType,
@@ -159,22 +179,6 @@ public:
 
     // COPY INTERMEDIATE TO STD::VECTOR IMPLEMENTATIONS
 
-    /// Utility for copying numeric types to an intermediate std::vector
-    /// suitable for use with Katana APIs. (ie. VtVec3hArray ->
-    /// std::vector<float>)
-    template <typename T = ElementType>
-    static typename std::enable_if<VtKatana_IsNumeric<T>::value,
-                                   std::vector<ValueType>>::type
-    CopyIntermediate(const VtArray<T>& array) {
-        typedef typename VtKatana_GetNumericScalarType<ElementType>::type
-            ScalarType;
-        size_t size = array.size() * VtKatana_GetNumericTupleSize<T>::value;
-        auto dataBegin = VtKatana_GetScalarPtr(array);
-        auto dataEnd = dataBegin + size;
-        std::vector<ValueType> intermediate(dataBegin, dataEnd);
-        return intermediate;
-    }
-
     /// Utility for copying tuple types to an intermediate std::vector
     /// suitable for use with Katana APIs. (ie. VtStringArray ->
     /// std::vector<std::string>)
@@ -217,17 +221,21 @@ public:
         return attr;
     }
 
-    /// Utility for copying types that require an intermediate
-    /// translation for use with Katana APIs. (ie. VtVec3hArray ->
-    /// FloatAttribute, VtUIntArray -> IntAttribute)
+    /// Utility for copying types that require a translation for use with
+    /// Katana APIs (ie. VtVec3hArray -> FloatAttribute, VtUIntArray ->
+    /// IntAttribute). Values are converted straight into a buffer owned by
+    /// the attribute.
     template <typename T = ElementType>
     static typename std::enable_if<VtKatana_IsNumericCopyRequired<T>::value,
                                    AttrType>::type
     Copy(const VtArray<T>& array) {
-        auto intermediate = CopyIntermediate(array);
-        size_t size = intermediate.size();
-        auto data = intermediate.data();
-        return AttrType(data, size, VtKatana_GetNumericTupleSize<T>::value);
+        typedef VtKatana_ConvertedContext<ValueType> ConvertedContext;
+        size_t size = array.size() * VtKatana_GetNumericTupleSize<T>::value;
+        std::unique_ptr<ConvertedContext> context(new ConvertedContext(size));
+        ValueType* data = context->GetData();
+        VtKatana_ConvertScalars(VtKatana_GetScalarPtr(array), data, size);
+        return AttrType(data, size, VtKatana_GetNumericTupleSize<T>::value,
+                        context.release(), ConvertedContext::Free);
     }
 
     /// Utility for copying string types that require an intermediate
@@ -303,19 +311,31 @@ public:
         return attr;
     }
 
-    /// Utility for copying numeric types that do require intermediate copies
+    /// Utility for copying numeric types that require a translation, with
+    /// all samples converted into a single buffer owned by the attribute.
     template <typename T = ElementType>
     static typename std::enable_if<VtKatana_IsNumericCopyRequired<T>::value,
                                    AttrType>::type
     Copy(const std::vector<float>& times,
          const typename std::vector<VtArray<T>>& values) {
-        BuilderType builder;
-        auto timesIt = times.begin();
-        for (const VtArray<T>& value : values) {
-            builder.set(CopyIntermediate(value), *timesIt);
-            ++timesIt;
+        typedef VtKatana_ConvertedContext<ValueType> ConvertedContext;
+        TF_VERIFY(times.size() == values.size() && !times.empty() &&
+                  !values.front().empty());
+        size_t size =
+            values.front().size() * VtKatana_GetNumericTupleSize<T>::value;
+        std::unique_ptr<ConvertedContext> context(
+            new ConvertedContext(size * values.size()));
+        std::vector<const ValueType*> ptrs(values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            ValueType* data = context->GetData() + i * size;
+            VtKatana_ConvertScalars(VtKatana_GetScalarPtr(values[i]), data,
+                                    size);
+            ptrs[i] = data;
         }
-        return builder.build();
+        AttrType attr(times.data(), times.size(), ptrs.data(), size,
+                      VtKatana_GetNumericTupleSize<T>::value, context.release(),
+                      ConvertedContext::Free);
+        return attr;
     }
 
     /// Iternals of map for types that are not castable, requiring an
@@ -0,0 +1,173 @@
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "pxr/base/gf/half.h"
+#include "pxr/base/vt/types.h"
+#include "pxr/pxr.h"
+
+#include "vtKatana/array.h"
+#include "vtKatana/internalConvert.h"
+
+PXR_NAMESPACE_OPEN_SCOPE
+
+namespace ConvertTests
+{
+using VtKatana_Internal::VtKatana_ConvertScalars;
+using VtKatana_Internal::VtKatana_ConvertScalarsFallback;
+
+// Every possible half, including denormals, infinities and NaNs. The odd
+// length exercises the scalar tail of the SIMD kernels.
+std::vector<GfHalf> AllHalfs()
+{
+    std::vector<GfHalf> halfs((1 << 16) + 5);
+    for (size_t i = 0; i < halfs.size(); ++i)
+    {
+        halfs[i].setBits(static_cast<unsigned short>(i));
+    }
+    return halfs;
+}
+
+typedef void (*HalfKernel)(const GfHalf*, float*, size_t);
+typedef void (*BoolKernel)(const bool*, int*, size_t);
+
+void ExpectHalfKernelMatchesFallback(HalfKernel kernel)
+{
+    const std::vector<GfHalf> halfs = AllHalfs();
+    std::vector<float> result(halfs.size());
+    std::vector<float> expected(halfs.size());
+
+    // Offset the start to exercise unaligned loads and stores.
+    for (size_t offset = 0; offset < 3; ++offset)
+    {
+        const size_t count = halfs.size() - offset;
+        kernel(halfs.data() + offset, result.data(), count);
+        VtKatana_ConvertScalarsFallback(halfs.data() + offset, expected.data(), count);
+        ASSERT_EQ(std::memcmp(result.data(), expected.data(), count * sizeof(float)), 0);
+    }
+}
+
+void ExpectBoolKernelMatchesFallback(BoolKernel kernel)
+{
+    const size_t numBools = 1027;
+    std::unique_ptr<bool[]> bools(new bool[numBools]);
+    for (size_t i = 0; i < numBools; ++i)
+    {
+        bools[i] = (i * 7) % 3 == 0;
+    }
+    std::vector<int> result(numBools);
+    std::vector<int> expected(numBools);
+
+    for (size_t offset = 0; offset < 3; ++offset)
+    {
+        const size_t count = numBools - offset;
+        kernel(bools.get() + offset, result.data(), count);
+        VtKatana_ConvertScalarsFallback(bools.get() + offset, expected.data(), count);
+        ASSERT_EQ(std::memcmp(result.data(), expected.data(), count * sizeof(int)), 0);
+    }
+}
+
+TEST(ConvertTest, HalfKernelMatchesFallback)
+{
+    ExpectHalfKernelMatchesFallback(&VtKatana_ConvertScalars);
+}
+
+// The SIMD kernels are tested individually, as VtKatana_ConvertScalars()
+// only ever runs the one the host CPU selects. Those the host doesn't
+// support are left untested.
+TEST(ConvertTest, F16CKernelMatchesFallback)
+{
+    if (!VtKatana_Internal::VtKatana_CpuSupportsF16C())
+    {
+        return;
+    }
+    ExpectHalfKernelMatchesFallback(&VtKatana_Internal::VtKatana_ConvertHalfsF16C);
+}
+
+TEST(ConvertTest, BoolKernelMatchesFallback)
+{
+    ExpectBoolKernelMatchesFallback(&VtKatana_ConvertScalars);
+}
+
+TEST(ConvertTest, Sse41BoolKernelMatchesFallback)
+{
+    if (!VtKatana_Internal::VtKatana_CpuSupportsSse41())
+    {
+        return;
+    }
+    ExpectBoolKernelMatchesFallback(&VtKatana_Internal::VtKatana_ConvertBoolsSse41);
+}
+
+TEST(ConvertTest, Avx2BoolKernelMatchesFallback)
+{
+    if (!VtKatana_Internal::VtKatana_CpuSupportsAvx2())
+    {
+        return;
+    }
+    ExpectBoolKernelMatchesFallback(&VtKatana_Internal::VtKatana_ConvertBoolsAvx2);
+}
+
+TEST(ConvertTest, UIntKernelMatchesFallback)
+{
+    std::vector<unsigned int> uints = {0u,
+                                       1u,
+                                       42u,
+                                       static_cast<unsigned int>(std::numeric_limits<int>::max()),
+                                       static_cast<unsigned int>(std::numeric_limits<int>::max()) + 1u,
+                                       std::numeric_limits<unsigned int>::max()};
+    std::vector<int> result(uints.size());
+    std::vector<int> expected(uints.size());
+    VtKatana_ConvertScalars(uints.data(), result.data(), uints.size());
+    VtKatana_ConvertScalarsFallback(uints.data(), expected.data(), uints.size());
+    ASSERT_EQ(std::memcmp(result.data(), expected.data(), uints.size() * sizeof(int)), 0);
+}
+
+TEST(ConvertTest, CopyHalfArray)
+{
+    VtHalfArray halfs(1000);
+    for (size_t i = 0; i < halfs.size(); ++i)
+    {
+        halfs[i] = GfHalf(static_cast<float>(i) * 0.25f);
+    }
+
+    FnAttribute::FloatAttribute attr = VtKatanaCopy(halfs);
+    ASSERT_TRUE(attr.isValid());
+    FnAttribute::FloatAttribute::array_type sample = attr.getNearestSample(0.0f);
+    ASSERT_EQ(sample.size(), halfs.size());
+    for (size_t i = 0; i < halfs.size(); ++i)
+    {
+        ASSERT_EQ(sample[i], static_cast<float>(halfs[i]));
+    }
+}
+
+TEST(ConvertTest, CopyUIntArraySamples)
+{
+    const std::vector<float> times = {-0.5f, 0.5f};
+    std::vector<VtUIntArray> values = {VtUIntArray(100), VtUIntArray(100)};
+    for (size_t i = 0; i < 100; ++i)
+    {
+        values[0][i] = static_cast<unsigned int>(i);
+        values[1][i] = static_cast<unsigned int>(i * 2);
+    }
+
+    FnAttribute::IntAttribute attr = VtKatanaCopy(times, values);
+    ASSERT_TRUE(attr.isValid());
+    ASSERT_EQ(attr.getNumberOfTimeSamples(), 2);
+    for (size_t sampleIndex = 0; sampleIndex < times.size(); ++sampleIndex)
+    {
+        FnAttribute::IntAttribute::array_type sample =
+            attr.getNearestSample(times[sampleIndex]);
+        ASSERT_EQ(sample.size(), values[sampleIndex].size());
+        for (size_t i = 0; i < sample.size(); ++i)
+        {
+            ASSERT_EQ(sample[i], static_cast<int>(values[sampleIndex][i]));
+        }
+    }
+}
+}  // namespace ConvertTests
+
+PXR_NAMESPACE_CLOSE_SCOPE
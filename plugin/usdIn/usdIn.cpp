@@ -58,6 +58,7 @@
 #include "usdKatana/blindDataObject.h"
 #include "usdKatana/bootstrap.h"
 #include "usdKatana/cache.h"
+#include "usdKatana/globalListsIndex.h"
 #include "usdKatana/locks.h"
 #include "usdKatana/readBlindData.h"
 #include "usdKatana/usdInPluginRegistry.h"
@@ -239,7 +240,8 @@ static UsdKatanaUsdInArgsRefPtr InitUsdInArgs(const FnKat::GroupAttribute& opArg
     if (instanceModeAttr.getValue("expanded", false) == "as sources and instances")
     {
         FnKat::GroupAttribute mappingAttr =
-            UsdKatanaUtils::BuildInstancePrototypeMapping(ab.stage, SdfPath::AbsoluteRootPath());
+            UsdKatanaCache::GetInstance().GetInstancePrototypeMapping(ab.stage,
+                                                                      SdfPath::AbsoluteRootPath());
         additionalOpArgs = FnKat::GroupAttribute("prototypeMapping", mappingAttr, true);
     }
 
@@ -312,6 +314,11 @@ static UsdKatanaUsdInArgsRefPtr InitUsdInArgs(const FnKat::GroupAttribute& opArg
             opArgs.getChildByName("evaluateUsdSkelBindings"))
         .getValue(1, false));
 
+    ab.composeXformOpsInKatana = static_cast<bool>(
+        FnKat::IntAttribute(
+            opArgs.getChildByName("composeXformOpsInKatana"))
+        .getValue(0, false));
+
     return ab.build();
 }
 
@@ -376,6 +383,11 @@ public:
                 localPrivateData.reset(new UsdKatanaUsdInPrivateData(usdInArgs->GetRootPrim(),
                                                                      usdInArgs, privateData));
                 privateData = localPrivateData.get();
+
+                // Every boundable location below sets its bound, so compute
+                // those of the model hierarchy up front, in parallel.
+                usdInArgs->WarmUpBounds(usdInArgs->GetRootPrim(),
+                                        usdInArgs->GetMotionSampleTimes());
             }
             if (FnAttribute::GroupAttribute prototypeMapping =
                     additionalOpArgs.getChildByName("prototypeMapping");
@@ -522,7 +534,8 @@ public:
                 "as sources and instances")
             {
                 FnKat::GroupAttribute prototypeMapping =
-                    UsdKatanaUtils::BuildInstancePrototypeMapping(prim.GetStage(), prim.GetPath());
+                    UsdKatanaCache::GetInstance().GetInstancePrototypeMapping(prim.GetStage(),
+                                                                              prim.GetPath());
                 FnKat::StringAttribute prototypeParentPath(prim.GetPath().GetString());
                 if (prototypeMapping.isValid() && prototypeMapping.getNumberOfChildren())
                 {
@@ -554,121 +567,72 @@ public:
             }
 
             //
-            // Find and execute the core op that handles the USD type.
+            // Find and execute the core and site-specific ops that handle
+            // the USD type. The registry resolves a type name and its applied
+            // schemas straight to the functions to run.
             //
 
+            const UsdKatanaUsdInPluginRegistry::TypeDispatch typeDispatch =
+                UsdKatanaUsdInPluginRegistry::FindTypeDispatch(
+                    prim.GetTypeName(), prim.GetAppliedSchemas());
+
+            if (typeDispatch.hasMultipleSchemaOps)
             {
-                std::string opName;
-                const TfToken typeName = prim.GetTypeName();
-                if (!UsdKatanaUsdInPluginRegistry::FindUsdType(typeName, &opName))
-                {
-                    // If there is no type registered, we search through the
-                    // applied schemas to see if one of those has an op
-                    // registered against them. We only expect one of these
-                    // schemas to be registered against an import Op.
-                    const auto& appliedSchemas = prim.GetAppliedSchemas();
-                    bool foundRegisteredSchema = false;
-                    for (auto& appliedSchemaName : appliedSchemas)
-                    {
-                        if (UsdKatanaUsdInPluginRegistry::FindSchema(appliedSchemaName, &opName))
-                        {
-                            if (foundRegisteredSchema)
-                            {
-                                FnLogWarn("Multiple schemas applied on prim at location "
-                                          << prim.GetPath()
-                                          << " which are registered against different input ops.");
-                            }
-                            foundRegisteredSchema = true;
-                        }
-                    }
-                }
-                if (!opName.empty())
+                // We only expect one of the applied schemas to be registered
+                // against an import Op.
+                FnLogWarn("Multiple schemas applied on prim at location "
+                          << prim.GetPath()
+                          << " which are registered against different input ops.");
+            }
+
+            if (typeDispatch.typeFnc && privateData)
+            {
+                if (!typeDispatch.isSkelRoot || privateData->GetEvaluateUsdSkelBindings())
                 {
-                    if (privateData)
-                    {
-                        if ((typeName.GetString() != "SkelRoot") ||
-                            privateData->GetEvaluateUsdSkelBindings())
-                        {
-                            // roughly equivalent to execOp except that we
-                            // can locally override privateData
-                            UsdKatanaUsdInPluginRegistry::ExecuteOpDirectExecFnc(
-                                opName, *privateData, opArgs, interface);
+                    // roughly equivalent to execOp except that we
+                    // can locally override privateData
+                    (*typeDispatch.typeFnc)(*privateData, opArgs, interface);
 
-                            opArgs = privateData->updateExtensionOpArgs(opArgs);
-                        }
-                    }
+                    opArgs = privateData->updateExtensionOpArgs(opArgs);
                 }
             }
 
-            //
-            // Find and execute the site-specific op that handles the USD type.
-            //
-
+            if (typeDispatch.siteTypeFnc && privateData)
             {
-                std::string opName;
-                if (UsdKatanaUsdInPluginRegistry::FindUsdTypeForSite(prim.GetTypeName(), &opName))
-                {
-                    if (!opName.empty()) {
-                        if (privateData)
-                        {
-                            // roughly equivalent to execOp except that we can
-                            // locally override privateData
-                            UsdKatanaUsdInPluginRegistry::ExecuteOpDirectExecFnc(
-                                opName, *privateData, opArgs, interface);
-                            opArgs = privateData->updateExtensionOpArgs(opArgs);
-                        }
-                    }
-                }
+                // roughly equivalent to execOp except that we can
+                // locally override privateData
+                (*typeDispatch.siteTypeFnc)(*privateData, opArgs, interface);
+                opArgs = privateData->updateExtensionOpArgs(opArgs);
             }
 
             //
-            // Find and execute the core kind op that handles the model kind.
+            // Find and execute the core kind op that handles the model kind,
+            // then the site-specific one.
             //
 
             bool execKindOp = FnKat::IntAttribute(
                 interface.getOutputAttr("__UsdIn.execKindOp")).getValue(1, false);
 
-            if (execKindOp)
+            if (execKindOp || _hasSiteKinds)
             {
                 TfToken kind;
                 if (UsdModelAPI(prim).GetKind(&kind)) {
-                    std::string opName;
-                    if (UsdKatanaUsdInPluginRegistry::FindKind(kind, &opName))
+                    const UsdKatanaUsdInPluginRegistry::KindDispatch kindDispatch =
+                        UsdKatanaUsdInPluginRegistry::FindKindDispatch(kind);
+
+                    if (execKindOp && kindDispatch.kindFnc && privateData)
                     {
-                        if (!opName.empty()) {
-                            if (privateData)
-                            {
-                                // roughly equivalent to execOp except that we can
-                                // locally override privateData
-                                UsdKatanaUsdInPluginRegistry::ExecuteOpDirectExecFnc(
-                                    opName, *privateData, opArgs, interface);
-
-                                opArgs = privateData->updateExtensionOpArgs(opArgs);
-                            }
-                        }
-                    }
-                }
-            }
+                        // roughly equivalent to execOp except that we can
+                        // locally override privateData
+                        (*kindDispatch.kindFnc)(*privateData, opArgs, interface);
 
-            //
-            // Find and execute the site-specific kind op that handles 
-            // the model kind.
-            //
+                        opArgs = privateData->updateExtensionOpArgs(opArgs);
+                    }
 
-            if (_hasSiteKinds) {
-                TfToken kind;
-                if (UsdModelAPI(prim).GetKind(&kind)) {
-                    std::string opName;
-                    if (UsdKatanaUsdInPluginRegistry::FindKindForSite(kind, &opName))
+                    if (kindDispatch.siteKindFnc && privateData)
                     {
-                        if (!opName.empty()) {
-                            if (privateData)
-                            {
-                                UsdKatanaUsdInPluginRegistry::ExecuteOpDirectExecFnc(
-                                    opName, *privateData, opArgs, interface);
-                                opArgs = privateData->updateExtensionOpArgs(opArgs);
-                            }
-                        }
+                        (*kindDispatch.siteKindFnc)(*privateData, opArgs, interface);
+                        opArgs = privateData->updateExtensionOpArgs(opArgs);
                     }
                 }
             }
@@ -963,6 +927,12 @@ public:
                 // Require a defining specifier on prims if there is no input.
                 predicate = UsdPrimIsDefined && predicate;
             }
+            // Children without a staticScene entry of their own all receive the same op args,
+            // so build that group once rather than once per child.
+            const FnAttribute::GroupAttribute staticSceneChildren =
+                opArgs.getChildByName("staticScene.c");
+            FnAttribute::GroupAttribute sharedChildOpArgs;
+
             TF_FOR_ALL(childIter, prim.GetFilteredChildren(predicate))
             {
                 const UsdPrim& child = *childIter;
@@ -983,27 +953,37 @@ public:
                 }
                 // If the child is a light filter, skip adding it here. It will be added through a
                 // relationship from a light prim should it be needed.
-                bool skipForFilter = false;
-                std::unordered_set<std::string> shaderIds =
-                    UsdKatanaUtils::GetShaderIds(child, privateData->GetCurrentTime());
-                for (const std::string& shaderId : shaderIds)
+                const bool skipForFilter =
+                    UsdKatanaUtils::IsLightFilter(child, privateData->GetCurrentTime());
+                if (!skipForFilter)
                 {
-                    auto node = UsdKatanaUtils::GetShaderNodeFromShaderId(shaderId);
-                    if (node && node->GetContext() == TfToken("lightFilter"))
+                    FnAttribute::GroupAttribute childOpArgs;
+                    const FnAttribute::Attribute childStaticScene =
+                        staticSceneChildren.isValid()
+                            ? staticSceneChildren.getChildByName(childName)
+                            : FnAttribute::Attribute();
+                    if (childStaticScene.isValid())
                     {
-                        skipForFilter = true;
-                        break;
+                        childOpArgs = FnKat::GroupBuilder()
+                                          .update(opArgs)
+                                          .set("staticScene", childStaticScene)
+                                          .build();
+                    }
+                    else
+                    {
+                        if (!sharedChildOpArgs.isValid())
+                        {
+                            sharedChildOpArgs = FnKat::GroupBuilder()
+                                                    .update(opArgs)
+                                                    .set("staticScene", childStaticScene)
+                                                    .build();
+                        }
+                        childOpArgs = sharedChildOpArgs;
                     }
-                }
-                if (!skipForFilter)
-                {
                     interface.createChild(
                         childName,
                         "",
-                        FnKat::GroupBuilder()
-                            .update(opArgs)
-                            .set("staticScene", opArgs.getChildByName("staticScene.c." + childName))
-                            .build(),
+                        childOpArgs,
                         FnKat::GeolibCookInterface::ResetRootFalse,
                         new UsdKatanaUsdInPrivateData(child, usdInArgs, privateData),
                         UsdKatanaUsdInPrivateData::Delete);
@@ -1298,6 +1278,11 @@ public:
                 localPrivateData.reset(new UsdKatanaUsdInPrivateData(usdInArgs->GetRootPrim(),
                                                                      usdInArgs, privateData));
                 privateData = localPrivateData.get();
+
+                // Every boundable location below sets its bound, so compute
+                // those of the model hierarchy up front, in parallel.
+                usdInArgs->WarmUpBounds(usdInArgs->GetRootPrim(),
+                                        usdInArgs->GetMotionSampleTimes());
             }
             else
             {
@@ -1511,18 +1496,27 @@ public:
             return;
         }
 
+        // The index is shared by every UsdIn using the stage, and only
+        // traverses the subtrees which changed since the last cook. Lists are
+        // restricted to the isolatePath up front.
+        const std::string& isolatePathString = usdInArgs->GetIsolatePath();
+        const SdfPath isolatePath =
+            isolatePathString.empty() ? SdfPath::AbsoluteRootPath() : SdfPath(isolatePathString);
+        std::shared_ptr<UsdKatanaGlobalListsIndex> globalListsIndex =
+            UsdKatanaCache::GetInstance().GetGlobalListsIndex(stage);
+        if (!globalListsIndex)
+        {
+            return;
+        }
+
         // Extract camera paths.
-        SdfPathVector cameraPaths = UsdKatanaUtils::FindCameraPaths(stage);
+        SdfPathVector cameraPaths = globalListsIndex->GetCameraPaths(isolatePath);
         FnKat::StringBuilder cameraListBuilder;
         for (const SdfPath& cameraPath : cameraPaths)
         {
-            const std::string& path = cameraPath.GetString();
-            if (path.find(usdInArgs->GetIsolatePath()) != std::string::npos)
-            {
-                cameraListBuilder.push_back(
-                    TfNormPath(usdInArgs->GetRootLocationPath() + "/" +
-                               path.substr(usdInArgs->GetIsolatePath().size())));
-            }
+            cameraListBuilder.push_back(
+                TfNormPath(usdInArgs->GetRootLocationPath() + "/" +
+                           cameraPath.GetString().substr(isolatePathString.size())));
         }
 
         FnKat::StringAttribute cameraListAttr = cameraListBuilder.build();
@@ -1532,24 +1526,29 @@ public:
         }
 
         // Extract light paths.
-        // If isolatePath is used, we check that any of the light paths found
-        // are children of it before adding them to the lists. This is
-        // because we generate the light list using the cache so those paths
-        // may not actually exist.
-        const std::string& isolatePathString = usdInArgs->GetIsolatePath();
-        const SdfPath isolatePath =
-            isolatePathString.empty() ? SdfPath::AbsoluteRootPath() : SdfPath(isolatePathString);
-        SdfPathVector lightPaths = UsdKatanaUtils::FindLightPaths(stage);
-        stage->LoadAndUnload(SdfPathSet(lightPaths.begin(), lightPaths.end()), SdfPathSet());
-        UsdKatanaUtilsLightListEditor lightListEditor(interface, usdInArgs);
+        // The light list is generated using the light list caches, so those
+        // paths may not actually be loaded yet. Only load those which are not,
+        // as loading changes the stage and so invalidates the index.
+        SdfPathVector lightPaths = globalListsIndex->GetLightPaths(isolatePath);
+        SdfPathSet lightPathsToLoad;
         for (const SdfPath& lightPath : lightPaths)
         {
-            if (lightPath.HasPrefix(isolatePath))
+            const UsdPrim lightPrim = stage->GetPrimAtPath(lightPath);
+            if (!lightPrim || !lightPrim.IsLoaded())
             {
-                lightListEditor.SetPath(lightPath);
-                UsdKatanaUsdInPluginRegistry::ExecuteLightListFncs(lightListEditor);
+                lightPathsToLoad.insert(lightPath);
             }
         }
+        if (!lightPathsToLoad.empty())
+        {
+            stage->LoadAndUnload(lightPathsToLoad, SdfPathSet());
+        }
+        UsdKatanaUtilsLightListEditor lightListEditor(interface, usdInArgs);
+        for (const SdfPath& lightPath : lightPaths)
+        {
+            lightListEditor.SetPath(lightPath);
+            UsdKatanaUsdInPluginRegistry::ExecuteLightListFncs(lightListEditor);
+        }
 
         lightListEditor.Build();
     }
@@ -1562,19 +1561,26 @@ class FlushStageFnc : public Foundry::Katana::AttributeFunction
 public:
     static FnAttribute::Attribute run(FnAttribute::Attribute args)
     {
-        boost::upgrade_lock<boost::upgrade_mutex>
-                readerLock(UsdKatanaGetStageLock());
-        
-        FnKat::GroupAttribute additionalOpArgs;
-        auto usdInArgs = InitUsdInArgs(args, additionalOpArgs, "/root");
-        if (usdInArgs)
+        // Flush every cached stage of the file, whatever its session layer,
+        // without opening it first. Stages of other files are left alone.
+        FnKat::GroupAttribute opArgs = args;
+        const std::string fileName =
+            FnKat::StringAttribute(opArgs.getChildByName("fileName")).getValue("", false);
+        if (!fileName.empty())
         {
-            boost::upgrade_to_unique_lock<boost::upgrade_mutex>
-                    writerLock(readerLock);
-            UsdKatanaCache::GetInstance().FlushStage(usdInArgs->GetStage());
+            const std::string assetResolverContextStr =
+                FnKat::StringAttribute(opArgs.getChildByName("assetResolverContext"))
+                    .getValue("", false);
+            const ArResolverContext context =
+                assetResolverContextStr.empty()
+                    ? ArGetResolver().CreateDefaultContextForAsset(fileName)
+                    : ArGetResolver().CreateContextFromString(assetResolverContextStr);
+            const ArResolverContextBinder bind(context);
+
+            boost::unique_lock<boost::upgrade_mutex> writerLock(UsdKatanaGetStageLock());
+            UsdKatanaCache::GetInstance().FlushStage(fileName);
         }
-        
-        
+
         return FnAttribute::Attribute();
     }
 
@@ -38,6 +38,7 @@
 
 #include "usdKatana/attrMap.h"
 #include "usdKatana/cache.h"
+#include "usdKatana/locks.h"
 #include "usdKatana/blindDataObject.h"
 #include "usdKatana/readBlindData.h"
 #include "usdKatana/readMaterial.h"
@@ -91,21 +92,24 @@ MaterialReferenceAttrFncCache::createValue(
     int flatten = FnKat::IntAttribute(
         args.getChildByName("flatten")).getValue(0, false);
 
-    FnAttribute::GroupAttribute sessionAttr;
-    std::string sessionLocation = "";
-    std::string ignoreLayerRegex = "";
-    std::string isolatePath = "";
-    UsdStageRefPtr stage = UsdKatanaCache::GetInstance().GetStage(
-        asset, 
-        sessionAttr, sessionLocation, isolatePath,
-        ignoreLayerRegex, 
-        true /* forcePopulate */);
+    // Only the material and its dependencies are needed, so avoid populating
+    // (and loading payloads of) the rest of the library.
+    const SdfPath materialSdfPath(materialPath);
+    if (!materialSdfPath.IsAbsolutePath() || !materialSdfPath.IsPrimPath()) {
+        return IMPLPtr(new FnAttribute::GroupAttribute());
+    }
+    UsdStageRefPtr stage = UsdKatanaCache::GetInstance().GetMaterialLibraryStage(
+        asset, materialSdfPath);
 
     if (!stage) {
         return IMPLPtr(new FnAttribute::GroupAttribute());
     }
 
-    UsdPrim prim = stage->GetPrimAtPath(SdfPath(materialPath));
+    // Hold off other lookups from widening the library stage while reading.
+    boost::shared_lock<boost::upgrade_mutex> readerLock(
+        UsdKatanaGetMaterialLibraryStageLock());
+
+    UsdPrim prim = stage->GetPrimAtPath(materialSdfPath);
     if (!prim) {
         return IMPLPtr(new FnAttribute::GroupAttribute());
     }
@@ -168,20 +172,18 @@ LibraryMaterialNamesAttrFncCache::createValue(
         return IMPLPtr(new FnAttribute::GroupAttribute());
     }
 
-    FnAttribute::GroupAttribute sessionAttr;
-    std::string sessionLocation = "";
-    std::string ignoreLayerRegex = "";
-    std::string isolatePath = "";
-    UsdStageRefPtr stage = UsdKatanaCache::GetInstance().GetStage(
-        asset, 
-        sessionAttr, sessionLocation, isolatePath,
-        ignoreLayerRegex, 
-        true /* forcePopulate */);
+    // Material names only need the prims at the root, so payloads are left
+    // unloaded.
+    UsdStageRefPtr stage = UsdKatanaCache::GetInstance().GetMaterialLibraryStage(
+        asset, SdfPath());
 
     if (!stage) {
         return IMPLPtr(new FnAttribute::GroupAttribute());
     }
 
+    boost::shared_lock<boost::upgrade_mutex> readerLock(
+        UsdKatanaGetMaterialLibraryStageLock());
+
     // Find all materials on this shader library
     // first: get all looks at the root
     std::vector<std::string> materialNames;
@@ -29,9 +29,6 @@
 //
 #include "usdInShipped/declareCoreOps.h"
 
-#include <list>
-#include <map>
-
 #include <pxr/pxr.h>
 #include <pxr/usd/usdShade/material.h>
 
@@ -43,6 +40,7 @@
 
 #include "usdKatana/attrMap.h"
 #include "usdKatana/blindDataObject.h"
+#include "usdKatana/materialCache.h"
 #include "usdKatana/readBlindData.h"
 #include "usdKatana/readMaterial.h"
 
@@ -53,113 +51,9 @@ PXR_NAMESPACE_USING_DIRECTIVE
 namespace
 {
 
-// bounded LRU cache
-class ConvertedMaterialCache
-{
-public:
-    typedef boost::shared_ptr<UsdKatanaAttrMap> UsdKatanaAttrMapRefPtr;
-
-    ConvertedMaterialCache(size_t maxEntries)
-    : m_maxEntries(maxEntries)
-    {
-        
-    }
-
-    UsdKatanaAttrMapRefPtr get(const std::string& key)
-    {
-        boost::upgrade_lock<boost::upgrade_mutex> readerLock(m_mutex);
-        
-        auto mapI = m_entryIteratorMap.find(key);
-        
-        if (mapI == m_entryIteratorMap.end())
-        {
-            //std::cerr << "cache miss: " << key << std::endl;
-
-            return UsdKatanaAttrMapRefPtr();
-        }
-        
-        //std::cerr << "cache hit: " << key << std::endl;
-        
-        boost::upgrade_to_unique_lock<boost::upgrade_mutex>
-                writerLock(readerLock);
-        
-        m_entries.splice(m_entries.end(), m_entries, (*mapI).second);
-        
-        return (*((*mapI).second)).value;
-        
-    }
-
-    void insert(const std::string& key, UsdKatanaAttrMapRefPtr value)
-    {
-        //std::cerr << "inserting: " << key << std::endl;
-        
-        boost::upgrade_lock<boost::upgrade_mutex> readerLock(m_mutex);
-        
-        auto mapI = m_entryIteratorMap.find(key);
-        if (mapI != m_entryIteratorMap.end())
-        {
-            //replace in-place if it's already there
-            boost::upgrade_to_unique_lock<boost::upgrade_mutex>
-                    writerLock(readerLock);
-            (*(*mapI).second).value = value;
-            return;
-        }
-        
-        
-        boost::upgrade_to_unique_lock<boost::upgrade_mutex>
-                    writerLock(readerLock);
-        
-        // evict from front
-        while (m_entries.size() > m_maxEntries)
-        {
-            auto entryI = m_entries.begin();
-            //std::cerr << "evicting: " << (*entryI).key << std::endl;
-            m_entryIteratorMap.erase((*entryI).key);
-            m_entries.erase(entryI);
-        }
-        
-        m_entryIteratorMap[key] = m_entries.insert(m_entries.end(),
-                Entry(key, value));
-        
-    }
-    
-    void clear()
-    {
-        boost::upgrade_lock<boost::upgrade_mutex> readerLock(m_mutex);
-        boost::upgrade_to_unique_lock<boost::upgrade_mutex>
-                    writerLock(readerLock);
-        
-        m_entryIteratorMap.clear();
-        m_entries.clear();
-    }
-    
-private:
-    
-    struct Entry
-    {
-        Entry(const std::string& _key, UsdKatanaAttrMapRefPtr _value) : key(_key), value(_value) {}
-
-        std::string key;
-        UsdKatanaAttrMapRefPtr value;
-    };
-    
-    typedef std::list<Entry> EntryList;
-    typedef std::map<std::string, EntryList::iterator> EntryListIteratorMap;
-    
-    EntryList m_entries;
-    EntryListIteratorMap m_entryIteratorMap;
-    
-    size_t m_maxEntries;
-    
-    boost::upgrade_mutex m_mutex;
-    
-};
-
-ConvertedMaterialCache g_materialCache(250);
-
 void FlushMaterialCache()
 {
-    g_materialCache.clear();
+    UsdKatanaMaterialCache::GetInstance().Clear();
 }
 
 
@@ -190,26 +84,22 @@ USDKATANA_USDIN_PLUGIN_DEFINE_WITH_FLUSH(UsdInCore_LookOp,
     std::string looksGroupLocation = FnAttribute::StringAttribute(
             opArgs.getChildByName("looksGroupLocation")).getValue("", false);
 
-    ConvertedMaterialCache::UsdKatanaAttrMapRefPtr attrs;
+    UsdKatanaMaterialCache& materialCache = UsdKatanaMaterialCache::GetInstance();
+    UsdKatanaMaterialCache::UsdKatanaAttrMapRefPtr attrs;
 
+    // A key prefix is provided by a parent Looks scope unless
+    // USD_KATANA_CACHE_MATERIALGROUPS is disabled. Free-floating materials are
+    // keyed on what their conversion depends on instead.
     FnAttribute::Attribute looksCacheKeyPrefixAttr =
             opArgs.getChildByName("looksCacheKeyPrefixAttr");
-    
-    
+
     std::string key;
-    
-    // We currently only cache if a key prefix is provided by a parent Looks
-    // scope. Free-floating materials are not cached.
-    if (looksCacheKeyPrefixAttr.isValid())
+    if (materialCache.IsEnabled())
     {
-        key = FnAttribute::GroupAttribute(
-                "a", looksCacheKeyPrefixAttr,
-                "b", FnAttribute::StringAttribute(
-                            privateData.GetUsdPrim().GetName()),
-                true).getHash().str();
-        
-        
-        attrs = g_materialCache.get(key);
+        key = materialCache.ComputeKey(materialSchema, flatten, privateData,
+                                       looksGroupLocation, interface.getOutputLocationPath(),
+                                       looksCacheKeyPrefixAttr);
+        attrs = materialCache.Get(key);
     }
     
     
@@ -217,7 +107,7 @@ USDKATANA_USDIN_PLUGIN_DEFINE_WITH_FLUSH(UsdInCore_LookOp,
     
     if (!attrs)
     {
-        attrs = ConvertedMaterialCache::UsdKatanaAttrMapRefPtr(new UsdKatanaAttrMap);
+        attrs = UsdKatanaMaterialCache::UsdKatanaAttrMapRefPtr(new UsdKatanaAttrMap);
 
         typedef boost::upgrade_lock<UsdKatanaAttrMap::Mutex> Lock;
 
@@ -258,7 +148,8 @@ USDKATANA_USDIN_PLUGIN_DEFINE_WITH_FLUSH(UsdInCore_LookOp,
                 
                 if (useCache)
                 {
-                    g_materialCache.insert(key, attrs);
+                    materialCache.Insert(key, attrs,
+                                         privateData.GetUsdPrim().GetStage());
                 }
             }
         }
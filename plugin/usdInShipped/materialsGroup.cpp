@@ -55,39 +55,17 @@ PXR_NAMESPACE_USING_DIRECTIVE
 // reading of the material data itself to the material locations.
 // 
 // The caching is also done per material now -- as implemented in material.cpp
+// -- and keyed on the material itself, so that the same material read through
+// different scopes is only converted once.
 // 
-// However, the cache key is still generated from the material group and
-// therefore the envvar (and terminology) for enabling it remains here.
-// 
-// We start with a reasonable constant.
+// An explicit sharedLooksCacheKey still lets materials share their entries
+// across stages, and the envvar (and terminology) for honouring it remains
+// here.
 TF_DEFINE_ENV_SETTING(USD_KATANA_CACHE_MATERIALGROUPS,
                       true,
-                      "Toggle inclusion of a cache key representing this scope "
+                      "Toggle inclusion of the sharedLooksCacheKey of this scope "
                       "(respected by UsdInCore_LookOp)");
 
-FnKat::Attribute _GetCacheKey(const UsdKatanaUsdInPrivateData& privateData)
-{
-    UsdKatanaUsdInArgsRefPtr args = privateData.GetUsdInArgs();
-
-    std::string location;
-    UsdPrim prim = privateData.GetUsdPrim();
-    if (prim.IsInstanceProxy()) {
-        location = prim.GetPrimInPrototype().GetPath().GetString();
-    }
-    else {
-        location = prim.GetPath().GetString();
-    }
-    
-    auto cacheKey = FnKat::GroupAttribute(
-        "file", FnKat::StringAttribute(args->GetFileName()),
-        "session", args->GetSessionAttr(),
-        "time", FnKat::DoubleAttribute(args->GetCurrentTime()),
-        "location", FnKat::StringAttribute(location),
-        false);
-        
-    return cacheKey;
-}
-
 USDKATANA_USDIN_PLUGIN_DEFINE(UsdInCore_LooksGroupOp, privateData, opArgs, interface)
 {
     // leave for debugging purposes
@@ -111,14 +89,12 @@ USDKATANA_USDIN_PLUGIN_DEFINE(UsdInCore_LooksGroupOp, privateData, opArgs, inter
                 std::string cacheKey;
                 keyAttr.Get(&cacheKey);
                 
-                cacheKeyAttr = FnKat::StringAttribute(cacheKey);
+                if (!cacheKey.empty())
+                {
+                    cacheKeyAttr = FnKat::StringAttribute(cacheKey);
+                }
             }
         }
-        
-        if (!cacheKeyAttr.isValid())
-        {
-            cacheKeyAttr = _GetCacheKey(privateData);
-        }
     }
     
     
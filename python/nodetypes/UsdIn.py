@@ -199,6 +199,18 @@ nb.setHintsForParameter('evaluateUsdSkelBindings', {
     'constant' : True,
 })
 
+gb.set('composeXformOpsInKatana', 0)
+nb.setHintsForParameter('composeXformOpsInKatana', {
+    'widget' : 'checkBox',
+    'help' : """
+        If enabled, each xform op is read at its own motion sample times and
+        the ops are composed into the xform matrix by Katana. Otherwise the
+        local transform of each prim is read from USD once per motion sample,
+        which is faster.
+    """,
+    'constant' : True,
+})
+
 nb.setParametersTemplateAttr(gb.build())
 
 #-----------------------------------------------------------------------------
@@ -276,6 +288,9 @@ def buildUsdInOpArgsAtGraphState(self, graphState):
     gb.set('evaluateUsdSkelBindings', int(self.getParameter(
         'evaluateUsdSkelBindings').getValue(frameTime)))
 
+    gb.set('composeXformOpsInKatana', int(self.getParameter(
+        'composeXformOpsInKatana').getValue(frameTime)))
+
     argsOverride = graphState.getDynamicEntry('var:pxrUsdInArgs')
     if isinstance(argsOverride, FnAttribute.GroupAttribute):
         gb.update(argsOverride)